@@ -0,0 +1,320 @@
+// adar101101@gmail.com
+
+#include <stdexcept>
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <type_traits>
+#include <complex>
+#include <cstdint>
+#include "BandedMat.hpp"
+
+namespace st = std;
+
+namespace Matrix {
+
+namespace {
+
+// Throw if two operands differ in size; what names the operation for the message.
+void requireSameSize(int left, int right, const char* what) {
+    if (left != right) {
+        throw st::invalid_argument(st::string("Matrices must have the same dimensions for ") + what);
+    }
+}
+
+// Determinant by Gaussian elimination with partial pivoting inside the band. Row swaps can
+// widen the upper band by up to lower, so work holds rows of 2 * lower + upper + 1 elements:
+// element (i, j) is work[i * width + j - i + lower].
+template <typename W>
+W eliminateBand(st::vector<W>& work, int n, int lower, int upper) {
+    const int width = 2 * lower + upper + 1;
+    auto at = [&](int i, int j) -> W& { return work[(size_t)i * width + (j - i + lower)]; };
+    W det = W(1);
+    for (int k = 0; k < n; ++k) {
+        const int lastRow = st::min(n - 1, k + lower);
+        const int lastCol = st::min(n - 1, k + lower + upper);
+        int pivot = k;
+        for (int i = k + 1; i <= lastRow; ++i) {
+            if (st::abs(at(i, k)) > st::abs(at(pivot, k))) pivot = i;
+        }
+        if (at(pivot, k) == W(0)) return W(0);
+        if (pivot != k) {
+            for (int j = k; j <= lastCol; ++j) st::swap(at(k, j), at(pivot, j));
+            det = -det;
+        }
+        const W diagonal = at(k, k);
+        det *= diagonal;
+        for (int i = k + 1; i <= lastRow; ++i) {
+            const W factor = at(i, k) / diagonal;
+            if (factor == W(0)) continue;
+            for (int j = k + 1; j <= lastCol; ++j) {
+                at(i, j) -= factor * at(k, j);
+            }
+        }
+    }
+    return det;
+}
+
+}
+
+// Constructor: all-zero matrix of n * (lower + upper + 1) stored elements.
+template <typename T>
+BasicBandedMat<T>::BasicBandedMat(int size, int lower, int upper) {
+    if (size <= 0) {
+        throw st::invalid_argument("Matrix dimensions must be positive");
+    }
+    if (lower < 0 || upper < 0 || lower >= size || upper >= size) {
+        throw st::invalid_argument("Bandwidth must be between 0 and size - 1");
+    }
+    n = size;
+    this->lower = lower;
+    this->upper = upper;
+    band.assign((size_t)size * width(), T(0));
+}
+
+// Dense constructor: copy the band, row by row.
+template <typename T>
+BasicBandedMat<T>::BasicBandedMat(const BasicConstMatrixView<T>& dense, int lower, int upper)
+    : BasicBandedMat(dense.getRows(), lower, upper) {
+    for (int i = 0; i < n; ++i) {
+        const T* src = dense[i];
+        st::copy(src + colBegin(i), src + colEnd(i), row(i) + colBegin(i));
+    }
+}
+
+// Access element at (row, col) with bounds checking; outside the band reads as zero.
+template <typename T>
+T BasicBandedMat<T>::operator()(int r, int c) const {
+    if (r < 0 || r >= n || c < 0 || c >= n) {
+        throw st::out_of_range("Index out of range of matrix");
+    }
+    if (c < colBegin(r) || c >= colEnd(r)) return T(0);
+    return row(r)[c];
+}
+
+// Set element at (row, col), which must be inside the band.
+template <typename T>
+void BasicBandedMat<T>::set(int r, int c, T value) {
+    if (r < 0 || r >= n || c < 0 || c >= n) {
+        throw st::out_of_range("Index out of range of matrix");
+    }
+    if (c < colBegin(r) || c >= colEnd(r)) {
+        throw st::out_of_range("Index outside the band of a banded matrix");
+    }
+    row(r)[c] = value;
+}
+
+// Get number of rows in the matrix.
+template <typename T>
+int BasicBandedMat<T>::getRows() const { return n; }
+
+// Get number of columns in the matrix.
+template <typename T>
+int BasicBandedMat<T>::getCols() const { return n; }
+
+// Get number of sub-diagonals.
+template <typename T>
+int BasicBandedMat<T>::getLowerBandwidth() const { return lower; }
+
+// Get number of super-diagonals.
+template <typename T>
+int BasicBandedMat<T>::getUpperBandwidth() const { return upper; }
+
+// Calculate sum of all elements inside the band.
+template <typename T>
+T BasicBandedMat<T>::countSum() const {
+    T sum = T(0);
+    for (int i = 0; i < n; ++i) {
+        const T* src = row(i);
+        for (int j = colBegin(i); j < colEnd(i); ++j) sum += src[j];
+    }
+    return sum;
+}
+
+// Unpack into a zeroed dense matrix.
+template <typename T>
+BasicSquareMat<T> BasicBandedMat<T>::toDense() const {
+    BasicSquareMat<T> result(n, n);
+    for (int i = 0; i < n; ++i) {
+        const T* src = row(i);
+        st::copy(src + colBegin(i), src + colEnd(i), result[i] + colBegin(i));
+    }
+    return result;
+}
+
+// Determinant: product of the diagonal for a triangular band, the three-term recurrence
+// f(i) = a(i) f(i-1) - b(i-1) c(i-1) f(i-2) for a tridiagonal one, banded elimination otherwise.
+template <typename T>
+T BasicBandedMat<T>::operator!() const {
+    if (lower == 0 || upper == 0) {
+        T det = T(1);
+        for (int i = 0; i < n; ++i) det *= row(i)[i];
+        return det;
+    }
+    if (lower == 1 && upper == 1) {
+        T previous = T(1);
+        T current = row(0)[0];
+        for (int i = 1; i < n; ++i) {
+            const T next = row(i)[i] * current - row(i - 1)[i] * row(i)[i - 1] * previous;
+            previous = current;
+            current = next;
+        }
+        return current;
+    }
+    using W = typename st::conditional<st::is_integral<T>::value, long double, T>::type;
+    const int width = 2 * lower + upper + 1;
+    st::vector<W> work((size_t)n * width, W(0));
+    for (int i = 0; i < n; ++i) {
+        const T* src = row(i);
+        for (int j = colBegin(i); j < colEnd(i); ++j) {
+            work[(size_t)i * width + (j - i + lower)] = W(src[j]);
+        }
+    }
+    W det = eliminateBand(work, n, lower, upper);
+    if constexpr (st::is_integral<T>::value) return (T)st::llround(det);
+    else return det;
+}
+
+// Compare matrices for equality (size, bandwidths and every element inside the band).
+template <typename T>
+bool BasicBandedMat<T>::operator==(const BasicBandedMat& other) const {
+    if (n != other.n || lower != other.lower || upper != other.upper) return false;
+    for (int i = 0; i < n; ++i) {
+        const T* a = row(i);
+        const T* b = other.row(i);
+        for (int j = colBegin(i); j < colEnd(i); ++j) {
+            if (a[j] != b[j]) return false;
+        }
+    }
+    return true;
+}
+
+// Compare matrices for inequality.
+template <typename T>
+bool BasicBandedMat<T>::operator!=(const BasicBandedMat& other) const {
+    return !(*this == other);
+}
+
+// Add two banded matrices into one with the wider of each bandwidth.
+template <typename T>
+BasicBandedMat<T> BasicBandedMat<T>::add(const BasicBandedMat& left, const BasicBandedMat& right) {
+    requireSameSize(left.n, right.n, "addition");
+    BasicBandedMat result(left.n, st::max(left.lower, right.lower), st::max(left.upper, right.upper));
+    for (int i = 0; i < left.n; ++i) {
+        T* out = result.row(i);
+        const T* a = left.row(i);
+        const T* b = right.row(i);
+        for (int j = left.colBegin(i); j < left.colEnd(i); ++j) out[j] += a[j];
+        for (int j = right.colBegin(i); j < right.colEnd(i); ++j) out[j] += b[j];
+    }
+    return result;
+}
+
+// Subtract one banded matrix from another into one with the wider of each bandwidth.
+template <typename T>
+BasicBandedMat<T> BasicBandedMat<T>::subtract(const BasicBandedMat& left, const BasicBandedMat& right) {
+    requireSameSize(left.n, right.n, "subtraction");
+    BasicBandedMat result(left.n, st::max(left.lower, right.lower), st::max(left.upper, right.upper));
+    for (int i = 0; i < left.n; ++i) {
+        T* out = result.row(i);
+        const T* a = left.row(i);
+        const T* b = right.row(i);
+        for (int j = left.colBegin(i); j < left.colEnd(i); ++j) out[j] += a[j];
+        for (int j = right.colBegin(i); j < right.colEnd(i); ++j) out[j] -= b[j];
+    }
+    return result;
+}
+
+// Multiply each element inside the band by a scalar.
+template <typename T>
+BasicBandedMat<T> BasicBandedMat<T>::scale(const BasicBandedMat& mat, T scalar) {
+    BasicBandedMat result(mat.n, mat.lower, mat.upper);
+    for (int i = 0; i < mat.n; ++i) {
+        T* out = result.row(i);
+        const T* a = mat.row(i);
+        for (int j = mat.colBegin(i); j < mat.colEnd(i); ++j) out[j] = a[j] * scalar;
+    }
+    return result;
+}
+
+// Product of two banded matrices: a(i, k) inside row i's band meets row k's band of right;
+// the result's bandwidths are the sums, capped at n - 1.
+template <typename T>
+BasicBandedMat<T> BasicBandedMat<T>::multiply(const BasicBandedMat& left, const BasicBandedMat& right) {
+    requireSameSize(left.n, right.n, "multiplication");
+    const int n = left.n;
+    BasicBandedMat result(n, st::min(n - 1, left.lower + right.lower), st::min(n - 1, left.upper + right.upper));
+    for (int i = 0; i < n; ++i) {
+        const T* a = left.row(i);
+        T* out = result.row(i);
+        for (int k = left.colBegin(i); k < left.colEnd(i); ++k) {
+            const T aik = a[k];
+            const T* b = right.row(k);
+            for (int j = right.colBegin(k); j < right.colEnd(k); ++j) {
+                out[j] += aik * b[j];
+            }
+        }
+    }
+    return result;
+}
+
+// Banded times dense: row i of the result sums only the rows of right inside row i's band.
+template <typename T>
+BasicSquareMat<T> BasicBandedMat<T>::multiply(const BasicBandedMat& left, const BasicConstMatrixView<T>& right) {
+    requireSameSize(left.n, right.getRows(), "multiplication");
+    const int n = left.n;
+    BasicSquareMat<T> result(n, n);
+    for (int i = 0; i < n; ++i) {
+        const T* a = left.row(i);
+        T* out = result[i];
+        for (int k = left.colBegin(i); k < left.colEnd(i); ++k) {
+            const T aik = a[k];
+            const T* b = right[k];
+            for (int j = 0; j < n; ++j) {
+                out[j] += aik * b[j];
+            }
+        }
+    }
+    return result;
+}
+
+// Dense times banded: left(i, k) scales only the band of row k of right.
+template <typename T>
+BasicSquareMat<T> BasicBandedMat<T>::multiply(const BasicConstMatrixView<T>& left, const BasicBandedMat& right) {
+    requireSameSize(left.getRows(), right.n, "multiplication");
+    const int n = right.n;
+    BasicSquareMat<T> result(n, n);
+    for (int i = 0; i < n; ++i) {
+        const T* a = left[i];
+        T* out = result[i];
+        for (int k = 0; k < n; ++k) {
+            const T aik = a[k];
+            const T* b = right.row(k);
+            for (int j = right.colBegin(k); j < right.colEnd(k); ++j) {
+                out[j] += aik * b[j];
+            }
+        }
+    }
+    return result;
+}
+
+// Transpose: element (i, j) moves to (j, i) and the bandwidths swap.
+template <typename T>
+BasicBandedMat<T> BasicBandedMat<T>::transpose(const BasicBandedMat& mat) {
+    BasicBandedMat result(mat.n, mat.upper, mat.lower);
+    for (int i = 0; i < mat.n; ++i) {
+        const T* src = mat.row(i);
+        for (int j = mat.colBegin(i); j < mat.colEnd(i); ++j) {
+            result.row(j)[i] = src[j];
+        }
+    }
+    return result;
+}
+
+// Explicit instantiations for the supported element types.
+template class BasicBandedMat<float>;
+template class BasicBandedMat<double>;
+template class BasicBandedMat<std::int64_t>;
+template class BasicBandedMat<std::complex<double>>;
+
+}
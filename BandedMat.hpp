@@ -0,0 +1,256 @@
+// adar101101@gmail.com
+
+#pragma once
+#include <complex>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+#include "SquareMat.hpp"
+
+/**
+ * @file BandedMat.hpp
+ * @brief Declaration of the BasicBandedMat class, a banded matrix stored by diagonals.
+ */
+
+namespace Matrix {
+
+/**
+ * @class BasicBandedMat
+ * @brief Square matrix of T whose non-zeros lie within a band around the diagonal.
+ *
+ * Element (i, j) can be non-zero only for -lower <= j - i <= upper. Each row stores its
+ * lower + upper + 1 band elements, so memory and the cost of every operation grow with
+ * n * bandwidth instead of n², and tridiagonal (1, 1) or pentadiagonal (2, 2) operators with
+ * millions of rows fit easily. The determinant of a tridiagonal matrix uses the three-term
+ * recurrence (O(n), exact for integers); wider bands use elimination with partial pivoting
+ * inside the band.
+ *
+ * The member definitions live in BandedMat.cpp and are explicitly instantiated for the same
+ * element types as BasicSquareMat.
+ * @tparam T Element type.
+ */
+template <typename T>
+class BasicBandedMat {
+    int n;                ///< Number of rows and columns.
+    int lower;            ///< Number of sub-diagonals.
+    int upper;            ///< Number of super-diagonals.
+    std::vector<T> band;  ///< Row i holds columns i - lower .. i + upper; positions outside the matrix stay zero.
+
+    /**
+     * @brief Returns the width of a stored row.
+     */
+    int width() const { return lower + upper + 1; }
+
+    /**
+     * @brief Returns the first column of row i inside the band.
+     */
+    int colBegin(int i) const { return i > lower ? i - lower : 0; }
+
+    /**
+     * @brief Returns one past the last column of row i inside the band.
+     */
+    int colEnd(int i) const { return n - i > upper ? i + upper + 1 : n; }
+
+    /**
+     * @brief Returns a pointer p such that p[j] is element (i, j) for j in [colBegin(i), colEnd(i)).
+     */
+    const T* row(int i) const { return band.data() + (size_t)i * width() + lower - i; }
+
+    /**
+     * @brief Writable version of row().
+     */
+    T* row(int i) { return band.data() + (size_t)i * width() + lower - i; }
+
+    // Kernels behind the non-member operators.
+    static BasicBandedMat add(const BasicBandedMat& left, const BasicBandedMat& right);
+    static BasicBandedMat subtract(const BasicBandedMat& left, const BasicBandedMat& right);
+    static BasicBandedMat scale(const BasicBandedMat& mat, T scalar);
+    static BasicBandedMat multiply(const BasicBandedMat& left, const BasicBandedMat& right);
+    static BasicSquareMat<T> multiply(const BasicBandedMat& left, const BasicConstMatrixView<T>& right);
+    static BasicSquareMat<T> multiply(const BasicConstMatrixView<T>& left, const BasicBandedMat& right);
+    static BasicBandedMat transpose(const BasicBandedMat& mat);
+
+public:
+    //
+    // Constructors
+    //
+
+    /**
+     * @brief Constructs an all-zero banded matrix.
+     * @param size Number of rows and columns.
+     * @param lower Number of sub-diagonals (1 for tridiagonal).
+     * @param upper Number of super-diagonals (1 for tridiagonal).
+     * @throws std::invalid_argument if size <= 0 or a bandwidth is negative or >= size.
+     */
+    BasicBandedMat(int size, int lower, int upper);
+
+    /**
+     * @brief Copies the band of a dense matrix (or view); elements outside it are ignored.
+     * @param dense Matrix to convert.
+     * @param lower Number of sub-diagonals.
+     * @param upper Number of super-diagonals.
+     * @throws std::invalid_argument if a bandwidth is negative or >= the matrix size.
+     */
+    BasicBandedMat(const BasicConstMatrixView<T>& dense, int lower, int upper);
+
+    //
+    // Element Access
+    //
+
+    /**
+     * @brief Returns the element at (row, col); elements outside the band are zero.
+     * @param row Rows number.
+     * @param col Columns number.
+     * @return Element value.
+     * @throws std::out_of_range if the index is outside the matrix.
+     */
+    T operator()(int row, int col) const;
+
+    /**
+     * @brief Sets the element at (row, col), which must lie inside the band.
+     * @param row Rows number.
+     * @param col Columns number.
+     * @param value New value.
+     * @throws std::out_of_range if the index is outside the matrix or the band.
+     */
+    void set(int row, int col, T value);
+
+    //
+    // Utilities
+    //
+
+    /**
+     * @brief Returns the number of rows.
+     * @return Number of rows.
+     */
+    int getRows() const;
+
+    /**
+     * @brief Returns the number of columns.
+     * @return Number of columns.
+     */
+    int getCols() const;
+
+    /**
+     * @brief Returns the number of sub-diagonals.
+     * @return Lower bandwidth.
+     */
+    int getLowerBandwidth() const;
+
+    /**
+     * @brief Returns the number of super-diagonals.
+     * @return Upper bandwidth.
+     */
+    int getUpperBandwidth() const;
+
+    /**
+     * @brief Returns the sum of all elements in the matrix.
+     * @return Sum of elements.
+     */
+    T countSum() const;
+
+    /**
+     * @brief Converts to a dense matrix, with zeros outside the band.
+     * @return Dense copy of this matrix.
+     */
+    BasicSquareMat<T> toDense() const;
+
+    /**
+     * @brief Computes the determinant in O(n * lower * (lower + upper)), O(n) for tridiagonal.
+     *
+     * Integer matrices wider than tridiagonal are eliminated in long double and rounded.
+     * @return Determinant value.
+     */
+    T operator!() const;
+
+    /**
+     * @brief Checks if two banded matrices are equal (same size, bandwidths and elements).
+     * @param other Matrix to compare.
+     * @return True if equal.
+     */
+    bool operator==(const BasicBandedMat& other) const;
+
+    /**
+     * @brief Checks if two banded matrices are not equal.
+     * @param other Matrix to compare.
+     * @return True if not equal.
+     */
+    bool operator!=(const BasicBandedMat& other) const;
+
+    //
+    // Friend Non-member Operators
+    //
+
+    /**
+     * @brief Adds two banded matrices; the result has the wider of each bandwidth.
+     * @param left Left operand.
+     * @param right Right operand.
+     * @return New banded matrix containing the sum.
+     */
+    friend BasicBandedMat operator+(const BasicBandedMat& left, const BasicBandedMat& right) { return add(left, right); }
+
+    /**
+     * @brief Subtracts one banded matrix from another; the result has the wider of each bandwidth.
+     * @param left Left operand.
+     * @param right Right operand.
+     * @return New banded matrix containing the difference.
+     */
+    friend BasicBandedMat operator-(const BasicBandedMat& left, const BasicBandedMat& right) { return subtract(left, right); }
+
+    /**
+     * @brief Multiplies each element by a scalar.
+     * @param mat Matrix operand.
+     * @param scalar Scalar operand.
+     * @return New banded matrix with elements scaled.
+     */
+    friend BasicBandedMat operator*(const BasicBandedMat& mat, T scalar) { return scale(mat, scalar); }
+
+    /**
+     * @brief Multiplies each element by a scalar (scalar on left).
+     * @param scalar Scalar operand.
+     * @param mat Matrix operand.
+     * @return New banded matrix with elements scaled.
+     */
+    friend BasicBandedMat operator*(T scalar, const BasicBandedMat& mat) { return scale(mat, scalar); }
+
+    /**
+     * @brief Multiplies two banded matrices; the bandwidths of the result are the sums of theirs.
+     * @param left Left operand.
+     * @param right Right operand.
+     * @return New banded matrix containing the product.
+     */
+    friend BasicBandedMat operator*(const BasicBandedMat& left, const BasicBandedMat& right) { return multiply(left, right); }
+
+    /**
+     * @brief Multiplies a banded matrix by a dense matrix or view.
+     * @param left Banded operand.
+     * @param right Dense operand.
+     * @return New dense matrix containing the product.
+     */
+    friend BasicSquareMat<T> operator*(const BasicBandedMat& left, const BasicConstMatrixView<T>& right) { return multiply(left, right); }
+
+    /**
+     * @brief Multiplies a dense matrix or view by a banded matrix.
+     * @param left Dense operand.
+     * @param right Banded operand.
+     * @return New dense matrix containing the product.
+     */
+    friend BasicSquareMat<T> operator*(const BasicConstMatrixView<T>& left, const BasicBandedMat& right) { return multiply(left, right); }
+
+    /**
+     * @brief Returns the transpose, with the bandwidths swapped.
+     * @param mat Matrix to transpose.
+     * @return Transposed banded matrix.
+     */
+    friend BasicBandedMat operator~(const BasicBandedMat& mat) { return transpose(mat); }
+};
+
+/// Banded matrix of doubles.
+using BandedMat = BasicBandedMat<double>;
+
+extern template class BasicBandedMat<float>;
+extern template class BasicBandedMat<double>;
+extern template class BasicBandedMat<std::int64_t>;
+extern template class BasicBandedMat<std::complex<double>>;
+
+}
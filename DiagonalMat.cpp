@@ -0,0 +1,243 @@
+// adar101101@gmail.com
+
+#include <stdexcept>
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <complex>
+#include <cstdint>
+#include "DiagonalMat.hpp"
+
+namespace st = std;
+
+namespace Matrix {
+
+namespace {
+
+// Throw if two operands differ in size; what names the operation for the message.
+void requireSameSize(int left, int right, const char* what) {
+    if (left != right) {
+        throw st::invalid_argument(st::string("Matrices must have the same dimensions for ") + what);
+    }
+}
+
+}
+
+// Constructor: all-zero diagonal of the given size.
+template <typename T>
+BasicDiagonalMat<T>::BasicDiagonalMat(int size) {
+    if (size <= 0) {
+        throw st::invalid_argument("Matrix dimensions must be positive");
+    }
+    diagonal.assign((size_t)size, T(0));
+}
+
+// Constructor: take ownership of the diagonal elements.
+template <typename T>
+BasicDiagonalMat<T>::BasicDiagonalMat(st::vector<T> values) : diagonal(st::move(values)) {
+    if (diagonal.empty()) {
+        throw st::invalid_argument("Matrix dimensions must be positive");
+    }
+}
+
+// Dense constructor: copy the diagonal.
+template <typename T>
+BasicDiagonalMat<T>::BasicDiagonalMat(const BasicConstMatrixView<T>& dense) : BasicDiagonalMat(dense.getRows()) {
+    for (int i = 0; i < getRows(); ++i) {
+        diagonal[i] = dense[i][i];
+    }
+}
+
+// Access element at (row, col) with bounds checking; off-diagonal elements read as zero.
+template <typename T>
+T BasicDiagonalMat<T>::operator()(int r, int c) const {
+    const int n = getRows();
+    if (r < 0 || r >= n || c < 0 || c >= n) {
+        throw st::out_of_range("Index out of range of matrix");
+    }
+    return r == c ? diagonal[r] : T(0);
+}
+
+// Set element at (row, col), which must be on the diagonal.
+template <typename T>
+void BasicDiagonalMat<T>::set(int r, int c, T value) {
+    const int n = getRows();
+    if (r < 0 || r >= n || c < 0 || c >= n) {
+        throw st::out_of_range("Index out of range of matrix");
+    }
+    if (r != c) {
+        throw st::out_of_range("Index off the diagonal of a diagonal matrix");
+    }
+    diagonal[r] = value;
+}
+
+// Get number of rows in the matrix.
+template <typename T>
+int BasicDiagonalMat<T>::getRows() const { return (int)diagonal.size(); }
+
+// Get number of columns in the matrix.
+template <typename T>
+int BasicDiagonalMat<T>::getCols() const { return (int)diagonal.size(); }
+
+// Calculate sum of all elements: the trace.
+template <typename T>
+T BasicDiagonalMat<T>::countSum() const {
+    T sum = T(0);
+    for (const T& value : diagonal) sum += value;
+    return sum;
+}
+
+// Write the diagonal into a zeroed dense matrix.
+template <typename T>
+BasicSquareMat<T> BasicDiagonalMat<T>::toDense() const {
+    const int n = getRows();
+    BasicSquareMat<T> result(n, n);
+    for (int i = 0; i < n; ++i) {
+        result[i][i] = diagonal[i];
+    }
+    return result;
+}
+
+// Raise each diagonal element to the power by repeated squaring.
+template <typename T>
+BasicDiagonalMat<T> BasicDiagonalMat<T>::operator^(long long power) const {
+    if (power < 0) {
+        throw st::invalid_argument("Negative exponents are not supported for matrices");
+    }
+    BasicDiagonalMat result(*this);
+    for (T& value : result.diagonal) {
+        T base = value;
+        T acc = T(1);
+        for (long long e = power; e > 0; e >>= 1) {
+            if (e & 1) acc *= base;
+            base *= base;
+        }
+        value = acc;
+    }
+    return result;
+}
+
+// Determinant of a diagonal matrix: the product of its diagonal.
+template <typename T>
+T BasicDiagonalMat<T>::operator!() const {
+    T det = T(1);
+    for (const T& value : diagonal) det *= value;
+    return det;
+}
+
+// Compare matrices for equality (size and diagonal).
+template <typename T>
+bool BasicDiagonalMat<T>::operator==(const BasicDiagonalMat& other) const {
+    return diagonal == other.diagonal;
+}
+
+// Compare matrices for inequality.
+template <typename T>
+bool BasicDiagonalMat<T>::operator!=(const BasicDiagonalMat& other) const {
+    return !(*this == other);
+}
+
+// Add two diagonal matrices element by element.
+template <typename T>
+BasicDiagonalMat<T> BasicDiagonalMat<T>::add(const BasicDiagonalMat& left, const BasicDiagonalMat& right) {
+    requireSameSize(left.getRows(), right.getRows(), "addition");
+    BasicDiagonalMat result(left);
+    for (size_t i = 0; i < result.diagonal.size(); ++i) result.diagonal[i] += right.diagonal[i];
+    return result;
+}
+
+// Subtract one diagonal matrix from another element by element.
+template <typename T>
+BasicDiagonalMat<T> BasicDiagonalMat<T>::subtract(const BasicDiagonalMat& left, const BasicDiagonalMat& right) {
+    requireSameSize(left.getRows(), right.getRows(), "subtraction");
+    BasicDiagonalMat result(left);
+    for (size_t i = 0; i < result.diagonal.size(); ++i) result.diagonal[i] -= right.diagonal[i];
+    return result;
+}
+
+// Product of two diagonal matrices: the element-wise product of the diagonals.
+template <typename T>
+BasicDiagonalMat<T> BasicDiagonalMat<T>::multiply(const BasicDiagonalMat& left, const BasicDiagonalMat& right) {
+    requireSameSize(left.getRows(), right.getRows(), "multiplication");
+    BasicDiagonalMat result(left);
+    for (size_t i = 0; i < result.diagonal.size(); ++i) result.diagonal[i] *= right.diagonal[i];
+    return result;
+}
+
+// Multiply each diagonal element by a scalar.
+template <typename T>
+BasicDiagonalMat<T> BasicDiagonalMat<T>::scale(const BasicDiagonalMat& mat, T scalar) {
+    BasicDiagonalMat result(mat);
+    for (T& value : result.diagonal) value *= scalar;
+    return result;
+}
+
+// Diagonal times dense: row i of right scaled by diagonal element i.
+template <typename T>
+BasicSquareMat<T> BasicDiagonalMat<T>::multiply(const BasicDiagonalMat& left, const BasicConstMatrixView<T>& right) {
+    requireSameSize(left.getRows(), right.getRows(), "multiplication");
+    const int n = left.getRows();
+    BasicSquareMat<T> result(n, uninitialized);
+    for (int i = 0; i < n; ++i) {
+        const T d = left.diagonal[i];
+        const T* src = right[i];
+        T* out = result[i];
+        for (int j = 0; j < n; ++j) {
+            out[j] = d * src[j];
+        }
+    }
+    return result;
+}
+
+// Dense times diagonal: column j of left scaled by diagonal element j.
+template <typename T>
+BasicSquareMat<T> BasicDiagonalMat<T>::multiply(const BasicConstMatrixView<T>& left, const BasicDiagonalMat& right) {
+    requireSameSize(left.getRows(), right.getRows(), "multiplication");
+    const int n = right.getRows();
+    const T* d = right.diagonal.data();
+    BasicSquareMat<T> result(n, uninitialized);
+    for (int i = 0; i < n; ++i) {
+        const T* src = left[i];
+        T* out = result[i];
+        for (int j = 0; j < n; ++j) {
+            out[j] = src[j] * d[j];
+        }
+    }
+    return result;
+}
+
+// Dense plus (sign = 1) or minus (sign = -1) diagonal: a copy with the diagonal adjusted.
+template <typename T>
+BasicSquareMat<T> BasicDiagonalMat<T>::add(const BasicConstMatrixView<T>& dense, const BasicDiagonalMat& diag, T sign) {
+    requireSameSize(dense.getRows(), diag.getRows(), sign == T(1) ? "addition" : "subtraction");
+    BasicSquareMat<T> result(dense);
+    for (int i = 0; i < diag.getRows(); ++i) {
+        result[i][i] += sign * diag.diagonal[i];
+    }
+    return result;
+}
+
+// Diagonal minus dense: every element negated into a fresh buffer, then the diagonal added.
+template <typename T>
+BasicSquareMat<T> BasicDiagonalMat<T>::subtract(const BasicDiagonalMat& diag, const BasicConstMatrixView<T>& dense) {
+    requireSameSize(diag.getRows(), dense.getRows(), "subtraction");
+    const int n = diag.getRows();
+    BasicSquareMat<T> result(n, uninitialized);
+    for (int i = 0; i < n; ++i) {
+        const T* src = dense[i];
+        T* out = result[i];
+        for (int j = 0; j < n; ++j) {
+            out[j] = -src[j];
+        }
+        out[i] += diag.diagonal[i];
+    }
+    return result;
+}
+
+// Explicit instantiations for the supported element types.
+template class BasicDiagonalMat<float>;
+template class BasicDiagonalMat<double>;
+template class BasicDiagonalMat<std::int64_t>;
+template class BasicDiagonalMat<std::complex<double>>;
+
+}
@@ -0,0 +1,397 @@
+// adar101101@gmail.com
+
+#pragma once
+#include <complex>
+#include <cstdint>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+#include "SquareMat.hpp"
+
+/**
+ * @file DiagonalMat.hpp
+ * @brief Declaration of the BasicDiagonalMat class and of the zero-storage Identity.
+ */
+
+namespace Matrix {
+
+/**
+ * @class BasicDiagonalMat
+ * @brief Diagonal square matrix of T that stores only its n diagonal elements.
+ *
+ * Products with a dense matrix are row (diag * dense) or column (dense * diag) scalings in
+ * O(n²); products and sums of two diagonal matrices, powers and the determinant are O(n).
+ *
+ * The member definitions live in DiagonalMat.cpp and are explicitly instantiated for the same
+ * element types as BasicSquareMat.
+ * @tparam T Element type.
+ */
+template <typename T>
+class BasicDiagonalMat {
+    std::vector<T> diagonal;   ///< Element (i, i) for each i.
+
+    // Kernels behind the non-member operators.
+    static BasicDiagonalMat add(const BasicDiagonalMat& left, const BasicDiagonalMat& right);
+    static BasicDiagonalMat subtract(const BasicDiagonalMat& left, const BasicDiagonalMat& right);
+    static BasicDiagonalMat multiply(const BasicDiagonalMat& left, const BasicDiagonalMat& right);
+    static BasicDiagonalMat scale(const BasicDiagonalMat& mat, T scalar);
+    static BasicSquareMat<T> multiply(const BasicDiagonalMat& left, const BasicConstMatrixView<T>& right);
+    static BasicSquareMat<T> multiply(const BasicConstMatrixView<T>& left, const BasicDiagonalMat& right);
+    static BasicSquareMat<T> add(const BasicConstMatrixView<T>& dense, const BasicDiagonalMat& diag, T sign);
+    static BasicSquareMat<T> subtract(const BasicDiagonalMat& diag, const BasicConstMatrixView<T>& dense);
+
+public:
+    //
+    // Constructors
+    //
+
+    /**
+     * @brief Constructs an all-zero diagonal matrix.
+     * @param size Number of rows and columns.
+     * @throws std::invalid_argument if size <= 0.
+     */
+    explicit BasicDiagonalMat(int size);
+
+    /**
+     * @brief Constructs a diagonal matrix from its diagonal elements.
+     * @param diagonal Element (i, i) for each i.
+     * @throws std::invalid_argument if diagonal is empty.
+     */
+    explicit BasicDiagonalMat(std::vector<T> diagonal);
+
+    /**
+     * @brief Copies the diagonal of a dense matrix (or view); the other elements are ignored.
+     * @param dense Matrix to convert.
+     */
+    explicit BasicDiagonalMat(const BasicConstMatrixView<T>& dense);
+
+    //
+    // Element Access
+    //
+
+    /**
+     * @brief Returns the element at (row, col); off-diagonal elements are zero.
+     * @param row Rows number.
+     * @param col Columns number.
+     * @return Element value.
+     * @throws std::out_of_range if the index is outside the matrix.
+     */
+    T operator()(int row, int col) const;
+
+    /**
+     * @brief Sets the element at (row, col), which must lie on the diagonal.
+     * @param row Rows number.
+     * @param col Columns number.
+     * @param value New value.
+     * @throws std::out_of_range if the index is outside the matrix or off the diagonal.
+     */
+    void set(int row, int col, T value);
+
+    //
+    // Utilities
+    //
+
+    /**
+     * @brief Returns the number of rows.
+     * @return Number of rows.
+     */
+    int getRows() const;
+
+    /**
+     * @brief Returns the number of columns.
+     * @return Number of columns.
+     */
+    int getCols() const;
+
+    /**
+     * @brief Returns the sum of all elements (the trace).
+     * @return Sum of elements.
+     */
+    T countSum() const;
+
+    /**
+     * @brief Converts to a dense matrix.
+     * @return Dense copy of this matrix.
+     */
+    BasicSquareMat<T> toDense() const;
+
+    /**
+     * @brief Raises the matrix to an integer non-negative power, element by element on the diagonal.
+     * @param power Exponent.
+     * @return Matrix raised to the given power.
+     * @throws std::invalid_argument if power < 0.
+     */
+    BasicDiagonalMat operator^(long long power) const;
+
+    /**
+     * @brief Computes the determinant as the product of the diagonal, in O(n).
+     * @return Determinant value.
+     */
+    T operator!() const;
+
+    /**
+     * @brief Checks if two diagonal matrices are equal (same size and same elements).
+     * @param other Matrix to compare.
+     * @return True if equal.
+     */
+    bool operator==(const BasicDiagonalMat& other) const;
+
+    /**
+     * @brief Checks if two diagonal matrices are not equal.
+     * @param other Matrix to compare.
+     * @return True if not equal.
+     */
+    bool operator!=(const BasicDiagonalMat& other) const;
+
+    //
+    // Friend Non-member Operators
+    //
+
+    /**
+     * @brief Adds two diagonal matrices in O(n).
+     * @param left Left operand.
+     * @param right Right operand.
+     * @return New diagonal matrix containing the sum.
+     */
+    friend BasicDiagonalMat operator+(const BasicDiagonalMat& left, const BasicDiagonalMat& right) { return add(left, right); }
+
+    /**
+     * @brief Subtracts one diagonal matrix from another in O(n).
+     * @param left Left operand.
+     * @param right Right operand.
+     * @return New diagonal matrix containing the difference.
+     */
+    friend BasicDiagonalMat operator-(const BasicDiagonalMat& left, const BasicDiagonalMat& right) { return subtract(left, right); }
+
+    /**
+     * @brief Multiplies two diagonal matrices in O(n).
+     * @param left Left operand.
+     * @param right Right operand.
+     * @return New diagonal matrix containing the product.
+     */
+    friend BasicDiagonalMat operator*(const BasicDiagonalMat& left, const BasicDiagonalMat& right) { return multiply(left, right); }
+
+    /**
+     * @brief Multiplies each diagonal element by a scalar.
+     * @param mat Matrix operand.
+     * @param scalar Scalar operand.
+     * @return New diagonal matrix with elements scaled.
+     */
+    friend BasicDiagonalMat operator*(const BasicDiagonalMat& mat, T scalar) { return scale(mat, scalar); }
+
+    /**
+     * @brief Multiplies each diagonal element by a scalar (scalar on left).
+     * @param scalar Scalar operand.
+     * @param mat Matrix operand.
+     * @return New diagonal matrix with elements scaled.
+     */
+    friend BasicDiagonalMat operator*(T scalar, const BasicDiagonalMat& mat) { return scale(mat, scalar); }
+
+    /**
+     * @brief Scales row i of a dense matrix or view by diagonal element i.
+     * @param left Diagonal operand.
+     * @param right Dense operand.
+     * @return New dense matrix containing the product.
+     */
+    friend BasicSquareMat<T> operator*(const BasicDiagonalMat& left, const BasicConstMatrixView<T>& right) { return multiply(left, right); }
+
+    /**
+     * @brief Scales column j of a dense matrix or view by diagonal element j.
+     * @param left Dense operand.
+     * @param right Diagonal operand.
+     * @return New dense matrix containing the product.
+     */
+    friend BasicSquareMat<T> operator*(const BasicConstMatrixView<T>& left, const BasicDiagonalMat& right) { return multiply(left, right); }
+
+    /**
+     * @brief Adds a diagonal matrix to a dense matrix or view: a copy plus n additions.
+     * @param left Dense operand.
+     * @param right Diagonal operand.
+     * @return New dense matrix containing the sum.
+     */
+    friend BasicSquareMat<T> operator+(const BasicConstMatrixView<T>& left, const BasicDiagonalMat& right) { return add(left, right, T(1)); }
+
+    /**
+     * @brief Adds a dense matrix or view to a diagonal matrix.
+     * @param left Diagonal operand.
+     * @param right Dense operand.
+     * @return New dense matrix containing the sum.
+     */
+    friend BasicSquareMat<T> operator+(const BasicDiagonalMat& left, const BasicConstMatrixView<T>& right) { return add(right, left, T(1)); }
+
+    /**
+     * @brief Subtracts a diagonal matrix from a dense matrix or view.
+     * @param left Dense operand.
+     * @param right Diagonal operand.
+     * @return New dense matrix containing the difference.
+     */
+    friend BasicSquareMat<T> operator-(const BasicConstMatrixView<T>& left, const BasicDiagonalMat& right) { return add(left, right, T(-1)); }
+
+    /**
+     * @brief Subtracts a dense matrix or view from a diagonal matrix: a negated copy plus n additions.
+     * @param left Diagonal operand.
+     * @param right Dense operand.
+     * @return New dense matrix containing the difference.
+     */
+    friend BasicSquareMat<T> operator-(const BasicDiagonalMat& left, const BasicConstMatrixView<T>& right) { return subtract(left, right); }
+
+    /**
+     * @brief Returns the transpose, which for a diagonal matrix is a copy.
+     * @param mat Matrix to transpose.
+     * @return Copy of mat.
+     */
+    friend BasicDiagonalMat operator~(const BasicDiagonalMat& mat) { return mat; }
+};
+
+/// Diagonal matrix of doubles.
+using DiagonalMat = BasicDiagonalMat<double>;
+
+extern template class BasicDiagonalMat<float>;
+extern template class BasicDiagonalMat<double>;
+extern template class BasicDiagonalMat<std::int64_t>;
+extern template class BasicDiagonalMat<std::complex<double>>;
+
+/**
+ * @class Identity
+ * @brief The n x n identity matrix, stored as nothing but its size.
+ *
+ * Multiplying by it copies the other operand, adding or subtracting it touches only the
+ * diagonal, and it converts implicitly to a BasicDiagonalMat of any element type, so it also
+ * combines with diagonal matrices.
+ */
+class Identity {
+    int n;   ///< Number of rows and columns.
+
+    /**
+     * @brief Throws std::invalid_argument unless the other operand has n rows.
+     */
+    void requireSize(int rows, const char* what) const {
+        if (rows != n) {
+            throw std::invalid_argument(std::string("Matrices must have the same dimensions for ") + what);
+        }
+    }
+
+    /**
+     * @brief Returns a copy of mat with sign added to each diagonal element.
+     */
+    template <typename T>
+    BasicSquareMat<T> addTo(const BasicSquareMat<T>& mat, T sign, const char* what) const {
+        requireSize(mat.getRows(), what);
+        BasicSquareMat<T> result(mat);
+        for (int i = 0; i < n; ++i) result[i][i] += sign;
+        return result;
+    }
+
+    /**
+     * @brief Returns the identity minus mat: mat negated, with 1 added to each diagonal element.
+     */
+    template <typename T>
+    BasicSquareMat<T> subtractFrom(const BasicSquareMat<T>& mat) const {
+        requireSize(mat.getRows(), "subtraction");
+        BasicSquareMat<T> result(n, uninitialized);
+        for (int i = 0; i < n; ++i) {
+            const T* src = mat[i];
+            T* out = result[i];
+            for (int j = 0; j < n; ++j) out[j] = -src[j];
+            out[i] += T(1);
+        }
+        return result;
+    }
+
+public:
+    /**
+     * @brief Constructs the identity of the given size.
+     * @param size Number of rows and columns.
+     * @throws std::invalid_argument if size <= 0.
+     */
+    explicit Identity(int size) : n(size) {
+        if (size <= 0) throw std::invalid_argument("Matrix dimensions must be positive");
+    }
+
+    /**
+     * @brief Returns the number of rows.
+     * @return Number of rows.
+     */
+    int getRows() const { return n; }
+
+    /**
+     * @brief Returns the number of columns.
+     * @return Number of columns.
+     */
+    int getCols() const { return n; }
+
+    /**
+     * @brief Materializes the identity as a dense matrix.
+     * @tparam T Element type of the result.
+     * @return Dense identity.
+     */
+    template <typename T = double>
+    BasicSquareMat<T> toDense() const { return BasicSquareMat<T>::identity(n); }
+
+    /**
+     * @brief Converts to a diagonal matrix of ones.
+     */
+    template <typename T>
+    operator BasicDiagonalMat<T>() const { return BasicDiagonalMat<T>(std::vector<T>(n, T(1))); }
+
+    /**
+     * @brief Multiplies two identities.
+     * @return The identity.
+     */
+    friend Identity operator*(const Identity& left, const Identity& right) {
+        left.requireSize(right.n, "multiplication");
+        return left;
+    }
+
+    /**
+     * @brief Multiplies by the identity: a copy of the matrix.
+     */
+    template <typename T>
+    friend BasicSquareMat<T> operator*(const Identity& left, const BasicSquareMat<T>& right) {
+        left.requireSize(right.getRows(), "multiplication");
+        return right;
+    }
+
+    /**
+     * @brief Multiplies by the identity: a copy of the matrix.
+     */
+    template <typename T>
+    friend BasicSquareMat<T> operator*(const BasicSquareMat<T>& left, const Identity& right) {
+        right.requireSize(left.getRows(), "multiplication");
+        return left;
+    }
+
+    /**
+     * @brief Adds the identity: a copy of the matrix with 1 added to the diagonal.
+     */
+    template <typename T>
+    friend BasicSquareMat<T> operator+(const BasicSquareMat<T>& left, const Identity& right) {
+        return right.addTo(left, T(1), "addition");
+    }
+
+    /**
+     * @brief Adds the identity: a copy of the matrix with 1 added to the diagonal.
+     */
+    template <typename T>
+    friend BasicSquareMat<T> operator+(const Identity& left, const BasicSquareMat<T>& right) {
+        return left.addTo(right, T(1), "addition");
+    }
+
+    /**
+     * @brief Subtracts the identity: a copy of the matrix with 1 subtracted from the diagonal.
+     */
+    template <typename T>
+    friend BasicSquareMat<T> operator-(const BasicSquareMat<T>& left, const Identity& right) {
+        return right.addTo(left, T(-1), "subtraction");
+    }
+
+    /**
+     * @brief Subtracts from the identity (e.g. I - A): the negated matrix with 1 added to the diagonal.
+     */
+    template <typename T>
+    friend BasicSquareMat<T> operator-(const Identity& left, const BasicSquareMat<T>& right) {
+        return left.subtractFrom(right);
+    }
+};
+
+}
@@ -0,0 +1,519 @@
+// adar101101@gmail.com
+
+#pragma once
+#include <cmath>
+#include <cstddef>
+#include <initializer_list>
+#include <iostream>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include "SquareMat.hpp"
+
+/**
+ * @file FixedSquareMat.hpp
+ * @brief Declaration of FixedSquareMat, a square matrix whose dimension is a compile-time constant.
+ */
+
+namespace Matrix {
+
+namespace detail {
+
+template <typename F, size_t... I>
+constexpr void unrollImpl(F&& f, std::index_sequence<I...>) {
+    (f(std::integral_constant<size_t, I>{}), ...);
+}
+
+/**
+ * @brief Calls f(std::integral_constant<size_t, I>) for I = 0 .. Count-1 as straight-line code.
+ * @param f Callable taking the index as a compile-time constant.
+ */
+template <size_t Count, typename F>
+constexpr void unroll(F&& f) {
+    unrollImpl(f, std::make_index_sequence<Count>{});
+}
+
+} // namespace detail
+
+/**
+ * @class FixedSquareMat
+ * @brief N x N matrix of T stored inline, with every kernel unrolled at compile time.
+ *
+ * Supports the same operators as SquareMat. Dimensions are part of the type, so mismatched
+ * operands fail to compile and no runtime dimension checks are made. Most operations are
+ * constexpr. Converts to and from the dynamic BasicSquareMat<T> so both kinds can be mixed.
+ * Ordering comparisons and scalar modulo do not compile for complex elements.
+ * @tparam N Number of rows and columns (must be positive).
+ * @tparam T Element type.
+ */
+template <size_t N, typename T = double>
+class FixedSquareMat {
+    static_assert(N > 0, "Matrix dimensions must be positive");
+
+private:
+    T e[N * N] = {};   ///< Row-major elements.
+
+    static constexpr const T& at(const FixedSquareMat& m, size_t i, size_t j) { return m.e[i * N + j]; }
+
+    /**
+     * @brief Applies f to every element of this matrix in place.
+     * @param f Callable taking a reference to an element.
+     */
+    template <typename F>
+    constexpr FixedSquareMat& apply(F f) {
+        detail::unroll<N * N>([&](auto k) { f(e[k]); });
+        return *this;
+    }
+
+    /**
+     * @brief Builds a new matrix whose element k is f(k).
+     * @param f Callable taking the flat index as a compile-time constant.
+     * @return New matrix.
+     */
+    template <typename F>
+    static constexpr FixedSquareMat generate(F f) {
+        FixedSquareMat result;
+        detail::unroll<N * N>([&](auto k) { result.e[k] = f(k); });
+        return result;
+    }
+
+public:
+    //
+    // Constructors
+    //
+
+    /**
+     * @brief Constructs a zero matrix.
+     */
+    constexpr FixedSquareMat() = default;
+
+    /**
+     * @brief Constructs a matrix from N*N values given in row-major order.
+     * @param values Row-major elements.
+     * @throws std::invalid_argument if values does not hold exactly N*N elements.
+     */
+    constexpr FixedSquareMat(std::initializer_list<T> values) {
+        if (values.size() != N * N) {
+            throw std::invalid_argument("Initializer must hold exactly N*N values");
+        }
+        size_t k = 0;
+        for (T v : values) e[k++] = v;
+    }
+
+    /**
+     * @brief Converts a dynamic matrix of the same size.
+     * @param other Dynamic matrix to copy.
+     * @throws std::invalid_argument if other is not N x N.
+     */
+    explicit FixedSquareMat(const BasicSquareMat<T>& other) {
+        if (other.getRows() != (int)N || other.getCols() != (int)N) {
+            throw std::invalid_argument("Matrix dimensions do not match the fixed size");
+        }
+        for (size_t i = 0; i < N; ++i) {
+            const T* row = other[i];
+            for (size_t j = 0; j < N; ++j) e[i * N + j] = row[j];
+        }
+    }
+
+    /**
+     * @brief Converts to a dynamic matrix, so fixed and dynamic matrices can be mixed.
+     * @return Dynamic copy of this matrix.
+     */
+    operator BasicSquareMat<T>() const {
+        BasicSquareMat<T> result((int)N, (int)N);
+        for (size_t i = 0; i < N; ++i) {
+            T* row = result[i];
+            for (size_t j = 0; j < N; ++j) row[j] = e[i * N + j];
+        }
+        return result;
+    }
+
+    /**
+     * @brief Returns the N x N identity matrix.
+     * @return Identity matrix.
+     */
+    static constexpr FixedSquareMat identity() {
+        return generate([](auto k) { return (k / N == k % N) ? T(1) : T(0); });
+    }
+
+    //
+    // Element Access
+    //
+
+    /**
+     * @brief Return matrix row, given row index.
+     * @param row Index of wanted row.
+     * @return Pointer to the wanted row.
+     */
+    constexpr T* operator[](size_t row) {
+        if (row >= N) throw std::out_of_range("Row index out of range");
+        return e + row * N;
+    }
+
+    /**
+     * @brief Return matrix row, given row index (const version).
+     * @param row Index of wanted row.
+     * @return Pointer to the wanted row.
+     */
+    constexpr const T* operator[](size_t row) const {
+        if (row >= N) throw std::out_of_range("Row index out of range");
+        return e + row * N;
+    }
+
+    /**
+     * @brief Accesses/modifies the element at (row, col).
+     * @param row Rows number.
+     * @param col Columns number.
+     * @return Reference to the element.
+     */
+    constexpr T& operator()(int row, int col) {
+        if (row < 0 || row >= (int)N || col < 0 || col >= (int)N) {
+            throw std::out_of_range("Index out of range of matrix");
+        }
+        return e[row * N + col];
+    }
+
+    /**
+     * @brief Accesses the element at (row, col), for const contexts.
+     * @param row Rows number.
+     * @param col Columns number.
+     * @return Const reference to the element.
+     */
+    constexpr const T& operator()(int row, int col) const {
+        if (row < 0 || row >= (int)N || col < 0 || col >= (int)N) {
+            throw std::out_of_range("Index out of range of matrix");
+        }
+        return e[row * N + col];
+    }
+
+    //
+    // Utilities
+    //
+
+    /**
+     * @brief Returns the number of rows.
+     * @return N.
+     */
+    static constexpr int getRows() { return (int)N; }
+
+    /**
+     * @brief Returns the number of columns.
+     * @return N.
+     */
+    static constexpr int getCols() { return (int)N; }
+
+    /**
+     * @brief Returns the row-major element buffer.
+     * @return Pointer to element (0, 0).
+     */
+    constexpr const T* getData() const { return e; }
+
+    /**
+     * @brief Sets all elements to the specified value.
+     * @param value Value to assign to all elements.
+     */
+    constexpr void fill(T value) {
+        apply([value](T& x) { x = value; });
+    }
+
+    /**
+     * @brief Returns the sum of all elements in the matrix.
+     * @return Sum of elements.
+     */
+    constexpr T countSum() const {
+        T sum = 0;
+        detail::unroll<N * N>([&](auto k) { sum += e[k]; });
+        return sum;
+    }
+
+    //
+    // Arithmetic Assignment Operators (in-place)
+    //
+
+    /**
+     * @brief In-place matrix addition.
+     */
+    constexpr FixedSquareMat& operator+=(const FixedSquareMat& other) {
+        detail::unroll<N * N>([&](auto k) { e[k] += other.e[k]; });
+        return *this;
+    }
+
+    /**
+     * @brief In-place matrix subtraction.
+     */
+    constexpr FixedSquareMat& operator-=(const FixedSquareMat& other) {
+        detail::unroll<N * N>([&](auto k) { e[k] -= other.e[k]; });
+        return *this;
+    }
+
+    /**
+     * @brief In-place matrix multiplication.
+     */
+    constexpr FixedSquareMat& operator*=(const FixedSquareMat& other) {
+        return *this = *this * other;
+    }
+
+    /**
+     * @brief In-place scalar multiplication.
+     */
+    constexpr FixedSquareMat& operator*=(T scalar) {
+        return apply([scalar](T& x) { x *= scalar; });
+    }
+
+    /**
+     * @brief In-place scalar division.
+     * @throws std::invalid_argument if scalar == 0.
+     */
+    constexpr FixedSquareMat& operator/=(T scalar) {
+        if (scalar == T(0)) throw std::invalid_argument("Division by zero");
+        return apply([scalar](T& x) { x /= scalar; });
+    }
+
+    /**
+     * @brief In-place scalar modulo operation (applies fmod to each element).
+     * @throws std::invalid_argument if scalar == 0.
+     */
+    FixedSquareMat& operator%=(int scalar) {
+        return *this = *this % scalar;
+    }
+
+    /**
+     * @brief In-place element-wise multiplication.
+     */
+    constexpr FixedSquareMat& operator%=(const FixedSquareMat& other) {
+        detail::unroll<N * N>([&](auto k) { e[k] *= other.e[k]; });
+        return *this;
+    }
+
+    //
+    // Increment / Decrement
+    //
+
+    /**
+     * @brief Prefix increment: increases each element by 1.
+     */
+    constexpr FixedSquareMat& operator++() { return apply([](T& x) { x += T(1); }); }
+
+    /**
+     * @brief Postfix increment: returns copy before increment.
+     */
+    constexpr FixedSquareMat operator++(int) {
+        FixedSquareMat tmp(*this);
+        ++(*this);
+        return tmp;
+    }
+
+    /**
+     * @brief Prefix decrement: decreases each element by 1.
+     */
+    constexpr FixedSquareMat& operator--() { return apply([](T& x) { x -= T(1); }); }
+
+    /**
+     * @brief Postfix decrement: returns copy before decrement.
+     */
+    constexpr FixedSquareMat operator--(int) {
+        FixedSquareMat tmp(*this);
+        --(*this);
+        return tmp;
+    }
+
+    //
+    // Comparison Operators (ordering compares the sum of elements; not for complex elements)
+    //
+
+    /**
+     * @brief Checks if all elements are equal.
+     */
+    constexpr bool operator==(const FixedSquareMat& other) const {
+        for (size_t k = 0; k < N * N; ++k) {
+            if (e[k] != other.e[k]) return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Checks if two matrices are not equal.
+     */
+    constexpr bool operator!=(const FixedSquareMat& other) const { return !(*this == other); }
+
+    /**
+     * @brief Compares sum of elements. True if this matrix's sum > other's sum.
+     */
+    constexpr bool operator>(const FixedSquareMat& other) const {
+        static_assert(!detail::IsComplex<T>::value, "Ordering comparisons are not defined for complex matrices");
+        return countSum() > other.countSum();
+    }
+
+    /**
+     * @brief Compares sum of elements. True if this matrix's sum >= other's sum.
+     */
+    constexpr bool operator>=(const FixedSquareMat& other) const {
+        static_assert(!detail::IsComplex<T>::value, "Ordering comparisons are not defined for complex matrices");
+        return countSum() >= other.countSum();
+    }
+
+    /**
+     * @brief Compares sum of elements. True if this matrix's sum < other's sum.
+     */
+    constexpr bool operator<(const FixedSquareMat& other) const {
+        static_assert(!detail::IsComplex<T>::value, "Ordering comparisons are not defined for complex matrices");
+        return countSum() < other.countSum();
+    }
+
+    /**
+     * @brief Compares sum of elements. True if this matrix's sum <= other's sum.
+     */
+    constexpr bool operator<=(const FixedSquareMat& other) const {
+        static_assert(!detail::IsComplex<T>::value, "Ordering comparisons are not defined for complex matrices");
+        return countSum() <= other.countSum();
+    }
+
+    //
+    // Exponentiation and Determinant
+    //
+
+    /**
+     * @brief Raises the matrix to an integer non-negative power by repeated squaring.
+     * @param power Exponent.
+     * @return Matrix raised to the given power.
+     * @throws std::invalid_argument if power < 0.
+     */
+    constexpr FixedSquareMat operator^(long long power) const {
+        if (power < 0) {
+            throw std::invalid_argument("Negative exponents are not supported for matrices");
+        }
+        FixedSquareMat result = identity();
+        FixedSquareMat base(*this);
+        while (power > 0) {
+            if (power & 1) result = result * base;
+            power >>= 1;
+            if (power > 0) base = base * base;
+        }
+        return result;
+    }
+
+    /**
+     * @brief Computes the determinant by cofactor expansion unrolled at compile time.
+     * @return Determinant value.
+     */
+    constexpr T operator!() const {
+        if constexpr (N == 1) {
+            return e[0];
+        } else if constexpr (N == 2) {
+            return e[0] * e[3] - e[1] * e[2];
+        } else {
+            T det = 0;
+            detail::unroll<N>([&](auto c) {
+                FixedSquareMat<N - 1, T> minor;
+                detail::unroll<(N - 1) * (N - 1)>([&](auto k) {
+                    constexpr size_t flat = decltype(k)::value;
+                    constexpr size_t r = flat / (N - 1) + 1;
+                    constexpr size_t skip = decltype(c)::value;
+                    constexpr size_t col = flat % (N - 1) < skip ? flat % (N - 1) : flat % (N - 1) + 1;
+                    minor.e[k] = e[r * N + col];
+                });
+                det += ((c % 2 == 0) ? T(1) : T(-1)) * e[c] * !minor;
+            });
+            return det;
+        }
+    }
+
+    //
+    // Friend Non-member Operators
+    //
+
+    /**
+     * @brief Adds two matrices (element-wise).
+     */
+    friend constexpr FixedSquareMat operator+(const FixedSquareMat& left, const FixedSquareMat& right) {
+        return generate([&](auto k) { return left.e[k] + right.e[k]; });
+    }
+
+    /**
+     * @brief Subtracts one matrix from another (element-wise).
+     */
+    friend constexpr FixedSquareMat operator-(const FixedSquareMat& left, const FixedSquareMat& right) {
+        return generate([&](auto k) { return left.e[k] - right.e[k]; });
+    }
+
+    /**
+     * @brief Matrix product; every multiply-add is emitted as straight-line code.
+     */
+    friend constexpr FixedSquareMat operator*(const FixedSquareMat& left, const FixedSquareMat& right) {
+        return generate([&](auto k) {
+            constexpr size_t i = decltype(k)::value / N;
+            constexpr size_t j = decltype(k)::value % N;
+            T sum = 0;
+            detail::unroll<N>([&](auto p) { sum += at(left, i, p) * at(right, p, j); });
+            return sum;
+        });
+    }
+
+    /**
+     * @brief Multiplies each element by a scalar.
+     */
+    friend constexpr FixedSquareMat operator*(const FixedSquareMat& mat, T scalar) {
+        return generate([&](auto k) { return mat.e[k] * scalar; });
+    }
+
+    /**
+     * @brief Multiplies each element by a scalar (scalar on left).
+     */
+    friend constexpr FixedSquareMat operator*(T scalar, const FixedSquareMat& mat) {
+        return mat * scalar;
+    }
+
+    /**
+     * @brief Divides each element by a scalar.
+     * @throws std::invalid_argument if scalar == 0.
+     */
+    friend constexpr FixedSquareMat operator/(const FixedSquareMat& mat, T scalar) {
+        if (scalar == T(0)) throw std::invalid_argument("Division by zero");
+        return generate([&](auto k) { return mat.e[k] / scalar; });
+    }
+
+    /**
+     * @brief Element-wise multiplication (Hadamard product).
+     */
+    friend constexpr FixedSquareMat operator%(const FixedSquareMat& left, const FixedSquareMat& right) {
+        return generate([&](auto k) { return left.e[k] * right.e[k]; });
+    }
+
+    /**
+     * @brief Element-wise modulo operation (fmod) with a scalar.
+     * @throws std::invalid_argument if scalar == 0.
+     */
+    friend FixedSquareMat operator%(const FixedSquareMat& mat, int scalar) {
+        static_assert(!detail::IsComplex<T>::value, "Modulo is not defined for complex matrices");
+        if (scalar == 0) throw std::invalid_argument("Modulo by zero");
+        if constexpr (std::is_integral<T>::value) {
+            return generate([&](auto k) { return T(mat.e[k] % scalar); });
+        } else {
+            return generate([&](auto k) { return T(std::fmod(mat.e[k], scalar)); });
+        }
+    }
+
+    /**
+     * @brief Returns the transpose of the matrix.
+     */
+    friend constexpr FixedSquareMat operator~(const FixedSquareMat& mat) {
+        return generate([&](auto k) { return mat.e[(k % N) * N + k / N]; });
+    }
+
+    /**
+     * @brief Outputs the matrix to an output stream, formatted as rows of elements.
+     */
+    friend std::ostream& operator<<(std::ostream& stream, const FixedSquareMat& mat) {
+        for (size_t i = 0; i < N; ++i) {
+            for (size_t j = 0; j < N; ++j) {
+                stream << "[ " << mat.e[i * N + j] << " ]";
+            }
+            stream << std::endl;
+        }
+        return stream;
+    }
+
+    template <size_t M, typename U> friend class FixedSquareMat;
+};
+
+}
@@ -0,0 +1,201 @@
+// adar101101@gmail.com
+
+#include <algorithm>
+#include <complex>
+#include <cstdint>
+#include "Gemm.hpp"
+#include "MatrixMemory.hpp"
+#include "Parallel.hpp"
+#include "Simd.hpp"
+
+namespace st = std;
+
+namespace Matrix {
+
+namespace detail {
+
+namespace {
+
+// Aligned scratch buffer from the matrix heap, returned on scope exit.
+template <typename T>
+class PackBuffer {
+public:
+    explicit PackBuffer(size_t count)
+        : bytes(count * sizeof(T)), data(static_cast<T*>(allocateBuffer(bytes))) {}
+    ~PackBuffer() { freeBuffer(data, bytes); }
+    PackBuffer(const PackBuffer&) = delete;
+    PackBuffer& operator=(const PackBuffer&) = delete;
+    T* get() const { return data; }
+
+private:
+    size_t bytes;
+    T* data;
+};
+
+// C = A * B (or C += A * B) in i-k-j order, for products too small to repay packing.
+template <typename T>
+void gemmDirect(int m, int n, int k, const T* a, size_t lda, const T* b, size_t ldb, T* c, size_t ldc,
+                bool accumulate) {
+    for (int i = 0; i < m; ++i) {
+        const T* ai = a + (size_t)i * lda;
+        T* ci = c + (size_t)i * ldc;
+        int first = 0;
+        if (!accumulate) {
+            if (k == 0) {
+                st::fill(ci, ci + n, T(0));
+                continue;
+            }
+            const T ai0 = ai[0];
+            for (int j = 0; j < n; ++j) {
+                ci[j] = ai0 * b[j];
+            }
+            first = 1;
+        }
+        for (int p = first; p < k; ++p) {
+            const T aip = ai[p];
+            const T* bp = b + (size_t)p * ldb;
+            for (int j = 0; j < n; ++j) {
+                ci[j] += aip * bp[j];
+            }
+        }
+    }
+}
+
+// Copy an mc x kc block of A into MR-row slivers, each stored column by column
+// (MR consecutive elements per k); rows past mc are zero.
+template <typename T>
+void packA(const T* a, size_t lda, int mc, int kc, T* out) {
+    constexpr int MR = GemmBlocking<T>::MR;
+    for (int i0 = 0; i0 < mc; i0 += MR) {
+        const int rows = st::min(MR, mc - i0);
+        for (int p = 0; p < kc; ++p) {
+            for (int i = 0; i < rows; ++i) {
+                out[i] = a[(size_t)(i0 + i) * lda + p];
+            }
+            for (int i = rows; i < MR; ++i) {
+                out[i] = T(0);
+            }
+            out += MR;
+        }
+    }
+}
+
+// Copy a kc x nc panel of B into NR-column slivers, each stored row by row
+// (NR consecutive elements per k); columns past nc are zero.
+template <typename T>
+void packB(const T* b, size_t ldb, int kc, int nc, T* out) {
+    constexpr int NR = GemmBlocking<T>::NR;
+    for (int j0 = 0; j0 < nc; j0 += NR) {
+        const int cols = st::min(NR, nc - j0);
+        for (int p = 0; p < kc; ++p) {
+            const T* src = b + (size_t)p * ldb + j0;
+            for (int j = 0; j < cols; ++j) {
+                out[j] = src[j];
+            }
+            for (int j = cols; j < NR; ++j) {
+                out[j] = T(0);
+            }
+            out += NR;
+        }
+    }
+}
+
+// One register tile of C from packed slivers through the vector microkernel. Edge tiles are
+// computed into a full-size scratch tile and only their rows x cols part is stored.
+template <typename T>
+void multiplyTile(const SimdKernels<T>& kernels, int kc, const T* ap, const T* bp, T* c, size_t ldc, int rows,
+                  int cols, bool accumulate) {
+    constexpr int MR = GemmBlocking<T>::MR;
+    constexpr int NR = GemmBlocking<T>::NR;
+    if (rows == MR && cols == NR) {
+        kernels.microKernel(kc, ap, bp, c, ldc, accumulate);
+        return;
+    }
+    T tile[MR * NR];
+    kernels.microKernel(kc, ap, bp, tile, NR, false);
+    for (int i = 0; i < rows; ++i) {
+        T* ci = c + (size_t)i * ldc;
+        const T* ti = tile + i * NR;
+        if (accumulate) {
+            for (int j = 0; j < cols; ++j) ci[j] += ti[j];
+        } else {
+            for (int j = 0; j < cols; ++j) ci[j] = ti[j];
+        }
+    }
+}
+
+// Blocked product on the calling thread: for each KC x NC panel of B and MC x KC block of A,
+// both packed once, sweep the register tiles of the matching MC x NC block of C. The first
+// panel along k overwrites C unless accumulating, so C needs no zeroing pass.
+template <typename T>
+void gemmBlocked(int m, int n, int k, const T* a, size_t lda, const T* b, size_t ldb, T* c, size_t ldc,
+                 bool accumulate) {
+    constexpr int MR = GemmBlocking<T>::MR;
+    constexpr int NR = GemmBlocking<T>::NR;
+    constexpr int KC = GemmBlocking<T>::KC;
+    constexpr int MC = GemmBlocking<T>::MC;
+    constexpr int NC = GemmBlocking<T>::NC;
+
+    const int kcMax = st::min(KC, k);
+    const int mcMax = st::min(MC, (m + MR - 1) / MR * MR);
+    const int ncMax = st::min(NC, (n + NR - 1) / NR * NR);
+    PackBuffer<T> packedA((size_t)mcMax * kcMax);
+    PackBuffer<T> packedB((size_t)kcMax * ncMax);
+    const SimdKernels<T>& kernels = simdKernels<T>();
+
+    for (int jc = 0; jc < n; jc += NC) {
+        const int nc = st::min(NC, n - jc);
+        for (int pc = 0; pc < k; pc += KC) {
+            const int kc = st::min(KC, k - pc);
+            const bool add = accumulate || pc > 0;
+            packB(b + (size_t)pc * ldb + jc, ldb, kc, nc, packedB.get());
+            for (int ic = 0; ic < m; ic += MC) {
+                const int mc = st::min(MC, m - ic);
+                packA(a + (size_t)ic * lda + pc, lda, mc, kc, packedA.get());
+                for (int jr = 0; jr < nc; jr += NR) {
+                    const T* bp = packedB.get() + (size_t)jr * kc;
+                    for (int ir = 0; ir < mc; ir += MR) {
+                        const T* ap = packedA.get() + (size_t)ir * kc;
+                        T* cTile = c + (size_t)(ic + ir) * ldc + jc + jr;
+                        multiplyTile(kernels, kc, ap, bp, cTile, ldc, st::min(MR, mc - ir), st::min(NR, nc - jr), add);
+                    }
+                }
+            }
+        }
+    }
+}
+
+}
+
+// Small products run directly; large ones are blocked, and above Parallel::productThreshold()
+// each Parallel worker computes its own contiguous block of rows of C, packing its own copies
+// of the panels. Every element of C goes through the same k-blocking and microkernel whichever
+// thread computes it, so the result does not depend on the thread count.
+template <typename T>
+void gemm(int m, int n, int k, const T* a, size_t lda, const T* b, size_t ldb, T* c, size_t ldc,
+          bool accumulate) {
+    if (m <= 0 || n <= 0) return;
+    const size_t work = (size_t)m * n * k;
+    if (k <= 0 || work <= SMALL_PRODUCT) {
+        gemmDirect(m, n, k, a, lda, b, ldb, c, ldc, accumulate);
+    } else if (work >= Parallel::productThreshold() && Parallel::threads() > 1) {
+        Parallel::forRows(m, [&](int begin, int end) {
+            gemmBlocked(end - begin, n, k, a + (size_t)begin * lda, lda, b, ldb, c + (size_t)begin * ldc, ldc,
+                        accumulate);
+        });
+    } else {
+        gemmBlocked(m, n, k, a, lda, b, ldb, c, ldc, accumulate);
+    }
+}
+
+// Explicit instantiations for the supported element types.
+template void gemm<float>(int, int, int, const float*, size_t, const float*, size_t, float*, size_t, bool);
+template void gemm<double>(int, int, int, const double*, size_t, const double*, size_t, double*, size_t, bool);
+template void gemm<std::int64_t>(int, int, int, const std::int64_t*, size_t, const std::int64_t*, size_t,
+                                 std::int64_t*, size_t, bool);
+template void gemm<std::complex<double>>(int, int, int, const std::complex<double>*, size_t,
+                                         const std::complex<double>*, size_t, std::complex<double>*, size_t, bool);
+
+}
+
+}
@@ -0,0 +1,61 @@
+// adar101101@gmail.com
+
+#pragma once
+#include <cstddef>
+
+/**
+ * @file Gemm.hpp
+ * @brief The blocked, packed matrix product engine behind SquareMat's operator*.
+ */
+
+namespace Matrix {
+
+namespace detail {
+
+/**
+ * @struct GemmBlocking
+ * @brief Register and cache block sizes of the product engine for one element type.
+ *
+ * The product walks C in MR x NR register tiles. For each tile the microkernel streams an
+ * MR x KC sliver of A and a KC x NR sliver of B, which together stay in L1; an MC x KC block of A
+ * is packed once and reused from L2 by every sliver of B, and a KC x NC panel of B is packed once
+ * and reused from L3 by every block of A.
+ */
+template <typename T>
+struct GemmBlocking {
+    static constexpr int MR = 4;                                    ///< Rows of a register tile.
+    static constexpr int NR = 8;                                    ///< Columns of a register tile.
+    static constexpr int KC = (int)(2048 / sizeof(T));              ///< Depth of the packed slivers (16 KiB of B per sliver).
+    static constexpr int MC = 96;                                   ///< Rows of a packed block of A.
+    static constexpr int NC = 2048;                                 ///< Columns of a packed panel of B.
+};
+
+/// Products with at most this many multiply-adds skip packing.
+constexpr size_t SMALL_PRODUCT = size_t(32) * 32 * 32;
+
+/**
+ * @brief Computes C = A * B, or C += A * B, for row-major operands with arbitrary strides.
+ *
+ * Products of at most SMALL_PRODUCT multiply-adds use a direct loop; larger ones are blocked and
+ * packed as described in GemmBlocking, and from Parallel::productThreshold() multiply-adds up
+ * their rows of C are split across the Parallel workers. The result is the same for any thread
+ * count. C must not overlap A or B. When accumulate is false, C is only written, so it may be
+ * uninitialized.
+ * @param m Rows of A and C.
+ * @param n Columns of B and C.
+ * @param k Columns of A and rows of B.
+ * @param a First element of A.
+ * @param lda Distance in elements between rows of A.
+ * @param b First element of B.
+ * @param ldb Distance in elements between rows of B.
+ * @param c First element of C.
+ * @param ldc Distance in elements between rows of C.
+ * @param accumulate Whether to add the product to C instead of overwriting it.
+ */
+template <typename T>
+void gemm(int m, int n, int k, const T* a, size_t lda, const T* b, size_t ldb, T* c, size_t ldc,
+          bool accumulate = false);
+
+}
+
+}
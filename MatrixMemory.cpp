@@ -0,0 +1,533 @@
+// adar101101@gmail.com
+
+#include <new>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <stdexcept>
+#include "MatrixMemory.hpp"
+#if defined(MATRIX_DEBUG_ARENA) && defined(__SANITIZE_ADDRESS__)
+#include <sanitizer/asan_interface.h>
+#define MATRIX_ARENA_ASAN 1
+#endif
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace st = std;
+
+namespace Matrix {
+
+namespace {
+
+constexpr size_t BUFFER_ALIGNMENT = 64;   // Alignment of every buffer handed out here.
+
+// Innermost active arena on this thread.
+thread_local Arena* activeArena = nullptr;
+
+size_t alignUp(size_t value) {
+    return (value + BUFFER_ALIGNMENT - 1) / BUFFER_ALIGNMENT * BUFFER_ALIGNMENT;
+}
+
+#ifdef MATRIX_DEBUG_ARENA
+// Fill released arena memory with 0xFF bytes, and under AddressSanitizer forbid access to it.
+void poisonArena(char* begin, size_t bytes) {
+    if (bytes == 0) return;
+    st::memset(begin, 0xFF, bytes);
+#ifdef MATRIX_ARENA_ASAN
+    ASAN_POISON_MEMORY_REGION(begin, bytes);
+#endif
+}
+#endif
+
+// Allow access to arena memory handed out again (no-op unless poisoning under AddressSanitizer).
+void unpoisonArena(char* begin, size_t bytes) {
+#ifdef MATRIX_ARENA_ASAN
+    ASAN_UNPOISON_MEMORY_REGION(begin, bytes);
+#else
+    (void)begin;
+    (void)bytes;
+#endif
+}
+
+st::atomic<bool> poolEnabled{false};
+st::atomic<size_t> poolLimit{size_t(256) << 20};
+
+// Free lists of one thread, keyed by exact buffer size.
+struct ThreadPool {
+    st::unordered_map<size_t, st::vector<void*>> lists;
+    size_t hits = 0;
+    size_t misses = 0;
+    size_t retainedBytes = 0;
+    size_t retainedBuffers = 0;
+
+    ~ThreadPool();
+    void trim(size_t keep);
+};
+
+// Set once the thread's pool is destroyed, so late frees bypass it.
+thread_local bool poolDestroyed = false;
+
+ThreadPool* threadPool() {
+    if (poolDestroyed) return nullptr;
+    thread_local ThreadPool pool;
+    return &pool;
+}
+
+st::atomic<int> hugeMode{(int)HugePages::Mode::Transparent};
+st::atomic<size_t> hugeThreshold{size_t(32) << 20};
+st::atomic<size_t> explicitBuffers{0};
+st::atomic<size_t> transparentBuffers{0};
+st::atomic<size_t> hugeFallbacks{0};
+st::atomic<size_t> hugeMappedBytes{0};
+
+// Smallest buffer ever mapped, so that frees of smaller buffers skip the lookup.
+st::atomic<size_t> smallestHuge{SIZE_MAX};
+
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+
+// Length of the mapping behind each huge-page buffer, by buffer address.
+st::mutex hugeMutex;
+st::unordered_map<void*, size_t> hugeRegions;
+
+// Map a 2 MiB aligned buffer of at least bytes: from hugetlbfs in Explicit mode when the pool
+// has pages, otherwise anonymous memory trimmed to alignment and marked MADV_HUGEPAGE.
+void* mapHuge(size_t bytes, HugePages::Mode mode) {
+    const size_t length = (bytes + HugePages::HUGE_PAGE - 1) / HugePages::HUGE_PAGE * HugePages::HUGE_PAGE;
+    void* buffer = nullptr;
+#if defined(MAP_HUGETLB)
+    if (mode == HugePages::Mode::Explicit) {
+        void* p = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (p != MAP_FAILED) {
+            buffer = p;
+            explicitBuffers.fetch_add(1, st::memory_order_relaxed);
+        }
+    }
+#endif
+    if (!buffer) {
+        const size_t span = length + HugePages::HUGE_PAGE;
+        void* p = mmap(nullptr, span, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p == MAP_FAILED) return nullptr;
+        char* raw = static_cast<char*>(p);
+        const st::uintptr_t address = reinterpret_cast<st::uintptr_t>(raw);
+        char* aligned = raw + ((HugePages::HUGE_PAGE - address % HugePages::HUGE_PAGE) % HugePages::HUGE_PAGE);
+        const size_t head = aligned - raw;
+        if (head) munmap(raw, head);
+        if (span - head > length) munmap(aligned + length, span - head - length);
+        buffer = aligned;
+        if (madvise(buffer, length, MADV_HUGEPAGE) == 0) {
+            transparentBuffers.fetch_add(1, st::memory_order_relaxed);
+        } else {
+            hugeFallbacks.fetch_add(1, st::memory_order_relaxed);
+        }
+    }
+    try {
+        st::lock_guard<st::mutex> lock(hugeMutex);
+        hugeRegions.emplace(buffer, length);
+    } catch (...) {
+        munmap(buffer, length);
+        return nullptr;
+    }
+    hugeMappedBytes.fetch_add(length, st::memory_order_relaxed);
+    size_t smallest = smallestHuge.load(st::memory_order_relaxed);
+    while (bytes < smallest && !smallestHuge.compare_exchange_weak(smallest, bytes, st::memory_order_relaxed)) {}
+    return buffer;
+}
+
+// Unmap the buffer if mapHuge made it.
+bool unmapHuge(void* buffer) noexcept {
+    size_t length;
+    {
+        st::lock_guard<st::mutex> lock(hugeMutex);
+        auto it = hugeRegions.find(buffer);
+        if (it == hugeRegions.end()) return false;
+        length = it->second;
+        hugeRegions.erase(it);
+    }
+    munmap(buffer, length);
+    hugeMappedBytes.fetch_sub(length, st::memory_order_relaxed);
+    return true;
+}
+
+#else
+
+// No madvise or mmap here: large buffers come from the ordinary heap.
+void* mapHuge(size_t, HugePages::Mode) { return nullptr; }
+
+bool unmapHuge(void*) noexcept { return false; }
+
+#endif
+
+st::atomic<int> numaMode{(int)NumaPlacement::Mode::Local};
+st::atomic<int> numaNode{0};
+st::atomic<size_t> numaThreshold{size_t(1) << 20};
+
+void releaseToHeap(void* buffer, size_t bytes) noexcept {
+    if (bytes >= smallestHuge.load(st::memory_order_relaxed) && unmapHuge(buffer)) return;
+    ::operator delete(buffer, st::align_val_t(BUFFER_ALIGNMENT));
+}
+
+// Free parked buffers until at most keep bytes remain.
+void ThreadPool::trim(size_t keep) {
+    for (auto it = lists.begin(); it != lists.end() && retainedBytes > keep;) {
+        st::vector<void*>& list = it->second;
+        while (!list.empty() && retainedBytes > keep) {
+            releaseToHeap(list.back(), it->first);
+            list.pop_back();
+            retainedBytes -= it->first;
+            --retainedBuffers;
+        }
+        it = list.empty() ? lists.erase(it) : st::next(it);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    trim(0);
+    poolDestroyed = true;
+}
+
+}
+
+// Constructor: start with no blocks; the first allocation reserves one.
+Arena::Arena(size_t blockBytes) : current(0), blockBytes(alignUp(st::max<size_t>(blockBytes, BUFFER_ALIGNMENT))) {}
+
+// Destructor: return every block to the heap.
+Arena::~Arena() {
+    for (Block& block : blocks) {
+        unpoisonArena(block.base, block.capacity);
+        ::operator delete(block.base, st::align_val_t(BUFFER_ALIGNMENT));
+    }
+}
+
+// Bump-allocate an aligned chunk, moving on to (or reserving) a larger block when full.
+void* Arena::allocate(size_t bytes) {
+    bytes = alignUp(st::max<size_t>(bytes, 1));
+    while (current < blocks.size()) {
+        Block& block = blocks[current];
+        if (block.capacity - block.used >= bytes) {
+            char* chunk = block.base + block.used;
+            block.used += bytes;
+            unpoisonArena(chunk, bytes);
+            return chunk;
+        }
+        ++current;
+        if (current < blocks.size()) blocks[current].used = 0;
+    }
+    size_t capacity = st::max(blockBytes, bytes);
+    char* base = static_cast<char*>(::operator new(capacity, st::align_val_t(BUFFER_ALIGNMENT)));
+    blocks.push_back(Block{base, capacity, bytes});
+    current = blocks.size() - 1;
+    return base;
+}
+
+// Allocate a chunk and count it against the innermost scope over this arena, which it follows.
+void* Arena::acquire(size_t bytes) {
+    void* chunk = allocate(bytes);
+    if (!scopes.empty()) ++scopes.back().live;
+    return chunk;
+}
+
+// Uncount a chunk from the innermost scope that began before it, i.e. the one that frees it.
+void Arena::release(const void* chunk) noexcept {
+    const Mark at = position(chunk);
+    for (size_t i = scopes.size(); i-- > 0;) {
+        const Mark& start = scopes[i].start;
+        if (at.block > start.block || (at.block == start.block && at.used >= start.used)) {
+            --scopes[i].live;
+            return;
+        }
+    }
+}
+
+// Block index and offset of a chunk; chunks outside every block map past all marks.
+Arena::Mark Arena::position(const void* chunk) const {
+    const char* p = static_cast<const char*>(chunk);
+    for (size_t i = 0; i < blocks.size(); ++i) {
+        if (p >= blocks[i].base && p < blocks[i].base + blocks[i].capacity) {
+            return Mark{i, (size_t)(p - blocks[i].base)};
+        }
+    }
+    return Mark{blocks.size(), 0};
+}
+
+// Current position in the arena.
+Arena::Mark Arena::mark() const {
+    if (blocks.empty()) return Mark{0, 0};
+    return Mark{current, blocks[current].used};
+}
+
+// Release everything allocated after the mark; later blocks stay reserved for reuse.
+void Arena::rewind(Mark to) {
+    if (blocks.empty()) return;
+#ifdef MATRIX_DEBUG_ARENA
+    for (size_t i = to.block; i < blocks.size(); ++i) {
+        const size_t from = i == to.block ? to.used : 0;
+        if (blocks[i].used > from) poisonArena(blocks[i].base + from, blocks[i].used - from);
+    }
+#endif
+    current = to.block;
+    blocks[current].used = to.used;
+    for (size_t i = current + 1; i < blocks.size(); ++i) blocks[i].used = 0;
+}
+
+// Release every chunk.
+void Arena::reset() {
+    rewind(Mark{0, 0});
+}
+
+// Bytes handed out so far.
+size_t Arena::bytesUsed() const {
+    size_t used = 0;
+    for (const Block& block : blocks) used += block.used;
+    return used;
+}
+
+// Bytes reserved from the heap.
+size_t Arena::bytesReserved() const {
+    size_t reserved = 0;
+    for (const Block& block : blocks) reserved += block.capacity;
+    return reserved;
+}
+
+// Activate the arena for this thread, remembering where to rewind to.
+ArenaScope::ArenaScope(Arena& arena) : arena(arena), previous(activeArena) {
+    arena.scopes.push_back(Arena::Scope{arena.mark(), 0});
+    activeArena = &arena;
+}
+
+// Release the scope's allocations and restore the enclosing scope. A matrix still holding one of
+// them would dangle, so that is fatal rather than silent.
+ArenaScope::~ArenaScope() {
+    const Arena::Scope scope = arena.scopes.back();
+    if (scope.live != 0) {
+        st::fprintf(stderr, "Matrix::ArenaScope ended while %zu matrices still hold buffers from it\n", scope.live);
+        st::abort();
+    }
+    arena.scopes.pop_back();
+    arena.rewind(scope.start);
+    activeArena = previous;
+}
+
+// Innermost active arena on this thread.
+Arena* ArenaScope::current() {
+    return activeArena;
+}
+
+// Turn recycling on or off for all threads.
+void BufferPool::enable(bool on) {
+    poolEnabled.store(on, st::memory_order_relaxed);
+}
+
+// Whether recycling is on.
+bool BufferPool::enabled() {
+    return poolEnabled.load(st::memory_order_relaxed);
+}
+
+// Set the per-thread retention limit.
+void BufferPool::setLimit(size_t bytes) {
+    poolLimit.store(bytes, st::memory_order_relaxed);
+}
+
+// Per-thread retention limit.
+size_t BufferPool::limit() {
+    return poolLimit.load(st::memory_order_relaxed);
+}
+
+// Counters of the calling thread.
+BufferPool::Stats BufferPool::stats() {
+    ThreadPool* pool = threadPool();
+    if (!pool) return Stats{0, 0, 0, 0};
+    return Stats{pool->hits, pool->misses, pool->retainedBytes, pool->retainedBuffers};
+}
+
+// Reset the hit and miss counters of the calling thread.
+void BufferPool::resetStats() {
+    if (ThreadPool* pool = threadPool()) {
+        pool->hits = 0;
+        pool->misses = 0;
+    }
+}
+
+// Free parked buffers of the calling thread down to maxRetainedBytes.
+void BufferPool::trim(size_t maxRetainedBytes) {
+    if (ThreadPool* pool = threadPool()) pool->trim(maxRetainedBytes);
+}
+
+// Select how large buffers are backed.
+void HugePages::setMode(Mode mode) {
+    hugeMode.store((int)mode, st::memory_order_relaxed);
+}
+
+// Current backing mode.
+HugePages::Mode HugePages::mode() {
+    return (Mode)hugeMode.load(st::memory_order_relaxed);
+}
+
+// Set the smallest buffer that gets huge-page backing.
+void HugePages::setThreshold(size_t bytes) {
+    hugeThreshold.store(bytes, st::memory_order_relaxed);
+}
+
+// Smallest buffer that gets huge-page backing.
+size_t HugePages::threshold() {
+    return hugeThreshold.load(st::memory_order_relaxed);
+}
+
+// Process-wide counters.
+HugePages::Stats HugePages::stats() {
+    return Stats{explicitBuffers.load(st::memory_order_relaxed), transparentBuffers.load(st::memory_order_relaxed),
+                 hugeFallbacks.load(st::memory_order_relaxed), hugeMappedBytes.load(st::memory_order_relaxed)};
+}
+
+// Reset the buffer counters.
+void HugePages::resetStats() {
+    explicitBuffers.store(0, st::memory_order_relaxed);
+    transparentBuffers.store(0, st::memory_order_relaxed);
+    hugeFallbacks.store(0, st::memory_order_relaxed);
+}
+
+// AnonHugePages of this process, reported by the kernel in kB.
+size_t HugePages::residentBytes() {
+    st::ifstream rollup("/proc/self/smaps_rollup");
+    st::string key;
+    size_t kilobytes;
+    while (rollup >> key) {
+        if (key == "AnonHugePages:" && rollup >> kilobytes) return kilobytes * 1024;
+        rollup.ignore(st::numeric_limits<st::streamsize>::max(), '\n');
+    }
+    return 0;
+}
+
+// Select the placement of large buffers.
+void NumaPlacement::setMode(Mode mode) {
+    numaMode.store((int)mode, st::memory_order_relaxed);
+}
+
+// Current placement mode.
+NumaPlacement::Mode NumaPlacement::mode() {
+    return (Mode)numaMode.load(st::memory_order_relaxed);
+}
+
+// Set the node for Bind mode.
+void NumaPlacement::setNode(int node) {
+    if (node < 0 || node >= nodeCount()) {
+        throw st::invalid_argument("NUMA node out of range");
+    }
+    numaNode.store(node, st::memory_order_relaxed);
+}
+
+// Node for Bind mode.
+int NumaPlacement::node() {
+    return numaNode.load(st::memory_order_relaxed);
+}
+
+// Set the smallest buffer the placement applies to.
+void NumaPlacement::setThreshold(size_t bytes) {
+    numaThreshold.store(bytes, st::memory_order_relaxed);
+}
+
+// Smallest buffer the placement applies to.
+size_t NumaPlacement::threshold() {
+    return numaThreshold.load(st::memory_order_relaxed);
+}
+
+// Online nodes from sysfs, a list such as "0" or "0-3": the highest number plus one.
+int NumaPlacement::nodeCount() {
+    static const int count = [] {
+        st::ifstream online("/sys/devices/system/node/online");
+        st::string list;
+        if (!(online >> list) || list.empty()) return 1;
+        const size_t last = list.find_last_of(",-");
+        const int highest = st::atoi(list.c_str() + (last == st::string::npos ? 0 : last + 1));
+        return highest >= 0 ? highest + 1 : 1;
+    }();
+    return count;
+}
+
+namespace detail {
+
+// Take a parked buffer of the same size if the pool has one, otherwise allocate.
+void* allocateBuffer(size_t bytes) {
+    if (BufferPool::enabled()) {
+        if (ThreadPool* pool = threadPool()) {
+            auto it = pool->lists.find(bytes);
+            if (it != pool->lists.end() && !it->second.empty()) {
+                void* buffer = it->second.back();
+                it->second.pop_back();
+                pool->retainedBytes -= bytes;
+                --pool->retainedBuffers;
+                ++pool->hits;
+                return buffer;
+            }
+            ++pool->misses;
+        }
+    }
+    const HugePages::Mode mode = HugePages::mode();
+    if (mode != HugePages::Mode::Off && bytes >= HugePages::threshold()) {
+        if (void* buffer = mapHuge(bytes, mode)) return buffer;
+    }
+    return ::operator new(bytes, st::align_val_t(BUFFER_ALIGNMENT));
+}
+
+// Park the buffer while the pool is on and under its limit, otherwise free it.
+void freeBuffer(void* buffer, size_t bytes) noexcept {
+    if (BufferPool::enabled()) {
+        ThreadPool* pool = threadPool();
+        if (pool && pool->retainedBytes + bytes <= BufferPool::limit()) {
+            try {
+                pool->lists[bytes].push_back(buffer);
+                pool->retainedBytes += bytes;
+                ++pool->retainedBuffers;
+                return;
+            } catch (...) {
+                // No room to record the buffer: fall through and free it.
+            }
+        }
+    }
+    releaseToHeap(buffer, bytes);
+}
+
+// mbind the whole pages of the buffer to all nodes (Interleave) or to node() (Bind).
+void placeBuffer(void* buffer, size_t bytes) noexcept {
+#if defined(__linux__) && defined(SYS_mbind)
+    const NumaPlacement::Mode mode = NumaPlacement::mode();
+    if (mode != NumaPlacement::Mode::Interleave && mode != NumaPlacement::Mode::Bind) return;
+    if (bytes < NumaPlacement::threshold()) return;
+    constexpr int MPOL_BIND_POLICY = 2;
+    constexpr int MPOL_INTERLEAVE_POLICY = 3;
+    const long page = sysconf(_SC_PAGESIZE);
+    if (page <= 0) return;
+    const st::uintptr_t begin = (reinterpret_cast<st::uintptr_t>(buffer) + page - 1) / page * page;
+    const st::uintptr_t end = (reinterpret_cast<st::uintptr_t>(buffer) + bytes) / page * page;
+    if (end <= begin) return;
+    constexpr int MASK_BITS = 1024;
+    unsigned long mask[MASK_BITS / (8 * sizeof(unsigned long))] = {};
+    const int bitsPerWord = 8 * sizeof(unsigned long);
+    if (mode == NumaPlacement::Mode::Bind) {
+        const int node = NumaPlacement::node();
+        mask[node / bitsPerWord] |= 1ul << (node % bitsPerWord);
+    } else {
+        const int count = st::min(NumaPlacement::nodeCount(), MASK_BITS);
+        for (int node = 0; node < count; ++node) mask[node / bitsPerWord] |= 1ul << (node % bitsPerWord);
+    }
+    const int policy = mode == NumaPlacement::Mode::Bind ? MPOL_BIND_POLICY : MPOL_INTERLEAVE_POLICY;
+    syscall(SYS_mbind, begin, end - begin, policy, mask, (unsigned long)MASK_BITS + 1, 0u);
+#else
+    (void)buffer;
+    (void)bytes;
+#endif
+}
+
+}
+
+}
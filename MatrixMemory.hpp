@@ -0,0 +1,419 @@
+// adar101101@gmail.com
+
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+/**
+ * @file MatrixMemory.hpp
+ * @brief Memory sources for matrix buffers: the aligned heap (optionally through a recycling pool)
+ *        and scoped arenas.
+ */
+
+namespace Matrix {
+
+/**
+ * @class Arena
+ * @brief Bump allocator that hands out 64-byte aligned chunks from large blocks.
+ *
+ * Individual chunks are never freed; memory is reclaimed all at once when an ArenaScope
+ * over the arena ends (or reset() is called). Blocks are kept for reuse, so a loop that
+ * opens one scope per iteration stops allocating after the first iteration.
+ * An arena must only be used from one thread at a time.
+ */
+class Arena {
+public:
+    /// Position in the arena, used to rewind to an earlier state.
+    struct Mark {
+        size_t block;
+        size_t used;
+    };
+
+    /**
+     * @brief Creates an empty arena.
+     * @param blockBytes Minimum size of each block requested from the heap.
+     */
+    explicit Arena(size_t blockBytes = 1 << 20);
+
+    /**
+     * @brief Destructor. Returns every block to the heap.
+     */
+    ~Arena();
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    /**
+     * @brief Allocates a 64-byte aligned chunk.
+     * @param bytes Size of the chunk.
+     * @return Pointer to the chunk, valid until the arena is rewound past it.
+     */
+    void* allocate(size_t bytes);
+
+    /**
+     * @brief Allocates a chunk for an owner that hands it back through release(), counting it as
+     *        live in the innermost ArenaScope over this arena until then.
+     * @param bytes Size of the chunk.
+     * @return Pointer to the chunk.
+     */
+    void* acquire(size_t bytes);
+
+    /**
+     * @brief Marks a chunk from acquire() as no longer used by its owner. The memory itself is
+     *        only reclaimed when the scope it was allocated in ends.
+     * @param chunk Pointer returned by acquire().
+     */
+    void release(const void* chunk) noexcept;
+
+    /**
+     * @brief Returns the current position, to be passed to rewind() later.
+     * @return Current mark.
+     */
+    Mark mark() const;
+
+    /**
+     * @brief Releases every chunk allocated since the mark was taken (poisoning them under
+     *        MATRIX_DEBUG_ARENA).
+     * @param to Mark returned by an earlier call to mark().
+     */
+    void rewind(Mark to);
+
+    /**
+     * @brief Releases every chunk; the blocks are kept for reuse.
+     */
+    void reset();
+
+    /**
+     * @brief Returns the number of bytes currently handed out.
+     * @return Bytes in use.
+     */
+    size_t bytesUsed() const;
+
+    /**
+     * @brief Returns the number of bytes held in blocks.
+     * @return Bytes reserved from the heap.
+     */
+    size_t bytesReserved() const;
+
+private:
+    struct Block {
+        char* base;
+        size_t capacity;
+        size_t used;
+    };
+
+    /// An active ArenaScope over this arena: where it began and how many acquired chunks it holds.
+    struct Scope {
+        Mark start;
+        size_t live;
+    };
+
+    std::vector<Block> blocks;
+    std::vector<Scope> scopes;   ///< Active scopes over this arena, innermost last.
+    size_t current;       ///< Index of the block being bumped.
+    size_t blockBytes;
+
+    /**
+     * @brief Returns the position of a chunk, comparable with marks.
+     */
+    Mark position(const void* chunk) const;
+
+    friend class ArenaScope;
+};
+
+/**
+ * @class ArenaScope
+ * @brief RAII guard that makes an arena the source of matrix buffers on this thread.
+ *
+ * While the scope is alive, every SquareMat too large for inline storage that is constructed
+ * on this thread (including the temporaries of +, -, *, %, / and ~) takes its buffer from the
+ * arena. When the scope ends, all of those buffers are released at once, so every matrix holding
+ * one must already be gone: the scope counts the arena buffers still held by matrices, and ending
+ * it while any remain prints a message and calls std::abort(), in every build. That catches
+ * matrices that escape through move construction, such as `vec.push_back(a + b)` into a vector
+ * declared outside the scope, or `return a + b;` from a function that opens its own scope. To keep
+ * a result, declare the matrix before the scope and assign to it inside: assigning an
+ * arena-backed matrix to one that is not copies the elements.
+ * Scopes nest; the innermost one is active.
+ *
+ * Building MatrixMemory.cpp with MATRIX_DEBUG_ARENA defined also fills rewound memory with 0xFF
+ * bytes (NaN for floating-point elements, -1 for integers) and, under AddressSanitizer, poisons
+ * it, which catches stale pointers into chunks handed out by Arena::allocate() directly.
+ */
+class ArenaScope {
+public:
+    /**
+     * @brief Activates the arena for this thread.
+     * @param arena Arena to draw matrix buffers from.
+     */
+    explicit ArenaScope(Arena& arena);
+
+    /**
+     * @brief Rewinds the arena to where it was when the scope began and restores the previous scope.
+     *
+     * Aborts the program if a matrix still holds a buffer allocated in this scope.
+     */
+    ~ArenaScope();
+
+    ArenaScope(const ArenaScope&) = delete;
+    ArenaScope& operator=(const ArenaScope&) = delete;
+
+    /**
+     * @brief Returns the arena of the innermost active scope on this thread.
+     * @return Active arena, or nullptr if no scope is active.
+     */
+    static Arena* current();
+
+private:
+    Arena& arena;
+    Arena* previous;
+};
+
+/**
+ * @class BufferPool
+ * @brief Optional recycling of freed heap matrix buffers in per-thread free lists.
+ *
+ * When enabled, a freed buffer is kept in the calling thread's free list for its exact byte size
+ * (i.e. per dimension and element type) and handed to the next matrix of that size built on the
+ * same thread, instead of going back to the allocator. Each thread retains at most limit() bytes;
+ * anything beyond that is freed normally. Lists are released when their thread exits.
+ */
+class BufferPool {
+public:
+    /// Counters for the calling thread's pool.
+    struct Stats {
+        size_t hits;              ///< Allocations served from a free list.
+        size_t misses;            ///< Allocations that went to the allocator while enabled.
+        size_t retainedBytes;     ///< Bytes currently parked in free lists.
+        size_t retainedBuffers;   ///< Buffers currently parked in free lists.
+    };
+
+    /**
+     * @brief Turns recycling on or off for all threads (off by default).
+     * @param on Whether freed buffers should be kept for reuse.
+     */
+    static void enable(bool on);
+
+    /**
+     * @brief Returns whether recycling is on.
+     * @return True if enabled.
+     */
+    static bool enabled();
+
+    /**
+     * @brief Sets the most bytes each thread may keep in its free lists.
+     * @param bytes Per-thread retention limit.
+     */
+    static void setLimit(size_t bytes);
+
+    /**
+     * @brief Returns the per-thread retention limit.
+     * @return Limit in bytes.
+     */
+    static size_t limit();
+
+    /**
+     * @brief Returns the counters of the calling thread.
+     * @return Hits, misses and retained memory.
+     */
+    static Stats stats();
+
+    /**
+     * @brief Resets the hit and miss counters of the calling thread.
+     */
+    static void resetStats();
+
+    /**
+     * @brief Frees parked buffers of the calling thread until at most maxRetainedBytes remain.
+     * @param maxRetainedBytes Bytes to keep (0 empties the lists).
+     */
+    static void trim(size_t maxRetainedBytes = 0);
+};
+
+/**
+ * @class HugePages
+ * @brief Huge-page backing for large heap matrix buffers, to cut TLB misses.
+ *
+ * Heap buffers of at least threshold() bytes are mapped directly, 2 MiB aligned. In Transparent
+ * mode the mapping is marked with madvise(MADV_HUGEPAGE); in Explicit mode it first asks for
+ * pages from the hugetlbfs pool (MAP_HUGETLB) and falls back to transparent huge pages when the
+ * pool is empty or absent. Smaller buffers, arena buffers and non-Linux builds are unaffected.
+ * Settings apply to all threads and only to buffers allocated after the change.
+ */
+class HugePages {
+public:
+    /// How large buffers are backed.
+    enum class Mode {
+        Off,           ///< Ordinary 64-byte aligned heap allocation.
+        Transparent,   ///< 2 MiB aligned mapping with madvise(MADV_HUGEPAGE).
+        Explicit       ///< hugetlbfs pages, falling back to Transparent.
+    };
+
+    /// Process-wide counters.
+    struct Stats {
+        size_t explicitBuffers;      ///< Buffers backed by hugetlbfs pages.
+        size_t transparentBuffers;   ///< Buffers the kernel accepted MADV_HUGEPAGE for.
+        size_t fallbacks;            ///< Large buffers that got neither and use normal pages.
+        size_t mappedBytes;          ///< Bytes currently mapped for large buffers.
+    };
+
+    /// Size of a huge page on x86-64 and the default on AArch64.
+    static constexpr size_t HUGE_PAGE = size_t(2) << 20;
+
+    /**
+     * @brief Selects how large buffers are backed (Transparent by default).
+     * @param mode New mode.
+     */
+    static void setMode(Mode mode);
+
+    /**
+     * @brief Returns the current mode.
+     * @return Mode.
+     */
+    static Mode mode();
+
+    /**
+     * @brief Sets the smallest buffer, in bytes, that gets huge-page backing (32 MiB by default).
+     * @param bytes Threshold.
+     */
+    static void setThreshold(size_t bytes);
+
+    /**
+     * @brief Returns the threshold.
+     * @return Threshold in bytes.
+     */
+    static size_t threshold();
+
+    /**
+     * @brief Returns the process-wide counters.
+     * @return Buffers by backing and mapped bytes.
+     */
+    static Stats stats();
+
+    /**
+     * @brief Resets the buffer counters; mappedBytes is kept.
+     */
+    static void resetStats();
+
+    /**
+     * @brief Returns the bytes of anonymous memory the kernel actually backs with transparent
+     *        huge pages in this process (AnonHugePages in /proc/self/smaps_rollup).
+     *
+     * MADV_HUGEPAGE is only a hint, so this is how to check that it was honoured.
+     * @return Bytes, or 0 if the information is unavailable.
+     */
+    static size_t residentBytes();
+};
+
+/**
+ * @class NumaPlacement
+ * @brief Where the pages of large heap matrix buffers are placed on multi-socket machines.
+ *
+ * By default Linux puts each page on the node of the thread that first writes it, which for a
+ * matrix zeroed by its constructor is the constructing thread. For buffers of at least
+ * threshold() bytes, FirstTouch instead zeroes (or, when the elements are about to be
+ * overwritten, touches) each row block from the Parallel worker that owns that block, so
+ * row-parallel kernels find their rows on their own node; the Parallel workers are pinned to CPUs
+ * in this mode, but block 0 belongs to the unpinned calling thread, so its placement holds only
+ * as long as the scheduler keeps that thread on its node. Interleave and Bind apply an explicit
+ * memory policy to the buffer before it is touched. Policies only place pages that have not
+ * been touched yet, so recycled BufferPool buffers keep their placement. Copies made when a
+ * copy-on-write buffer is detached, or when release() copies arena elements out, are placed like
+ * new buffers. Settings apply to all threads; on non-Linux builds Interleave and Bind behave like
+ * Local, and workers are not pinned.
+ */
+class NumaPlacement {
+public:
+    /// Page placement for large buffers.
+    enum class Mode {
+        Local,        ///< Pages land on the node of the constructing thread.
+        FirstTouch,   ///< Each row block is first touched by the worker that later processes it.
+        Interleave,   ///< Pages are spread round-robin over all nodes.
+        Bind          ///< Pages are allocated on node() only.
+    };
+
+    /**
+     * @brief Selects the placement of large buffers (Local by default).
+     * @param mode New mode.
+     */
+    static void setMode(Mode mode);
+
+    /**
+     * @brief Returns the current mode.
+     * @return Mode.
+     */
+    static Mode mode();
+
+    /**
+     * @brief Sets the node used in Bind mode.
+     * @param node NUMA node number.
+     * @throws std::invalid_argument if node is negative or not below nodeCount().
+     */
+    static void setNode(int node);
+
+    /**
+     * @brief Returns the node used in Bind mode.
+     * @return NUMA node number.
+     */
+    static int node();
+
+    /**
+     * @brief Sets the smallest buffer, in bytes, that the placement applies to (1 MiB by default).
+     * @param bytes Threshold.
+     */
+    static void setThreshold(size_t bytes);
+
+    /**
+     * @brief Returns the threshold.
+     * @return Threshold in bytes.
+     */
+    static size_t threshold();
+
+    /**
+     * @brief Returns the number of NUMA nodes the kernel reports as online.
+     * @return Node count, 1 if unknown.
+     */
+    static int nodeCount();
+};
+
+namespace detail {
+
+/**
+ * @struct SharedBuffer
+ * @brief Control block of a buffer shared copy-on-write by several matrices, or supplied by the caller.
+ */
+struct SharedBuffer {
+    std::atomic<int> owners{1};             ///< Matrices currently referring to the buffer.
+    bool copyOnWrite = true;                ///< Whether copies share the buffer instead of copying it.
+    std::function<void(void*)> deleter;     ///< Frees an external buffer; empty for buffers from allocateBuffer.
+};
+
+/**
+ * @brief Allocates a 64-byte aligned heap buffer, from the calling thread's pool when possible.
+ * @param bytes Size of the buffer.
+ * @return Pointer to the buffer.
+ */
+void* allocateBuffer(size_t bytes);
+
+/**
+ * @brief Returns a buffer from allocateBuffer, to the pool when enabled.
+ * @param buffer Pointer returned by allocateBuffer.
+ * @param bytes Size passed to allocateBuffer.
+ */
+void freeBuffer(void* buffer, size_t bytes) noexcept;
+
+/**
+ * @brief Applies the Interleave or Bind policy of NumaPlacement to a buffer not yet touched.
+ *
+ * Only whole pages inside the buffer are affected. Does nothing in the other modes, below the
+ * threshold, or when the kernel rejects the policy.
+ * @param buffer Start of the buffer.
+ * @param bytes Size of the buffer.
+ */
+void placeBuffer(void* buffer, size_t bytes) noexcept;
+
+}
+
+}
@@ -0,0 +1,385 @@
+// adar101101@gmail.com
+
+#pragma once
+#include <cstddef>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+/**
+ * @file MatrixView.hpp
+ * @brief Non-owning views of square blocks inside a matrix buffer.
+ */
+
+namespace Matrix {
+
+template <typename T> class BasicSquareMat;
+
+/**
+ * @class BasicConstMatrixView
+ * @brief Read-only, non-owning reference to a size x size block of a row-major buffer.
+ *
+ * A view is just a pointer, a size and a row stride, so taking blocks, minors and tiles is
+ * free. The arithmetic operators accept views (and matrices, which convert implicitly) and
+ * return a new BasicSquareMat. A view must not outlive the matrix it refers to.
+ * @tparam T Element type.
+ */
+template <typename T>
+class BasicConstMatrixView {
+protected:
+    const T* data;   ///< Element (0, 0) of the block.
+    int n;           ///< Number of rows and columns.
+    int stride;      ///< Distance in elements between the starts of two rows.
+
+public:
+    /**
+     * @brief Creates a view over an existing buffer.
+     * @param data Pointer to element (0, 0).
+     * @param size Number of rows and columns.
+     * @param stride Distance in elements between rows (must be >= size).
+     * @throws std::invalid_argument if size <= 0 or stride < size.
+     */
+    BasicConstMatrixView(const T* data, int size, int stride) : data(data), n(size), stride(stride) {
+        if (size <= 0) throw std::invalid_argument("Matrix dimensions must be positive");
+        if (stride < size) throw std::invalid_argument("Stride must be at least the number of columns");
+    }
+
+    /**
+     * @brief Returns the number of rows.
+     * @return Number of rows.
+     */
+    int getRows() const { return n; }
+
+    /**
+     * @brief Returns the number of columns.
+     * @return Number of columns.
+     */
+    int getCols() const { return n; }
+
+    /**
+     * @brief Returns the row stride in elements.
+     * @return Row stride.
+     */
+    int getStride() const { return stride; }
+
+    /**
+     * @brief Returns a pointer to element (0, 0).
+     * @return Start of the block.
+     */
+    const T* getData() const { return data; }
+
+    /**
+     * @brief Return view row, given row index.
+     * @param row Index of wanted row.
+     * @return Pointer to the wanted row.
+     */
+    const T* operator[](size_t row) const {
+        if (row >= (size_t)n) throw std::out_of_range("Row index out of range");
+        return data + row * stride;
+    }
+
+    /**
+     * @brief Accesses the element at (row, col).
+     * @param row Rows number.
+     * @param col Columns number.
+     * @return Const reference to the element.
+     */
+    const T& operator()(int row, int col) const {
+        if (row < 0 || row >= n || col < 0 || col >= n) {
+            throw std::out_of_range("Index out of range of matrix");
+        }
+        return data[(size_t)row * stride + col];
+    }
+
+    /**
+     * @brief Returns a view of a square sub-block.
+     * @param row First row of the block.
+     * @param col First column of the block.
+     * @param size Number of rows and columns of the block.
+     * @return View of the block.
+     * @throws std::out_of_range if the block does not fit inside this view.
+     */
+    BasicConstMatrixView block(int row, int col, int size) const {
+        checkBlock(row, col, size);
+        return BasicConstMatrixView(data + (size_t)row * stride + col, size, stride);
+    }
+
+    /**
+     * @brief Returns the sum of all elements in the view.
+     * @return Sum of elements.
+     */
+    T countSum() const {
+        T sum = T(0);
+        for (int i = 0; i < n; ++i) {
+            const T* row = data + (size_t)i * stride;
+            for (int j = 0; j < n; ++j) sum += row[j];
+        }
+        return sum;
+    }
+
+    //
+    // Friend Non-member Operators (results are new matrices)
+    // A matrix passed as an operand converts to a view, and that conversion throws
+    // std::invalid_argument for a matrix without elements (e.g. one that was moved from).
+    //
+
+    /**
+     * @brief Adds two views (element-wise).
+     * @param left Left operand.
+     * @param right Right operand.
+     * @return New matrix containing the sum.
+     * @throws std::invalid_argument if the sizes differ or an operand matrix is empty.
+     */
+    friend BasicSquareMat<T> operator+(const BasicConstMatrixView& left, const BasicConstMatrixView& right) {
+        return Kernels::add(left, right);
+    }
+
+    /**
+     * @brief Subtracts one view from another (element-wise).
+     * @param left Left operand.
+     * @param right Right operand.
+     * @return New matrix containing the difference.
+     * @throws std::invalid_argument if the sizes differ or an operand matrix is empty.
+     */
+    friend BasicSquareMat<T> operator-(const BasicConstMatrixView& left, const BasicConstMatrixView& right) {
+        return Kernels::subtract(left, right);
+    }
+
+    /**
+     * @brief Multiplies two views (matrix product).
+     * @param left Left operand.
+     * @param right Right operand.
+     * @return New matrix containing the product.
+     * @throws std::invalid_argument if the sizes differ or an operand matrix is empty.
+     */
+    friend BasicSquareMat<T> operator*(const BasicConstMatrixView& left, const BasicConstMatrixView& right) {
+        return Kernels::multiply(left, right);
+    }
+
+    /**
+     * @brief Multiplies each element by a scalar.
+     * @param mat View operand.
+     * @param scalar Scalar operand.
+     * @return New matrix with elements scaled.
+     * @throws std::invalid_argument if mat is an empty matrix.
+     */
+    friend BasicSquareMat<T> operator*(const BasicConstMatrixView& mat, T scalar) {
+        return Kernels::scale(mat, scalar);
+    }
+
+    /**
+     * @brief Multiplies each element by a scalar (scalar on left).
+     * @param scalar Scalar operand.
+     * @param mat View operand.
+     * @return New matrix with elements scaled.
+     * @throws std::invalid_argument if mat is an empty matrix.
+     */
+    friend BasicSquareMat<T> operator*(T scalar, const BasicConstMatrixView& mat) {
+        return Kernels::scale(mat, scalar);
+    }
+
+    /**
+     * @brief Divides each element by a scalar.
+     * @param mat View operand.
+     * @param scalar Scalar divisor.
+     * @return New matrix with elements divided.
+     * @throws std::invalid_argument if scalar == 0 or mat is an empty matrix.
+     */
+    friend BasicSquareMat<T> operator/(const BasicConstMatrixView& mat, T scalar) {
+        return Kernels::divide(mat, scalar);
+    }
+
+    /**
+     * @brief Element-wise multiplication (Hadamard product).
+     * @param left Left operand.
+     * @param right Right operand.
+     * @return New matrix with element-wise products.
+     * @throws std::invalid_argument if the sizes differ or an operand matrix is empty.
+     */
+    friend BasicSquareMat<T> operator%(const BasicConstMatrixView& left, const BasicConstMatrixView& right) {
+        return Kernels::hadamard(left, right);
+    }
+
+    /**
+     * @brief Element-wise modulo operation with a scalar (fmod for floating point, % for integers).
+     * @param mat View operand.
+     * @param scalar Scalar operand.
+     * @return New matrix with elements modulo scalar.
+     * @throws std::invalid_argument if scalar == 0, the elements are complex, or mat is an empty matrix.
+     */
+    friend BasicSquareMat<T> operator%(const BasicConstMatrixView& mat, int scalar) {
+        return Kernels::modulo(mat, scalar);
+    }
+
+    /**
+     * @brief Returns the transpose of the view.
+     * @param mat View to transpose.
+     * @return New matrix containing the transpose.
+     * @throws std::invalid_argument if mat is an empty matrix.
+     */
+    friend BasicSquareMat<T> operator~(const BasicConstMatrixView& mat) {
+        return Kernels::transpose(mat);
+    }
+
+protected:
+    /**
+     * @brief Throws std::out_of_range unless the block lies inside this view.
+     */
+    void checkBlock(int row, int col, int size) const {
+        if (size <= 0 || row < 0 || col < 0 || row > n - size || col > n - size) {
+            throw std::out_of_range("Block out of range of matrix");
+        }
+    }
+
+private:
+    // The operators above are not members, so they cannot use BasicSquareMat's private kernels
+    // directly; this class is a friend of BasicSquareMat and forwards to them.
+    struct Kernels {
+        using Mat = BasicSquareMat<T>;
+        using View = BasicConstMatrixView;
+        static Mat add(const View& l, const View& r) { return Mat::add(l, r); }
+        static Mat subtract(const View& l, const View& r) { return Mat::subtract(l, r); }
+        static Mat multiply(const View& l, const View& r) { return Mat::multiply(l, r); }
+        static Mat scale(const View& m, T s) { return Mat::scale(m, s); }
+        static Mat divide(const View& m, T s) { return Mat::divide(m, s); }
+        static Mat hadamard(const View& l, const View& r) { return Mat::hadamard(l, r); }
+        static Mat modulo(const View& m, int s) { return Mat::modulo(m, s); }
+        static Mat transpose(const View& m) { return Mat::transpose(m); }
+    };
+};
+
+/**
+ * @class BasicMatrixView
+ * @brief Writable, non-owning reference to a size x size block of a row-major buffer.
+ *
+ * Adds in-place updates of the referenced elements to BasicConstMatrixView. Constness of the
+ * view object does not propagate to the elements, like a pointer.
+ * @tparam T Element type.
+ */
+template <typename T>
+class BasicMatrixView : public BasicConstMatrixView<T> {
+public:
+    /**
+     * @brief Creates a writable view over an existing buffer.
+     * @param data Pointer to element (0, 0).
+     * @param size Number of rows and columns.
+     * @param stride Distance in elements between rows (must be >= size).
+     * @throws std::invalid_argument if size <= 0 or stride < size.
+     */
+    BasicMatrixView(T* data, int size, int stride) : BasicConstMatrixView<T>(data, size, stride) {}
+
+    /**
+     * @brief Returns a pointer to element (0, 0).
+     * @return Start of the block.
+     */
+    T* getData() const { return const_cast<T*>(this->data); }
+
+    /**
+     * @brief Return view row, given row index.
+     * @param row Index of wanted row.
+     * @return Pointer to the wanted row.
+     */
+    T* operator[](size_t row) const {
+        return const_cast<T*>(BasicConstMatrixView<T>::operator[](row));
+    }
+
+    /**
+     * @brief Accesses/modifies the element at (row, col).
+     * @param row Rows number.
+     * @param col Columns number.
+     * @return Reference to the element.
+     */
+    T& operator()(int row, int col) const {
+        return const_cast<T&>(BasicConstMatrixView<T>::operator()(row, col));
+    }
+
+    /**
+     * @brief Returns a writable view of a square sub-block.
+     * @param row First row of the block.
+     * @param col First column of the block.
+     * @param size Number of rows and columns of the block.
+     * @return View of the block.
+     * @throws std::out_of_range if the block does not fit inside this view.
+     */
+    BasicMatrixView block(int row, int col, int size) const {
+        this->checkBlock(row, col, size);
+        return BasicMatrixView(getData() + (size_t)row * this->stride + col, size, this->stride);
+    }
+
+    /**
+     * @brief Sets all referenced elements to the specified value.
+     * @param value Value to assign.
+     */
+    void fill(T value) const {
+        for (int i = 0; i < this->n; ++i) {
+            T* row = (*this)[i];
+            for (int j = 0; j < this->n; ++j) row[j] = value;
+        }
+    }
+
+    /**
+     * @brief Copies the elements of another view of the same size into this block.
+     * @param other Source view (may be a matrix).
+     * @return Reference to this view.
+     * @throws std::invalid_argument if the sizes differ or other is an empty matrix.
+     */
+    const BasicMatrixView& assign(const BasicConstMatrixView<T>& other) const {
+        return update(other, "assignment", [](T&, T b) { return b; });
+    }
+
+    /**
+     * @brief In-place addition of another block of the same size.
+     * @param other View to add (may be a matrix).
+     * @return Reference to this view.
+     * @throws std::invalid_argument if the sizes differ or other is an empty matrix.
+     */
+    const BasicMatrixView& operator+=(const BasicConstMatrixView<T>& other) const {
+        return update(other, "addition", [](T& a, T b) { return a + b; });
+    }
+
+    /**
+     * @brief In-place subtraction of another block of the same size.
+     * @param other View to subtract (may be a matrix).
+     * @return Reference to this view.
+     * @throws std::invalid_argument if the sizes differ or other is an empty matrix.
+     */
+    const BasicMatrixView& operator-=(const BasicConstMatrixView<T>& other) const {
+        return update(other, "subtraction", [](T& a, T b) { return a - b; });
+    }
+
+    /**
+     * @brief In-place scalar multiplication of the referenced elements.
+     * @param scalar Scalar multiplier.
+     * @return Reference to this view.
+     */
+    const BasicMatrixView& operator*=(T scalar) const {
+        for (int i = 0; i < this->n; ++i) {
+            T* row = (*this)[i];
+            for (int j = 0; j < this->n; ++j) row[j] *= scalar;
+        }
+        return *this;
+    }
+
+private:
+    // Apply a(i, j) = f(a(i, j), b(i, j)) over the block; other may overlap only if identical.
+    template <typename F>
+    const BasicMatrixView& update(const BasicConstMatrixView<T>& other, const char* what, F f) const {
+        if (other.getRows() != this->n) {
+            throw std::invalid_argument(std::string("Matrices must have the same dimensions for ") + what);
+        }
+        for (int i = 0; i < this->n; ++i) {
+            T* row = (*this)[i];
+            const T* src = other[i];
+            for (int j = 0; j < this->n; ++j) row[j] = f(row[j], src[j]);
+        }
+        return *this;
+    }
+};
+
+/// Read-only view of a block of a SquareMat.
+using ConstMatrixView = BasicConstMatrixView<double>;
+
+/// Writable view of a block of a SquareMat.
+using MatrixView = BasicMatrixView<double>;
+
+}
@@ -0,0 +1,255 @@
+// adar101101@gmail.com
+
+#include <stdexcept>
+#include <algorithm>
+#include <string>
+#include <complex>
+#include <cstdint>
+#include "MortonMat.hpp"
+
+namespace st = std;
+
+namespace Matrix {
+
+namespace {
+
+// Throw if two operands differ in size; what names the operation for the message.
+void requireSameSize(int left, int right, const char* what) {
+    if (left != right) {
+        throw st::invalid_argument(st::string("Matrices must have the same dimensions for ") + what);
+    }
+}
+
+// Spread the bits of x apart so that bit b lands on bit 2b.
+st::uint64_t spreadBits(st::uint32_t x) {
+    st::uint64_t v = x;
+    v = (v | (v << 16)) & 0x0000FFFF0000FFFFull;
+    v = (v | (v << 8)) & 0x00FF00FF00FF00FFull;
+    v = (v | (v << 4)) & 0x0F0F0F0F0F0F0F0Full;
+    v = (v | (v << 2)) & 0x3333333333333333ull;
+    v = (v | (v << 1)) & 0x5555555555555555ull;
+    return v;
+}
+
+// C += A * B for s x s blocks in Z-order. The eight half-size products reuse each quadrant
+// while it is hot in whichever cache level it fits; leaves use a row-major i-k-j kernel.
+// rows, inner and cols are how much of C's rows, A's columns and C's columns lie inside the
+// logical matrix: the rest is zero padding, so products touching only padding are skipped.
+template <typename T>
+void multiplyBlock(T* c, const T* a, const T* b, int s, int leaf, int rows, int inner, int cols) {
+    if (rows <= 0 || inner <= 0 || cols <= 0) return;
+    if (s == leaf) {
+        const int m = st::min(rows, s), kk = st::min(inner, s), nn = st::min(cols, s);
+        for (int i = 0; i < m; ++i) {
+            T* ci = c + (size_t)i * s;
+            const T* ai = a + (size_t)i * s;
+            for (int k = 0; k < kk; ++k) {
+                const T aik = ai[k];
+                const T* bk = b + (size_t)k * s;
+                for (int j = 0; j < nn; ++j) {
+                    ci[j] += aik * bk[j];
+                }
+            }
+        }
+        return;
+    }
+    const int h = s / 2;
+    const size_t q = (size_t)h * h;
+    const int r0 = st::min(rows, h), r1 = rows - h;
+    const int k0 = st::min(inner, h), k1 = inner - h;
+    const int c0 = st::min(cols, h), c1 = cols - h;
+    multiplyBlock(c, a, b, h, leaf, r0, k0, c0);
+    multiplyBlock(c, a + q, b + 2 * q, h, leaf, r0, k1, c0);
+    multiplyBlock(c + q, a, b + q, h, leaf, r0, k0, c1);
+    multiplyBlock(c + q, a + q, b + 3 * q, h, leaf, r0, k1, c1);
+    multiplyBlock(c + 2 * q, a + 2 * q, b, h, leaf, r1, k0, c0);
+    multiplyBlock(c + 2 * q, a + 3 * q, b + 2 * q, h, leaf, r1, k1, c0);
+    multiplyBlock(c + 3 * q, a + 2 * q, b + q, h, leaf, r1, k0, c1);
+    multiplyBlock(c + 3 * q, a + 3 * q, b + 3 * q, h, leaf, r1, k1, c1);
+}
+
+// dst = transpose(src) for s x s blocks in Z-order: the diagonal quadrants transpose in place,
+// the off-diagonal ones swap. rows and cols are how much of src lies inside the logical
+// matrix; padding quadrants are left as the zeros dst already holds.
+template <typename T>
+void transposeBlock(T* dst, const T* src, int s, int leaf, int rows, int cols) {
+    if (rows <= 0 || cols <= 0) return;
+    if (s == leaf) {
+        const int m = st::min(rows, s), nn = st::min(cols, s);
+        for (int i = 0; i < m; ++i) {
+            for (int j = 0; j < nn; ++j) {
+                dst[(size_t)j * s + i] = src[(size_t)i * s + j];
+            }
+        }
+        return;
+    }
+    const int h = s / 2;
+    const size_t q = (size_t)h * h;
+    const int r0 = st::min(rows, h), r1 = rows - h;
+    const int c0 = st::min(cols, h), c1 = cols - h;
+    transposeBlock(dst, src, h, leaf, r0, c0);
+    transposeBlock(dst + q, src + 2 * q, h, leaf, r1, c0);
+    transposeBlock(dst + 2 * q, src + q, h, leaf, r0, c1);
+    transposeBlock(dst + 3 * q, src + 3 * q, h, leaf, r1, c1);
+}
+
+}
+
+// Constructor: all-zero matrix padded to a power-of-two side.
+template <typename T>
+BasicMortonMat<T>::BasicMortonMat(int size) {
+    if (size <= 0) {
+        throw st::invalid_argument("Matrix dimensions must be positive");
+    }
+    n = size;
+    side = 1;
+    while (side < size) side *= 2;
+    leaf = st::min(LEAF, side);
+    data.assign((size_t)side * side, T(0));
+}
+
+// Dense constructor: copy each leaf-wide row segment into its leaf.
+template <typename T>
+BasicMortonMat<T>::BasicMortonMat(const BasicConstMatrixView<T>& dense) : BasicMortonMat(dense.getRows()) {
+    for (int i = 0; i < n; ++i) {
+        const T* src = dense[i];
+        for (int col = 0; col < n; col += leaf) {
+            T* out = data.data() + leafOffset(i, col) + (size_t)(i % leaf) * leaf;
+            st::copy(src + col, src + st::min(n, col + leaf), out);
+        }
+    }
+}
+
+// Position of the first element of the leaf holding (row, col): the leaf coordinates
+// interleaved, row bits above column bits, times the leaf size.
+template <typename T>
+size_t BasicMortonMat<T>::leafOffset(int r, int c) const {
+    const st::uint64_t z = (spreadBits((st::uint32_t)(r / leaf)) << 1) | spreadBits((st::uint32_t)(c / leaf));
+    return (size_t)z * leaf * leaf;
+}
+
+// Position of element (row, col): its leaf, then row-major inside the leaf.
+template <typename T>
+size_t BasicMortonMat<T>::offset(int r, int c) const {
+    return leafOffset(r, c) + (size_t)(r % leaf) * leaf + c % leaf;
+}
+
+// Access element at (row, col) with bounds checking.
+template <typename T>
+T BasicMortonMat<T>::operator()(int r, int c) const {
+    if (r < 0 || r >= n || c < 0 || c >= n) {
+        throw st::out_of_range("Index out of range of matrix");
+    }
+    return data[offset(r, c)];
+}
+
+// Set element at (row, col) with bounds checking.
+template <typename T>
+void BasicMortonMat<T>::set(int r, int c, T value) {
+    if (r < 0 || r >= n || c < 0 || c >= n) {
+        throw st::out_of_range("Index out of range of matrix");
+    }
+    data[offset(r, c)] = value;
+}
+
+// Get number of rows in the matrix.
+template <typename T>
+int BasicMortonMat<T>::getRows() const { return n; }
+
+// Get number of columns in the matrix.
+template <typename T>
+int BasicMortonMat<T>::getCols() const { return n; }
+
+// Calculate sum of all elements; the zero padding does not contribute.
+template <typename T>
+T BasicMortonMat<T>::countSum() const {
+    T sum = T(0);
+    for (const T& value : data) sum += value;
+    return sum;
+}
+
+// Copy each leaf-wide row segment back into a row-major matrix.
+template <typename T>
+BasicSquareMat<T> BasicMortonMat<T>::toDense() const {
+    BasicSquareMat<T> result(n, uninitialized);
+    for (int i = 0; i < n; ++i) {
+        T* out = result[i];
+        for (int col = 0; col < n; col += leaf) {
+            const T* src = data.data() + leafOffset(i, col) + (size_t)(i % leaf) * leaf;
+            st::copy(src, src + (st::min(n, col + leaf) - col), out + col);
+        }
+    }
+    return result;
+}
+
+// Compare matrices for equality (size and all elements).
+template <typename T>
+bool BasicMortonMat<T>::operator==(const BasicMortonMat& other) const {
+    return n == other.n && data == other.data;
+}
+
+// Compare matrices for inequality.
+template <typename T>
+bool BasicMortonMat<T>::operator!=(const BasicMortonMat& other) const {
+    return !(*this == other);
+}
+
+// Add two Z-order matrices over the whole buffer.
+template <typename T>
+BasicMortonMat<T> BasicMortonMat<T>::add(const BasicMortonMat& left, const BasicMortonMat& right) {
+    requireSameSize(left.n, right.n, "addition");
+    BasicMortonMat result(left);
+    for (size_t i = 0; i < result.data.size(); ++i) result.data[i] += right.data[i];
+    return result;
+}
+
+// Subtract one Z-order matrix from another over the whole buffer.
+template <typename T>
+BasicMortonMat<T> BasicMortonMat<T>::subtract(const BasicMortonMat& left, const BasicMortonMat& right) {
+    requireSameSize(left.n, right.n, "subtraction");
+    BasicMortonMat result(left);
+    for (size_t i = 0; i < result.data.size(); ++i) result.data[i] -= right.data[i];
+    return result;
+}
+
+// Multiply two Z-order matrices element by element over the whole buffer.
+template <typename T>
+BasicMortonMat<T> BasicMortonMat<T>::elementwise(const BasicMortonMat& left, const BasicMortonMat& right) {
+    requireSameSize(left.n, right.n, "element-wise multiplication");
+    BasicMortonMat result(left);
+    for (size_t i = 0; i < result.data.size(); ++i) result.data[i] *= right.data[i];
+    return result;
+}
+
+// Multiply each element by a scalar.
+template <typename T>
+BasicMortonMat<T> BasicMortonMat<T>::scale(const BasicMortonMat& mat, T scalar) {
+    BasicMortonMat result(mat);
+    for (T& value : result.data) value *= scalar;
+    return result;
+}
+
+// Recursive cache-oblivious product into a zeroed result, skipping the padding.
+template <typename T>
+BasicMortonMat<T> BasicMortonMat<T>::multiply(const BasicMortonMat& left, const BasicMortonMat& right) {
+    requireSameSize(left.n, right.n, "multiplication");
+    BasicMortonMat result(left.n);
+    multiplyBlock(result.data.data(), left.data.data(), right.data.data(), left.side, left.leaf, left.n, left.n, left.n);
+    return result;
+}
+
+// Recursive cache-oblivious transpose, skipping the padding.
+template <typename T>
+BasicMortonMat<T> BasicMortonMat<T>::transpose(const BasicMortonMat& mat) {
+    BasicMortonMat result(mat.n);
+    transposeBlock(result.data.data(), mat.data.data(), mat.side, mat.leaf, mat.n, mat.n);
+    return result;
+}
+
+// Explicit instantiations for the supported element types.
+template class BasicMortonMat<float>;
+template class BasicMortonMat<double>;
+template class BasicMortonMat<std::int64_t>;
+template class BasicMortonMat<std::complex<double>>;
+
+}
@@ -0,0 +1,218 @@
+// adar101101@gmail.com
+
+#pragma once
+#include <complex>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+#include "SquareMat.hpp"
+
+/**
+ * @file MortonMat.hpp
+ * @brief Declaration of the BasicMortonMat class, a square matrix stored in Morton (Z) order.
+ */
+
+namespace Matrix {
+
+/**
+ * @class BasicMortonMat
+ * @brief Square matrix of T stored in Z-order, with cache-oblivious recursive kernels.
+ *
+ * The matrix is padded with zeros to a power-of-two side P and stored recursively: the four
+ * quadrants of every block (top-left, top-right, bottom-left, bottom-right) are contiguous and
+ * consecutive, down to LEAF x LEAF leaves stored row-major. Multiplication and transpose recurse
+ * on quadrants, so at every level of the recursion some block fits each cache level, whatever
+ * its size: no block size needs tuning per host. The leaves are only large enough to give the
+ * compiler unit-stride loops to vectorize.
+ *
+ * Padding is not free: storage is P² elements, so a size just above a power of two (2^k + 1)
+ * holds nearly four times the n² elements of a dense matrix, and the element-wise operators,
+ * countSum() and comparisons scan all of it. Multiplication and transpose carry the logical
+ * size down the recursion and skip every quadrant product or copy that touches only padding,
+ * so their arithmetic stays proportional to n³ and n².
+ *
+ * The member definitions live in MortonMat.cpp and are explicitly instantiated for the same
+ * element types as BasicSquareMat.
+ * @tparam T Element type.
+ */
+template <typename T>
+class BasicMortonMat {
+public:
+    /// Edge of the row-major leaf blocks where the recursion stops.
+    static constexpr int LEAF = 16;
+
+private:
+    int n;                  ///< Number of rows and columns.
+    int side;               ///< Padded side P, a power of two.
+    int leaf;               ///< Leaf edge, min(LEAF, P).
+    std::vector<T> data;    ///< P² elements in Z-order.
+
+    /**
+     * @brief Returns the storage position of element (row, col).
+     */
+    size_t offset(int row, int col) const;
+
+    /**
+     * @brief Returns the position of the first element of the leaf holding (row, col).
+     */
+    size_t leafOffset(int row, int col) const;
+
+    // Kernels behind the non-member operators.
+    static BasicMortonMat add(const BasicMortonMat& left, const BasicMortonMat& right);
+    static BasicMortonMat subtract(const BasicMortonMat& left, const BasicMortonMat& right);
+    static BasicMortonMat elementwise(const BasicMortonMat& left, const BasicMortonMat& right);
+    static BasicMortonMat scale(const BasicMortonMat& mat, T scalar);
+    static BasicMortonMat multiply(const BasicMortonMat& left, const BasicMortonMat& right);
+    static BasicMortonMat transpose(const BasicMortonMat& mat);
+
+public:
+    //
+    // Constructors
+    //
+
+    /**
+     * @brief Constructs an all-zero Z-order matrix.
+     * @param size Number of rows and columns.
+     * @throws std::invalid_argument if size <= 0.
+     */
+    explicit BasicMortonMat(int size);
+
+    /**
+     * @brief Copies a dense matrix (or view) into Z-order.
+     * @param dense Matrix to convert.
+     */
+    explicit BasicMortonMat(const BasicConstMatrixView<T>& dense);
+
+    //
+    // Element Access
+    //
+
+    /**
+     * @brief Returns the element at (row, col).
+     * @param row Rows number.
+     * @param col Columns number.
+     * @return Element value.
+     * @throws std::out_of_range if the index is outside the matrix.
+     */
+    T operator()(int row, int col) const;
+
+    /**
+     * @brief Sets the element at (row, col).
+     * @param row Rows number.
+     * @param col Columns number.
+     * @param value New value.
+     * @throws std::out_of_range if the index is outside the matrix.
+     */
+    void set(int row, int col, T value);
+
+    //
+    // Utilities
+    //
+
+    /**
+     * @brief Returns the number of rows.
+     * @return Number of rows.
+     */
+    int getRows() const;
+
+    /**
+     * @brief Returns the number of columns.
+     * @return Number of columns.
+     */
+    int getCols() const;
+
+    /**
+     * @brief Returns the sum of all elements in the matrix.
+     * @return Sum of elements.
+     */
+    T countSum() const;
+
+    /**
+     * @brief Converts to a row-major dense matrix.
+     * @return Dense copy of this matrix.
+     */
+    BasicSquareMat<T> toDense() const;
+
+    /**
+     * @brief Checks if two Z-order matrices are equal (same size and elements).
+     * @param other Matrix to compare.
+     * @return True if equal.
+     */
+    bool operator==(const BasicMortonMat& other) const;
+
+    /**
+     * @brief Checks if two Z-order matrices are not equal.
+     * @param other Matrix to compare.
+     * @return True if not equal.
+     */
+    bool operator!=(const BasicMortonMat& other) const;
+
+    //
+    // Friend Non-member Operators
+    //
+
+    /**
+     * @brief Adds two Z-order matrices.
+     * @param left Left operand.
+     * @param right Right operand.
+     * @return New matrix containing the sum.
+     */
+    friend BasicMortonMat operator+(const BasicMortonMat& left, const BasicMortonMat& right) { return add(left, right); }
+
+    /**
+     * @brief Subtracts one Z-order matrix from another.
+     * @param left Left operand.
+     * @param right Right operand.
+     * @return New matrix containing the difference.
+     */
+    friend BasicMortonMat operator-(const BasicMortonMat& left, const BasicMortonMat& right) { return subtract(left, right); }
+
+    /**
+     * @brief Multiplies two Z-order matrices element by element.
+     * @param left Left operand.
+     * @param right Right operand.
+     * @return New matrix containing the element-wise product.
+     */
+    friend BasicMortonMat operator%(const BasicMortonMat& left, const BasicMortonMat& right) { return elementwise(left, right); }
+
+    /**
+     * @brief Multiplies each element by a scalar.
+     * @param mat Matrix operand.
+     * @param scalar Scalar operand.
+     * @return New matrix with elements scaled.
+     */
+    friend BasicMortonMat operator*(const BasicMortonMat& mat, T scalar) { return scale(mat, scalar); }
+
+    /**
+     * @brief Multiplies each element by a scalar (scalar on left).
+     * @param scalar Scalar operand.
+     * @param mat Matrix operand.
+     * @return New matrix with elements scaled.
+     */
+    friend BasicMortonMat operator*(T scalar, const BasicMortonMat& mat) { return scale(mat, scalar); }
+
+    /**
+     * @brief Multiplies two Z-order matrices by recursing on quadrants.
+     * @param left Left operand.
+     * @param right Right operand.
+     * @return New matrix containing the product.
+     */
+    friend BasicMortonMat operator*(const BasicMortonMat& left, const BasicMortonMat& right) { return multiply(left, right); }
+
+    /**
+     * @brief Returns the transpose, computed by recursing on quadrants.
+     * @param mat Matrix to transpose.
+     * @return Transposed matrix.
+     */
+    friend BasicMortonMat operator~(const BasicMortonMat& mat) { return transpose(mat); }
+};
+
+/// Z-order matrix of doubles.
+using MortonMat = BasicMortonMat<double>;
+
+extern template class BasicMortonMat<float>;
+extern template class BasicMortonMat<double>;
+extern template class BasicMortonMat<std::int64_t>;
+extern template class BasicMortonMat<std::complex<double>>;
+
+}
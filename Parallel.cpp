@@ -0,0 +1,209 @@
+// adar101101@gmail.com
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "Parallel.hpp"
+#include "MatrixMemory.hpp"
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
+namespace st = std;
+
+namespace Matrix {
+
+namespace {
+
+st::atomic<int> requestedThreads{0};
+st::atomic<size_t> parallelThreshold{size_t(1) << 16};
+st::atomic<size_t> parallelProductThreshold{size_t(1) << 21};
+
+// Set on worker threads and on a caller while it runs forRows, so nested calls stay serial.
+thread_local bool insideParallel = false;
+
+// CPUs this process may run on, in increasing order (empty if unknown).
+st::vector<int> allowedCpus() {
+    st::vector<int> cpus;
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+            if (CPU_ISSET(cpu, &set)) cpus.push_back(cpu);
+        }
+    }
+#endif
+    return cpus;
+}
+
+// Restrict the calling thread to one CPU, so the scheduler cannot move it to another node.
+void pinToCpu(int cpu) {
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    sched_setaffinity(0, sizeof(set), &set);
+#else
+    (void)cpu;
+#endif
+}
+
+// Workers 1 .. count - 1; worker 0 is whichever thread calls forRows.
+struct WorkerPool {
+    st::mutex mutex;
+    st::condition_variable wake;
+    st::condition_variable done;
+    st::vector<st::thread> workers;
+    bool pinned = false;   ///< Whether the workers were started pinned to CPUs (FirstTouch mode).
+    const st::function<void(int, int)>* body = nullptr;
+    int rows = 0;
+    int blocks = 0;
+    unsigned long generation = 0;
+    int pending = 0;
+    bool stopping = false;
+    st::exception_ptr error;
+
+    ~WorkerPool() { stop(); }
+
+    // Run block t of the current job, keeping the first exception.
+    void runBlock(int t) {
+        const int begin = (int)((long long)rows * t / blocks);
+        const int end = (int)((long long)rows * (t + 1) / blocks);
+        try {
+            (*body)(begin, end);
+        } catch (...) {
+            st::lock_guard<st::mutex> lock(mutex);
+            if (!error) error = st::current_exception();
+        }
+    }
+
+    // Wait for each new job and run this worker's block of it.
+    void loop(int index, unsigned long seen) {
+        insideParallel = true;
+        st::unique_lock<st::mutex> lock(mutex);
+        for (;;) {
+            wake.wait(lock, [&] { return stopping || generation != seen; });
+            if (stopping) return;
+            seen = generation;
+            if (index < blocks) {
+                lock.unlock();
+                runBlock(index);
+                lock.lock();
+            }
+            if (--pending == 0) done.notify_one();
+        }
+    }
+
+    // Launch count - 1 workers that wait for the next job. With pinning, worker i stays on the
+    // i-th allowed CPU (wrapping around), so the rows it first touches stay on its node.
+    void start(int count, bool pin) {
+        stopping = false;
+        pinned = pin;
+        const st::vector<int> cpus = pin ? allowedCpus() : st::vector<int>();
+        for (int i = 1; i < count; ++i) {
+            const int cpu = cpus.empty() ? -1 : cpus[(size_t)i % cpus.size()];
+            workers.emplace_back([this, i, cpu, current = generation] {
+                if (cpu >= 0) pinToCpu(cpu);
+                loop(i, current);
+            });
+        }
+    }
+
+    // Wake every worker to exit and join it.
+    void stop() {
+        {
+            st::lock_guard<st::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (st::thread& worker : workers) worker.join();
+        workers.clear();
+    }
+};
+
+// Serializes forRows and restarts; a call that cannot take it runs serially.
+st::mutex callMutex;
+
+WorkerPool& workerPool() {
+    static WorkerPool pool;
+    return pool;
+}
+
+}
+
+// Set the thread count; the workers are restarted on the next forRows.
+void Parallel::setThreads(int count) {
+    requestedThreads.store(count, st::memory_order_relaxed);
+}
+
+// Thread count, resolving 0 to the hardware concurrency.
+int Parallel::threads() {
+    int count = requestedThreads.load(st::memory_order_relaxed);
+    if (count <= 0) count = (int)st::thread::hardware_concurrency();
+    return count > 0 ? count : 1;
+}
+
+// Set the serial threshold.
+void Parallel::setThreshold(size_t elements) {
+    parallelThreshold.store(elements, st::memory_order_relaxed);
+}
+
+// Serial threshold.
+size_t Parallel::threshold() {
+    return parallelThreshold.load(st::memory_order_relaxed);
+}
+
+// Set the serial threshold of matrix products.
+void Parallel::setProductThreshold(size_t multiplyAdds) {
+    parallelProductThreshold.store(multiplyAdds, st::memory_order_relaxed);
+}
+
+// Serial threshold of matrix products.
+size_t Parallel::productThreshold() {
+    return parallelProductThreshold.load(st::memory_order_relaxed);
+}
+
+// Hand block t to worker t and run block 0 here, then wait for the rest.
+void Parallel::forRows(int rows, const st::function<void(int, int)>& body) {
+    if (rows <= 0) return;
+    const int count = threads();
+    const int blocks = count < rows ? count : rows;
+    st::unique_lock<st::mutex> call(callMutex, st::defer_lock);
+    if (blocks == 1 || insideParallel || !call.try_lock()) {
+        body(0, rows);
+        return;
+    }
+    WorkerPool& pool = workerPool();
+    const bool pin = NumaPlacement::mode() == NumaPlacement::Mode::FirstTouch;
+    if ((int)pool.workers.size() != count - 1 || pool.pinned != pin) {
+        pool.stop();
+        pool.start(count, pin);
+    }
+    {
+        st::lock_guard<st::mutex> lock(pool.mutex);
+        pool.body = &body;
+        pool.rows = rows;
+        pool.blocks = blocks;
+        pool.pending = (int)pool.workers.size();
+        pool.error = nullptr;
+        ++pool.generation;
+    }
+    pool.wake.notify_all();
+    insideParallel = true;
+    pool.runBlock(0);
+    insideParallel = false;
+    st::exception_ptr error;
+    {
+        st::unique_lock<st::mutex> lock(pool.mutex);
+        pool.done.wait(lock, [&] { return pool.pending == 0; });
+        error = pool.error;
+        pool.body = nullptr;
+    }
+    if (error) st::rethrow_exception(error);
+}
+
+}
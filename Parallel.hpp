@@ -0,0 +1,77 @@
+// adar101101@gmail.com
+
+#pragma once
+#include <cstddef>
+#include <functional>
+
+/**
+ * @file Parallel.hpp
+ * @brief Declaration of the Parallel class, the worker threads behind the row-parallel kernels.
+ */
+
+namespace Matrix {
+
+/**
+ * @class Parallel
+ * @brief Persistent worker threads that split row ranges into one contiguous block per thread.
+ *
+ * forRows() always gives block t of a range to the same worker t (block 0 to the calling
+ * thread), so a matrix whose rows were first touched through forRows() is later processed by
+ * the threads whose NUMA node holds those rows. In NumaPlacement::Mode::FirstTouch the workers
+ * are pinned to one CPU each (worker t to the t-th CPU the process may use) so they cannot
+ * migrate to another node; block 0 runs on the calling thread, which is never pinned, so its
+ * placement is best-effort. The workers are started on first use and restarted when the thread
+ * count changes or FirstTouch is switched on or off. Calls from inside a forRows() body, and concurrent
+ * calls from other threads while one is running, execute serially on the calling thread.
+ */
+class Parallel {
+public:
+    /**
+     * @brief Sets the number of threads used by forRows(), including the calling thread.
+     * @param count Thread count; 0 or less means std::thread::hardware_concurrency(), 1 means serial.
+     */
+    static void setThreads(int count);
+
+    /**
+     * @brief Returns the number of threads used by forRows().
+     * @return Thread count, at least 1.
+     */
+    static int threads();
+
+    /**
+     * @brief Sets the size, in elements, below which matrix kernels stay on the calling thread.
+     * @param elements Threshold (65536 by default).
+     */
+    static void setThreshold(size_t elements);
+
+    /**
+     * @brief Returns the size below which matrix kernels stay serial.
+     * @return Threshold in elements.
+     */
+    static size_t threshold();
+
+    /**
+     * @brief Sets the size, in multiply-adds (n³ for an n x n product), below which matrix
+     *        products stay on the calling thread.
+     * @param multiplyAdds Threshold (2^21, about a 128 x 128 product, by default).
+     */
+    static void setProductThreshold(size_t multiplyAdds);
+
+    /**
+     * @brief Returns the size below which matrix products stay serial.
+     * @return Threshold in multiply-adds.
+     */
+    static size_t productThreshold();
+
+    /**
+     * @brief Runs body over [0, rows) split into min(threads(), rows) contiguous blocks.
+     *
+     * Block t is [rows * t / p, rows * (t + 1) / p) and runs on worker t. Returns once every
+     * block has finished; the first exception thrown by a block is rethrown here.
+     * @param rows Number of rows.
+     * @param body Called as body(begin, end) once per block.
+     */
+    static void forRows(int rows, const std::function<void(int begin, int end)>& body);
+};
+
+}
@@ -0,0 +1,626 @@
+// adar101101@gmail.com
+
+#include <stdexcept>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <complex>
+#include <cstdint>
+#include "Simd.hpp"
+#include "Gemm.hpp"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define MATRIX_SIMD_X86 1
+#include <immintrin.h>
+#else
+#define MATRIX_SIMD_X86 0
+#endif
+
+namespace st = std;
+
+namespace Matrix {
+
+namespace {
+
+// Widest level supported by both the CPU (as reported by cpuid) and this build.
+Simd::Level detectLevel() {
+#if MATRIX_SIMD_X86
+    __builtin_cpu_init();
+    const bool avx2 = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    if (avx2 && __builtin_cpu_supports("avx512f")) return Simd::Level::AVX512;
+    if (avx2) return Simd::Level::AVX2;
+    if (__builtin_cpu_supports("sse2")) return Simd::Level::SSE2;
+#endif
+    return Simd::Level::Generic;
+}
+
+// Level in use, or -1 until the first call to Simd::level() or Simd::setLevel().
+st::atomic<int> selectedLevel{-1};
+
+// out[i] = a[i] + b[i].
+template <typename T>
+void addGeneric(const T* a, const T* b, T* out, size_t n) {
+    for (size_t i = 0; i < n; ++i) out[i] = a[i] + b[i];
+}
+
+// out[i] = a[i] - b[i].
+template <typename T>
+void subtractGeneric(const T* a, const T* b, T* out, size_t n) {
+    for (size_t i = 0; i < n; ++i) out[i] = a[i] - b[i];
+}
+
+// out[i] = a[i] * b[i].
+template <typename T>
+void multiplyGeneric(const T* a, const T* b, T* out, size_t n) {
+    for (size_t i = 0; i < n; ++i) out[i] = a[i] * b[i];
+}
+
+// out[i] = a[i] * scalar.
+template <typename T>
+void scaleGeneric(const T* a, T scalar, T* out, size_t n) {
+    for (size_t i = 0; i < n; ++i) out[i] = a[i] * scalar;
+}
+
+// out[i] = a[i] / scalar.
+template <typename T>
+void divideGeneric(const T* a, T scalar, T* out, size_t n) {
+    for (size_t i = 0; i < n; ++i) out[i] = a[i] / scalar;
+}
+
+// Sum of a[0..n) from left to right.
+template <typename T>
+T sumGeneric(const T* a, size_t n) {
+    T sum = T(0);
+    for (size_t i = 0; i < n; ++i) sum += a[i];
+    return sum;
+}
+
+// out[i] = value.
+template <typename T>
+void fillGeneric(T* out, T value, size_t n) {
+    st::fill(out, out + n, value);
+}
+
+// Transpose in 32 x 32 tiles, so both the rows read and the rows written stay in L1.
+template <typename T>
+void transposeGeneric(const T* src, size_t lds, T* dst, size_t ldd, int rows, int cols) {
+    constexpr int TILE = 32;
+    for (int i0 = 0; i0 < rows; i0 += TILE) {
+        const int i1 = st::min(rows, i0 + TILE);
+        for (int j0 = 0; j0 < cols; j0 += TILE) {
+            const int j1 = st::min(cols, j0 + TILE);
+            for (int i = i0; i < i1; ++i) {
+                for (int j = j0; j < j1; ++j) {
+                    dst[(size_t)j * ldd + i] = src[(size_t)i * lds + j];
+                }
+            }
+        }
+    }
+}
+
+// One MR x NR register tile in portable C++. The tile loops are fully unrolled so the
+// accumulators live in registers rather than on the stack.
+template <typename T>
+void microKernelGeneric(int kc, const T* ap, const T* bp, T* c, size_t ldc, bool accumulate) {
+    constexpr int MR = detail::GemmBlocking<T>::MR;
+    constexpr int NR = detail::GemmBlocking<T>::NR;
+    T acc[MR][NR];
+    for (int i = 0; i < MR; ++i) {
+        for (int j = 0; j < NR; ++j) {
+            acc[i][j] = T(0);
+        }
+    }
+    for (int p = 0; p < kc; ++p) {
+#pragma GCC unroll 4
+        for (int i = 0; i < MR; ++i) {
+            const T aip = ap[i];
+#pragma GCC unroll 8
+            for (int j = 0; j < NR; ++j) {
+                acc[i][j] += aip * bp[j];
+            }
+        }
+        ap += MR;
+        bp += NR;
+    }
+    for (int i = 0; i < MR; ++i) {
+        T* ci = c + (size_t)i * ldc;
+        if (accumulate) {
+            for (int j = 0; j < NR; ++j) ci[j] += acc[i][j];
+        } else {
+            for (int j = 0; j < NR; ++j) ci[j] = acc[i][j];
+        }
+    }
+}
+
+// Kernel table of the portable implementations.
+template <typename T>
+detail::SimdKernels<T> genericKernels() {
+    return {addGeneric<T>, subtractGeneric<T>, multiplyGeneric<T>, scaleGeneric<T>, divideGeneric<T>,
+            sumGeneric<T>, fillGeneric<T>, transposeGeneric<T>, microKernelGeneric<T>};
+}
+
+#if MATRIX_SIMD_X86
+
+// Each kernel below is a plain function carrying the target attribute of its instruction set.
+// The row templates it calls are always inlined into it, and the register traits they use are
+// inlined after them, so the whole kernel is compiled for that instruction set while the rest
+// of the library stays generic x86-64.
+#define MATRIX_TARGET_SSE2 __attribute__((target("sse2")))
+#define MATRIX_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#define MATRIX_TARGET_AVX512 __attribute__((target("avx512f,avx2,fma")))
+#define MATRIX_ALWAYS_INLINE inline __attribute__((always_inline))
+
+// The row templates pass registers by value before they are inlined, which GCC flags as an ABI
+// change; no register ever crosses a real call, so the note does not apply.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpsabi"
+
+static_assert(detail::GemmBlocking<double>::MR == 4 && detail::GemmBlocking<double>::NR == 8,
+              "The vector microkernels compute 4 x 8 tiles");
+static_assert(detail::GemmBlocking<float>::MR == 4 && detail::GemmBlocking<float>::NR == 8,
+              "The vector microkernels compute 4 x 8 tiles");
+
+// Register traits: one vector register of Scalar, unaligned loads and stores, lane-wise
+// arithmetic, and an in-register transpose of a BLOCK x BLOCK block.
+
+struct Sse2Double {
+    using Scalar = double;
+    using Reg = __m128d;
+    static constexpr int WIDTH = 2;
+    static constexpr int BLOCK = 2;
+    MATRIX_TARGET_SSE2 static Reg load(const double* p) { return _mm_loadu_pd(p); }
+    MATRIX_TARGET_SSE2 static void store(double* p, Reg v) { _mm_storeu_pd(p, v); }
+    MATRIX_TARGET_SSE2 static Reg set1(double x) { return _mm_set1_pd(x); }
+    MATRIX_TARGET_SSE2 static Reg zero() { return _mm_setzero_pd(); }
+    MATRIX_TARGET_SSE2 static Reg add(Reg a, Reg b) { return _mm_add_pd(a, b); }
+    MATRIX_TARGET_SSE2 static Reg sub(Reg a, Reg b) { return _mm_sub_pd(a, b); }
+    MATRIX_TARGET_SSE2 static Reg mul(Reg a, Reg b) { return _mm_mul_pd(a, b); }
+    MATRIX_TARGET_SSE2 static Reg div(Reg a, Reg b) { return _mm_div_pd(a, b); }
+    MATRIX_TARGET_SSE2 static void transposeBlock(const double* src, size_t lds, double* dst, size_t ldd) {
+        const Reg r0 = load(src), r1 = load(src + lds);
+        store(dst, _mm_unpacklo_pd(r0, r1));
+        store(dst + ldd, _mm_unpackhi_pd(r0, r1));
+    }
+};
+
+struct Sse2Float {
+    using Scalar = float;
+    using Reg = __m128;
+    static constexpr int WIDTH = 4;
+    static constexpr int BLOCK = 4;
+    MATRIX_TARGET_SSE2 static Reg load(const float* p) { return _mm_loadu_ps(p); }
+    MATRIX_TARGET_SSE2 static void store(float* p, Reg v) { _mm_storeu_ps(p, v); }
+    MATRIX_TARGET_SSE2 static Reg set1(float x) { return _mm_set1_ps(x); }
+    MATRIX_TARGET_SSE2 static Reg zero() { return _mm_setzero_ps(); }
+    MATRIX_TARGET_SSE2 static Reg add(Reg a, Reg b) { return _mm_add_ps(a, b); }
+    MATRIX_TARGET_SSE2 static Reg sub(Reg a, Reg b) { return _mm_sub_ps(a, b); }
+    MATRIX_TARGET_SSE2 static Reg mul(Reg a, Reg b) { return _mm_mul_ps(a, b); }
+    MATRIX_TARGET_SSE2 static Reg div(Reg a, Reg b) { return _mm_div_ps(a, b); }
+    MATRIX_TARGET_SSE2 static void transposeBlock(const float* src, size_t lds, float* dst, size_t ldd) {
+        Reg r0 = load(src), r1 = load(src + lds), r2 = load(src + 2 * lds), r3 = load(src + 3 * lds);
+        _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+        store(dst, r0);
+        store(dst + ldd, r1);
+        store(dst + 2 * ldd, r2);
+        store(dst + 3 * ldd, r3);
+    }
+};
+
+struct Avx2Double {
+    using Scalar = double;
+    using Reg = __m256d;
+    static constexpr int WIDTH = 4;
+    static constexpr int BLOCK = 4;
+    MATRIX_TARGET_AVX2 static Reg load(const double* p) { return _mm256_loadu_pd(p); }
+    MATRIX_TARGET_AVX2 static void store(double* p, Reg v) { _mm256_storeu_pd(p, v); }
+    MATRIX_TARGET_AVX2 static Reg set1(double x) { return _mm256_set1_pd(x); }
+    MATRIX_TARGET_AVX2 static Reg zero() { return _mm256_setzero_pd(); }
+    MATRIX_TARGET_AVX2 static Reg add(Reg a, Reg b) { return _mm256_add_pd(a, b); }
+    MATRIX_TARGET_AVX2 static Reg sub(Reg a, Reg b) { return _mm256_sub_pd(a, b); }
+    MATRIX_TARGET_AVX2 static Reg mul(Reg a, Reg b) { return _mm256_mul_pd(a, b); }
+    MATRIX_TARGET_AVX2 static Reg div(Reg a, Reg b) { return _mm256_div_pd(a, b); }
+    MATRIX_TARGET_AVX2 static void transposeBlock(const double* src, size_t lds, double* dst, size_t ldd) {
+        const Reg r0 = load(src), r1 = load(src + lds), r2 = load(src + 2 * lds), r3 = load(src + 3 * lds);
+        const Reg t0 = _mm256_unpacklo_pd(r0, r1), t1 = _mm256_unpackhi_pd(r0, r1);
+        const Reg t2 = _mm256_unpacklo_pd(r2, r3), t3 = _mm256_unpackhi_pd(r2, r3);
+        store(dst, _mm256_permute2f128_pd(t0, t2, 0x20));
+        store(dst + ldd, _mm256_permute2f128_pd(t1, t3, 0x20));
+        store(dst + 2 * ldd, _mm256_permute2f128_pd(t0, t2, 0x31));
+        store(dst + 3 * ldd, _mm256_permute2f128_pd(t1, t3, 0x31));
+    }
+};
+
+struct Avx2Float {
+    using Scalar = float;
+    using Reg = __m256;
+    static constexpr int WIDTH = 8;
+    static constexpr int BLOCK = 8;
+    MATRIX_TARGET_AVX2 static Reg load(const float* p) { return _mm256_loadu_ps(p); }
+    MATRIX_TARGET_AVX2 static void store(float* p, Reg v) { _mm256_storeu_ps(p, v); }
+    MATRIX_TARGET_AVX2 static Reg set1(float x) { return _mm256_set1_ps(x); }
+    MATRIX_TARGET_AVX2 static Reg zero() { return _mm256_setzero_ps(); }
+    MATRIX_TARGET_AVX2 static Reg add(Reg a, Reg b) { return _mm256_add_ps(a, b); }
+    MATRIX_TARGET_AVX2 static Reg sub(Reg a, Reg b) { return _mm256_sub_ps(a, b); }
+    MATRIX_TARGET_AVX2 static Reg mul(Reg a, Reg b) { return _mm256_mul_ps(a, b); }
+    MATRIX_TARGET_AVX2 static Reg div(Reg a, Reg b) { return _mm256_div_ps(a, b); }
+    MATRIX_TARGET_AVX2 static void transposeBlock(const float* src, size_t lds, float* dst, size_t ldd) {
+        Reg r[8], s[8];
+        for (int i = 0; i < 8; ++i) r[i] = load(src + i * lds);
+        for (int i = 0; i < 8; i += 4) {
+            const Reg t0 = _mm256_unpacklo_ps(r[i], r[i + 1]), t1 = _mm256_unpackhi_ps(r[i], r[i + 1]);
+            const Reg t2 = _mm256_unpacklo_ps(r[i + 2], r[i + 3]), t3 = _mm256_unpackhi_ps(r[i + 2], r[i + 3]);
+            s[i] = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+            s[i + 1] = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+            s[i + 2] = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+            s[i + 3] = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+        }
+        for (int i = 0; i < 4; ++i) {
+            store(dst + i * ldd, _mm256_permute2f128_ps(s[i], s[i + 4], 0x20));
+            store(dst + (i + 4) * ldd, _mm256_permute2f128_ps(s[i], s[i + 4], 0x31));
+        }
+    }
+};
+
+struct Avx512Double {
+    using Scalar = double;
+    using Reg = __m512d;
+    static constexpr int WIDTH = 8;
+    static constexpr int BLOCK = Avx2Double::BLOCK;
+    MATRIX_TARGET_AVX512 static Reg load(const double* p) { return _mm512_loadu_pd(p); }
+    MATRIX_TARGET_AVX512 static void store(double* p, Reg v) { _mm512_storeu_pd(p, v); }
+    MATRIX_TARGET_AVX512 static Reg set1(double x) { return _mm512_set1_pd(x); }
+    MATRIX_TARGET_AVX512 static Reg zero() { return _mm512_setzero_pd(); }
+    MATRIX_TARGET_AVX512 static Reg add(Reg a, Reg b) { return _mm512_add_pd(a, b); }
+    MATRIX_TARGET_AVX512 static Reg sub(Reg a, Reg b) { return _mm512_sub_pd(a, b); }
+    MATRIX_TARGET_AVX512 static Reg mul(Reg a, Reg b) { return _mm512_mul_pd(a, b); }
+    MATRIX_TARGET_AVX512 static Reg div(Reg a, Reg b) { return _mm512_div_pd(a, b); }
+    MATRIX_TARGET_AVX512 static void transposeBlock(const double* src, size_t lds, double* dst, size_t ldd) {
+        Avx2Double::transposeBlock(src, lds, dst, ldd);
+    }
+};
+
+struct Avx512Float {
+    using Scalar = float;
+    using Reg = __m512;
+    static constexpr int WIDTH = 16;
+    static constexpr int BLOCK = Avx2Float::BLOCK;
+    MATRIX_TARGET_AVX512 static Reg load(const float* p) { return _mm512_loadu_ps(p); }
+    MATRIX_TARGET_AVX512 static void store(float* p, Reg v) { _mm512_storeu_ps(p, v); }
+    MATRIX_TARGET_AVX512 static Reg set1(float x) { return _mm512_set1_ps(x); }
+    MATRIX_TARGET_AVX512 static Reg zero() { return _mm512_setzero_ps(); }
+    MATRIX_TARGET_AVX512 static Reg add(Reg a, Reg b) { return _mm512_add_ps(a, b); }
+    MATRIX_TARGET_AVX512 static Reg sub(Reg a, Reg b) { return _mm512_sub_ps(a, b); }
+    MATRIX_TARGET_AVX512 static Reg mul(Reg a, Reg b) { return _mm512_mul_ps(a, b); }
+    MATRIX_TARGET_AVX512 static Reg div(Reg a, Reg b) { return _mm512_div_ps(a, b); }
+    MATRIX_TARGET_AVX512 static void transposeBlock(const float* src, size_t lds, float* dst, size_t ldd) {
+        Avx2Float::transposeBlock(src, lds, dst, ldd);
+    }
+};
+
+// Lane-wise operations shared by the element-wise row templates.
+enum class Op { Add, Subtract, Multiply, Divide };
+
+// a op b on one element, for the tails of the rows.
+template <Op op, typename S>
+MATRIX_ALWAYS_INLINE S applyScalar(S a, S b) {
+    if constexpr (op == Op::Add) return a + b;
+    else if constexpr (op == Op::Subtract) return a - b;
+    else if constexpr (op == Op::Multiply) return a * b;
+    else return a / b;
+}
+
+// out[i] = a[i] op b[i], a register at a time, then element by element for the tail.
+template <typename V, Op op>
+MATRIX_ALWAYS_INLINE void binaryRow(const typename V::Scalar* a, const typename V::Scalar* b,
+                                    typename V::Scalar* out, size_t n) {
+    size_t i = 0;
+    for (; i + V::WIDTH <= n; i += V::WIDTH) {
+        const typename V::Reg x = V::load(a + i), y = V::load(b + i);
+        if constexpr (op == Op::Add) V::store(out + i, V::add(x, y));
+        else if constexpr (op == Op::Subtract) V::store(out + i, V::sub(x, y));
+        else V::store(out + i, V::mul(x, y));
+    }
+    for (; i < n; ++i) out[i] = applyScalar<op>(a[i], b[i]);
+}
+
+// out[i] = a[i] op scalar, a register at a time, then element by element for the tail.
+template <typename V, Op op>
+MATRIX_ALWAYS_INLINE void scalarRow(const typename V::Scalar* a, typename V::Scalar scalar,
+                                    typename V::Scalar* out, size_t n) {
+    const typename V::Reg s = V::set1(scalar);
+    size_t i = 0;
+    for (; i + V::WIDTH <= n; i += V::WIDTH) {
+        if constexpr (op == Op::Multiply) V::store(out + i, V::mul(V::load(a + i), s));
+        else V::store(out + i, V::div(V::load(a + i), s));
+    }
+    for (; i < n; ++i) out[i] = applyScalar<op>(a[i], scalar);
+}
+
+// Sum with two independent vector accumulators, so consecutive adds do not wait on each other.
+template <typename V>
+MATRIX_ALWAYS_INLINE typename V::Scalar sumRow(const typename V::Scalar* a, size_t n) {
+    typename V::Reg acc0 = V::zero(), acc1 = V::zero();
+    size_t i = 0;
+    for (; i + 2 * V::WIDTH <= n; i += 2 * V::WIDTH) {
+        acc0 = V::add(acc0, V::load(a + i));
+        acc1 = V::add(acc1, V::load(a + i + V::WIDTH));
+    }
+    for (; i + V::WIDTH <= n; i += V::WIDTH) {
+        acc0 = V::add(acc0, V::load(a + i));
+    }
+    typename V::Scalar lanes[V::WIDTH];
+    V::store(lanes, V::add(acc0, acc1));
+    typename V::Scalar sum = 0;
+    for (int l = 0; l < V::WIDTH; ++l) sum += lanes[l];
+    for (; i < n; ++i) sum += a[i];
+    return sum;
+}
+
+// out[i] = value, a register at a time.
+template <typename V>
+MATRIX_ALWAYS_INLINE void fillRow(typename V::Scalar* out, typename V::Scalar value, size_t n) {
+    const typename V::Reg v = V::set1(value);
+    size_t i = 0;
+    for (; i + V::WIDTH <= n; i += V::WIDTH) V::store(out + i, v);
+    for (; i < n; ++i) out[i] = value;
+}
+
+// Transpose the whole BLOCK x BLOCK blocks in registers, visiting them in 32 x 32 tiles so
+// source and destination rows stay in L1; the ragged right and bottom edges go element by element.
+template <typename V>
+MATRIX_ALWAYS_INLINE void transposeRows(const typename V::Scalar* src, size_t lds, typename V::Scalar* dst,
+                                        size_t ldd, int rows, int cols) {
+    constexpr int B = V::BLOCK;
+    constexpr int TILE = 32;
+    const int rowsFull = rows / B * B;
+    const int colsFull = cols / B * B;
+    for (int i0 = 0; i0 < rowsFull; i0 += TILE) {
+        const int i1 = st::min(rowsFull, i0 + TILE);
+        for (int j0 = 0; j0 < colsFull; j0 += TILE) {
+            const int j1 = st::min(colsFull, j0 + TILE);
+            for (int i = i0; i < i1; i += B) {
+                for (int j = j0; j < j1; j += B) {
+                    V::transposeBlock(src + (size_t)i * lds + j, lds, dst + (size_t)j * ldd + i, ldd);
+                }
+            }
+        }
+    }
+    for (int i = 0; i < rows; ++i) {
+        for (int j = colsFull; j < cols; ++j) dst[(size_t)j * ldd + i] = src[(size_t)i * lds + j];
+    }
+    for (int i = rowsFull; i < rows; ++i) {
+        for (int j = 0; j < colsFull; ++j) dst[(size_t)j * ldd + i] = src[(size_t)i * lds + j];
+    }
+}
+
+// 4 x 8 double tile with AVX2: two registers per row, eight FMA chains in flight.
+MATRIX_TARGET_AVX2 void microKernelAvx2Double(int kc, const double* ap, const double* bp, double* c, size_t ldc,
+                                              bool accumulate) {
+    __m256d acc[4][2];
+    for (int i = 0; i < 4; ++i) acc[i][0] = acc[i][1] = _mm256_setzero_pd();
+    for (int p = 0; p < kc; ++p) {
+        const __m256d b0 = _mm256_loadu_pd(bp), b1 = _mm256_loadu_pd(bp + 4);
+#pragma GCC unroll 4
+        for (int i = 0; i < 4; ++i) {
+            const __m256d a = _mm256_broadcast_sd(ap + i);
+            acc[i][0] = _mm256_fmadd_pd(a, b0, acc[i][0]);
+            acc[i][1] = _mm256_fmadd_pd(a, b1, acc[i][1]);
+        }
+        ap += 4;
+        bp += 8;
+    }
+    for (int i = 0; i < 4; ++i) {
+        double* ci = c + (size_t)i * ldc;
+        if (accumulate) {
+            acc[i][0] = _mm256_add_pd(_mm256_loadu_pd(ci), acc[i][0]);
+            acc[i][1] = _mm256_add_pd(_mm256_loadu_pd(ci + 4), acc[i][1]);
+        }
+        _mm256_storeu_pd(ci, acc[i][0]);
+        _mm256_storeu_pd(ci + 4, acc[i][1]);
+    }
+}
+
+// 4 x 8 float tile with AVX2: a row is one register, so even and odd k go to separate
+// accumulators to keep eight FMA chains in flight.
+MATRIX_TARGET_AVX2 void microKernelAvx2Float(int kc, const float* ap, const float* bp, float* c, size_t ldc,
+                                             bool accumulate) {
+    __m256 acc[2][4];
+    for (int i = 0; i < 4; ++i) acc[0][i] = acc[1][i] = _mm256_setzero_ps();
+    int p = 0;
+    for (; p + 1 < kc; p += 2) {
+        const __m256 b0 = _mm256_loadu_ps(bp), b1 = _mm256_loadu_ps(bp + 8);
+#pragma GCC unroll 4
+        for (int i = 0; i < 4; ++i) {
+            acc[0][i] = _mm256_fmadd_ps(_mm256_broadcast_ss(ap + i), b0, acc[0][i]);
+            acc[1][i] = _mm256_fmadd_ps(_mm256_broadcast_ss(ap + 4 + i), b1, acc[1][i]);
+        }
+        ap += 8;
+        bp += 16;
+    }
+    if (p < kc) {
+        const __m256 b0 = _mm256_loadu_ps(bp);
+        for (int i = 0; i < 4; ++i) acc[0][i] = _mm256_fmadd_ps(_mm256_broadcast_ss(ap + i), b0, acc[0][i]);
+    }
+    for (int i = 0; i < 4; ++i) {
+        float* ci = c + (size_t)i * ldc;
+        __m256 r = _mm256_add_ps(acc[0][i], acc[1][i]);
+        if (accumulate) r = _mm256_add_ps(_mm256_loadu_ps(ci), r);
+        _mm256_storeu_ps(ci, r);
+    }
+}
+
+// 4 x 8 double tile with AVX-512: a row is one register, so even and odd k go to separate
+// accumulators to keep eight FMA chains in flight.
+MATRIX_TARGET_AVX512 void microKernelAvx512Double(int kc, const double* ap, const double* bp, double* c, size_t ldc,
+                                                  bool accumulate) {
+    __m512d acc[2][4];
+    for (int i = 0; i < 4; ++i) acc[0][i] = acc[1][i] = _mm512_setzero_pd();
+    int p = 0;
+    for (; p + 1 < kc; p += 2) {
+        const __m512d b0 = _mm512_loadu_pd(bp), b1 = _mm512_loadu_pd(bp + 8);
+#pragma GCC unroll 4
+        for (int i = 0; i < 4; ++i) {
+            acc[0][i] = _mm512_fmadd_pd(_mm512_set1_pd(ap[i]), b0, acc[0][i]);
+            acc[1][i] = _mm512_fmadd_pd(_mm512_set1_pd(ap[4 + i]), b1, acc[1][i]);
+        }
+        ap += 8;
+        bp += 16;
+    }
+    if (p < kc) {
+        const __m512d b0 = _mm512_loadu_pd(bp);
+        for (int i = 0; i < 4; ++i) acc[0][i] = _mm512_fmadd_pd(_mm512_set1_pd(ap[i]), b0, acc[0][i]);
+    }
+    for (int i = 0; i < 4; ++i) {
+        double* ci = c + (size_t)i * ldc;
+        __m512d r = _mm512_add_pd(acc[0][i], acc[1][i]);
+        if (accumulate) r = _mm512_add_pd(_mm512_loadu_pd(ci), r);
+        _mm512_storeu_pd(ci, r);
+    }
+}
+
+// The 4 x 8 float tile is a single 256-bit register per row, so AVX-512 reuses the AVX2 kernel.
+MATRIX_TARGET_AVX512 void microKernelAvx512Float(int kc, const float* ap, const float* bp, float* c, size_t ldc,
+                                                 bool accumulate) {
+    microKernelAvx2Float(kc, ap, bp, c, ldc, accumulate);
+}
+
+// SSE2 has no FMA and only sixteen 128-bit registers, too few for a 4 x 8 double tile, so its
+// microkernel is the generic one, which the compiler already vectorizes for the SSE2 baseline.
+void microKernelSse2Double(int kc, const double* ap, const double* bp, double* c, size_t ldc, bool accumulate) {
+    microKernelGeneric<double>(kc, ap, bp, c, ldc, accumulate);
+}
+
+// As for double: the generic tile is SSE2 code already.
+void microKernelSse2Float(int kc, const float* ap, const float* bp, float* c, size_t ldc, bool accumulate) {
+    microKernelGeneric<float>(kc, ap, bp, c, ldc, accumulate);
+}
+
+// Define the row kernels of one instruction set for one element type, and a function returning
+// their table. Level is the name suffix, V the register traits and S their Scalar type.
+#define MATRIX_SIMD_KERNELS(TARGET, Level, V, S)                                                              \
+    TARGET void add##Level(const S* a, const S* b, S* out, size_t n) { binaryRow<V, Op::Add>(a, b, out, n); }   \
+    TARGET void subtract##Level(const S* a, const S* b, S* out, size_t n) {                                   \
+        binaryRow<V, Op::Subtract>(a, b, out, n);                                                             \
+    }                                                                                                         \
+    TARGET void multiply##Level(const S* a, const S* b, S* out, size_t n) {                                   \
+        binaryRow<V, Op::Multiply>(a, b, out, n);                                                             \
+    }                                                                                                         \
+    TARGET void scale##Level(const S* a, S s, S* out, size_t n) { scalarRow<V, Op::Multiply>(a, s, out, n); } \
+    TARGET void divide##Level(const S* a, S s, S* out, size_t n) { scalarRow<V, Op::Divide>(a, s, out, n); }  \
+    TARGET S sum##Level(const S* a, size_t n) { return sumRow<V>(a, n); }                                     \
+    TARGET void fill##Level(S* out, S value, size_t n) { fillRow<V>(out, value, n); }                         \
+    TARGET void transpose##Level(const S* src, size_t lds, S* dst, size_t ldd, int rows, int cols) {          \
+        transposeRows<V>(src, lds, dst, ldd, rows, cols);                                                     \
+    }                                                                                                         \
+    detail::SimdKernels<S> kernels##Level() {                                                                 \
+        return {add##Level, subtract##Level, multiply##Level, scale##Level, divide##Level,                    \
+                sum##Level, fill##Level, transpose##Level, microKernel##Level};                               \
+    }
+
+MATRIX_SIMD_KERNELS(MATRIX_TARGET_SSE2, Sse2Double, Sse2Double, double)
+MATRIX_SIMD_KERNELS(MATRIX_TARGET_SSE2, Sse2Float, Sse2Float, float)
+MATRIX_SIMD_KERNELS(MATRIX_TARGET_AVX2, Avx2Double, Avx2Double, double)
+MATRIX_SIMD_KERNELS(MATRIX_TARGET_AVX2, Avx2Float, Avx2Float, float)
+MATRIX_SIMD_KERNELS(MATRIX_TARGET_AVX512, Avx512Double, Avx512Double, double)
+MATRIX_SIMD_KERNELS(MATRIX_TARGET_AVX512, Avx512Float, Avx512Float, float)
+
+#undef MATRIX_SIMD_KERNELS
+
+#pragma GCC diagnostic pop
+
+#endif
+
+// Kernel table for a level; element types and builds without vector kernels get the generic table.
+template <typename T>
+detail::SimdKernels<T> kernelsAt(Simd::Level) {
+    return genericKernels<T>();
+}
+
+template <>
+detail::SimdKernels<double> kernelsAt<double>(Simd::Level level) {
+#if MATRIX_SIMD_X86
+    switch (level) {
+        case Simd::Level::AVX512: return kernelsAvx512Double();
+        case Simd::Level::AVX2: return kernelsAvx2Double();
+        case Simd::Level::SSE2: return kernelsSse2Double();
+        case Simd::Level::Generic: break;
+    }
+#endif
+    (void)level;
+    return genericKernels<double>();
+}
+
+template <>
+detail::SimdKernels<float> kernelsAt<float>(Simd::Level level) {
+#if MATRIX_SIMD_X86
+    switch (level) {
+        case Simd::Level::AVX512: return kernelsAvx512Float();
+        case Simd::Level::AVX2: return kernelsAvx2Float();
+        case Simd::Level::SSE2: return kernelsSse2Float();
+        case Simd::Level::Generic: break;
+    }
+#endif
+    (void)level;
+    return genericKernels<float>();
+}
+
+}
+
+// Detect the CPU once, on first use.
+Simd::Level Simd::detected() {
+    static const Level best = detectLevel();
+    return best;
+}
+
+// The overridden level, or the detected one.
+Simd::Level Simd::level() {
+    int current = selectedLevel.load(st::memory_order_relaxed);
+    if (current < 0) {
+        current = (int)detected();
+        int expected = -1;
+        if (!selectedLevel.compare_exchange_strong(expected, current, st::memory_order_relaxed)) {
+            current = expected;
+        }
+    }
+    return (Level)current;
+}
+
+// Override the level; wider than the CPU supports is an error rather than a crash later.
+void Simd::setLevel(Level level) {
+    if ((int)level < (int)Level::Generic || (int)level > (int)detected()) {
+        throw st::invalid_argument("Instruction set not supported by this CPU");
+    }
+    selectedLevel.store((int)level, st::memory_order_relaxed);
+}
+
+// Printable level names.
+const char* Simd::name(Level level) {
+    switch (level) {
+        case Level::Generic: return "Generic";
+        case Level::SSE2: return "SSE2";
+        case Level::AVX2: return "AVX2";
+        case Level::AVX512: return "AVX512";
+    }
+    return "Unknown";
+}
+
+namespace detail {
+
+// One table per level, built on first use.
+template <typename T>
+const SimdKernels<T>& simdKernels() {
+    static const st::array<SimdKernels<T>, 4> tables = {
+        kernelsAt<T>(Simd::Level::Generic), kernelsAt<T>(Simd::Level::SSE2),
+        kernelsAt<T>(Simd::Level::AVX2), kernelsAt<T>(Simd::Level::AVX512)};
+    return tables[(size_t)Simd::level()];
+}
+
+// Explicit instantiations for the supported element types.
+template const SimdKernels<float>& simdKernels<float>();
+template const SimdKernels<double>& simdKernels<double>();
+template const SimdKernels<std::int64_t>& simdKernels<std::int64_t>();
+template const SimdKernels<std::complex<double>>& simdKernels<std::complex<double>>();
+
+}
+
+}
@@ -0,0 +1,98 @@
+// adar101101@gmail.com
+
+#pragma once
+#include <cstddef>
+
+/**
+ * @file Simd.hpp
+ * @brief Runtime selection of the vector instruction set used by the matrix kernels.
+ */
+
+namespace Matrix {
+
+/**
+ * @class Simd
+ * @brief Chooses, once per process, which hand-vectorized kernels the float and double matrices use.
+ *
+ * The library is built for the generic x86-64 target; the SSE2, AVX2+FMA and AVX-512 kernels
+ * are compiled with per-function target attributes and picked at first use from what cpuid
+ * reports, so one binary runs the widest kernels each machine supports. Builds for other
+ * architectures only have the Generic kernels. Element types other than float and double
+ * always use the Generic kernels.
+ */
+class Simd {
+public:
+    /// Instruction sets, from narrowest to widest.
+    enum class Level {
+        Generic,   ///< Portable C++ loops, vectorized only as far as the compiler's target allows.
+        SSE2,      ///< 128-bit kernels.
+        AVX2,      ///< 256-bit kernels with fused multiply-add.
+        AVX512     ///< 512-bit kernels (AVX-512F).
+    };
+
+    /**
+     * @brief Returns the widest level this CPU and build support.
+     * @return Detected level.
+     */
+    static Level detected();
+
+    /**
+     * @brief Returns the level the kernels currently use (detected() unless overridden).
+     * @return Level in use.
+     */
+    static Level level();
+
+    /**
+     * @brief Overrides the level for all threads, e.g. to compare kernels or pin results.
+     * @param level New level.
+     * @throws std::invalid_argument if level is wider than detected().
+     */
+    static void setLevel(Level level);
+
+    /**
+     * @brief Returns a printable name for a level.
+     * @param level Level.
+     * @return "Generic", "SSE2", "AVX2" or "AVX512".
+     */
+    static const char* name(Level level);
+};
+
+namespace detail {
+
+/**
+ * @struct SimdKernels
+ * @brief Row kernels of one instruction set for element type T.
+ *
+ * Pointers need not be aligned. The element-wise kernels allow out to be the same array as an
+ * input; transpose and microKernel require distinct arrays.
+ */
+template <typename T>
+struct SimdKernels {
+    using Binary = void (*)(const T* a, const T* b, T* out, size_t n);
+    using WithScalar = void (*)(const T* a, T scalar, T* out, size_t n);
+
+    Binary add;            ///< out[i] = a[i] + b[i].
+    Binary subtract;       ///< out[i] = a[i] - b[i].
+    Binary multiply;       ///< out[i] = a[i] * b[i].
+    WithScalar scale;      ///< out[i] = a[i] * scalar.
+    WithScalar divide;     ///< out[i] = a[i] / scalar.
+    T (*sum)(const T* a, size_t n);                  ///< Sum of a[0..n), in an order of the kernel's choosing.
+    void (*fill)(T* out, T value, size_t n);         ///< out[i] = value.
+
+    /// dst(j, i) = src(i, j) for a rows x cols block of src.
+    void (*transpose)(const T* src, size_t lds, T* dst, size_t ldd, int rows, int cols);
+
+    /// One full GemmBlocking<T>::MR x NR register tile of C, from packed slivers of depth kc.
+    void (*microKernel)(int kc, const T* ap, const T* bp, T* c, size_t ldc, bool accumulate);
+};
+
+/**
+ * @brief Returns the kernels of the current Simd::level() for T.
+ * @return Kernel table, valid for the life of the process.
+ */
+template <typename T>
+const SimdKernels<T>& simdKernels();
+
+}
+
+}
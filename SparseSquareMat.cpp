@@ -0,0 +1,316 @@
+// adar101101@gmail.com
+
+#include <stdexcept>
+#include <algorithm>
+#include <string>
+#include <complex>
+#include <cstdint>
+#include "SparseSquareMat.hpp"
+
+namespace st = std;
+
+namespace Matrix {
+
+namespace {
+
+// Throw if two operands differ in size; what names the operation for the message.
+void requireSameSize(int left, int right, const char* what) {
+    if (left != right) {
+        throw st::invalid_argument(st::string("Matrices must have the same dimensions for ") + what);
+    }
+}
+
+}
+
+// Constructor: all-zero matrix, every row empty.
+template <typename T>
+BasicSparseSquareMat<T>::BasicSparseSquareMat(int size) {
+    if (size <= 0) {
+        throw st::invalid_argument("Matrix dimensions must be positive");
+    }
+    n = size;
+    rowStart.assign((size_t)size + 1, 0);
+}
+
+// Triplet constructor: sort by position, then merge duplicates and drop zeros.
+template <typename T>
+BasicSparseSquareMat<T>::BasicSparseSquareMat(int size, st::vector<Entry> entries) : BasicSparseSquareMat(size) {
+    for (const Entry& e : entries) {
+        if (e.row < 0 || e.row >= n || e.col < 0 || e.col >= n) {
+            throw st::out_of_range("Index out of range of matrix");
+        }
+    }
+    st::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+        return a.row != b.row ? a.row < b.row : a.col < b.col;
+    });
+    colIndex.reserve(entries.size());
+    values.reserve(entries.size());
+    for (size_t i = 0; i < entries.size();) {
+        const int row = entries[i].row;
+        const int col = entries[i].col;
+        T sum = T(0);
+        for (; i < entries.size() && entries[i].row == row && entries[i].col == col; ++i) {
+            sum += entries[i].value;
+        }
+        if (sum != T(0)) {
+            colIndex.push_back(col);
+            values.push_back(sum);
+            ++rowStart[row + 1];
+        }
+    }
+    for (int i = 0; i < n; ++i) rowStart[i + 1] += rowStart[i];
+}
+
+// Dense constructor: keep the non-zero elements, row by row.
+template <typename T>
+BasicSparseSquareMat<T>::BasicSparseSquareMat(const BasicConstMatrixView<T>& dense) : BasicSparseSquareMat(dense.getRows()) {
+    for (int i = 0; i < n; ++i) {
+        const T* row = dense[i];
+        for (int j = 0; j < n; ++j) {
+            if (row[j] != T(0)) {
+                colIndex.push_back(j);
+                values.push_back(row[j]);
+            }
+        }
+        rowStart[i + 1] = (int)colIndex.size();
+    }
+}
+
+// Access element at (row, col) with bounds checking: binary search within the row.
+template <typename T>
+T BasicSparseSquareMat<T>::operator()(int row, int col) const {
+    if (row < 0 || row >= n || col < 0 || col >= n) {
+        throw st::out_of_range("Index out of range of matrix");
+    }
+    auto first = colIndex.begin() + rowStart[row];
+    auto last = colIndex.begin() + rowStart[row + 1];
+    auto it = st::lower_bound(first, last, col);
+    if (it == last || *it != col) return T(0);
+    return values[it - colIndex.begin()];
+}
+
+// Get number of rows in the matrix.
+template <typename T>
+int BasicSparseSquareMat<T>::getRows() const { return n; }
+
+// Get number of columns in the matrix.
+template <typename T>
+int BasicSparseSquareMat<T>::getCols() const { return n; }
+
+// Get number of stored elements.
+template <typename T>
+size_t BasicSparseSquareMat<T>::nonZeros() const { return values.size(); }
+
+// Calculate sum of all elements: only the stored ones contribute.
+template <typename T>
+T BasicSparseSquareMat<T>::countSum() const {
+    T sum = T(0);
+    for (const T& value : values) sum += value;
+    return sum;
+}
+
+// Scatter the stored elements into a zeroed dense matrix.
+template <typename T>
+BasicSquareMat<T> BasicSparseSquareMat<T>::toDense() const {
+    BasicSquareMat<T> result(n, n);
+    for (int i = 0; i < n; ++i) {
+        T* out = result[i];
+        for (int p = rowStart[i]; p < rowStart[i + 1]; ++p) {
+            out[colIndex[p]] = values[p];
+        }
+    }
+    return result;
+}
+
+// Compare matrices for equality: with no explicit zeros stored, equal matrices have equal arrays.
+template <typename T>
+bool BasicSparseSquareMat<T>::operator==(const BasicSparseSquareMat& other) const {
+    return n == other.n && rowStart == other.rowStart && colIndex == other.colIndex && values == other.values;
+}
+
+// Compare matrices for inequality.
+template <typename T>
+bool BasicSparseSquareMat<T>::operator!=(const BasicSparseSquareMat& other) const {
+    return !(*this == other);
+}
+
+// Matrix exponentiation by squaring, staying sparse throughout.
+template <typename T>
+BasicSparseSquareMat<T> BasicSparseSquareMat<T>::operator^(long long power) const {
+    if (power < 0) {
+        throw st::invalid_argument("Negative exponents are not supported for matrices");
+    }
+    BasicSparseSquareMat result(n);
+    for (int i = 0; i < n; ++i) {
+        result.colIndex.push_back(i);
+        result.values.push_back(T(1));
+        result.rowStart[i + 1] = i + 1;
+    }
+    BasicSparseSquareMat base(*this);
+    while (power > 0) {
+        if (power & 1) result = multiply(result, base);
+        power >>= 1;
+        if (power > 0) base = multiply(base, base);
+    }
+    return result;
+}
+
+// Sparse times dense: each stored a(i, k) adds a(i, k) * row k of right to row i.
+template <typename T>
+BasicSquareMat<T> BasicSparseSquareMat<T>::multiplyDense(const BasicSparseSquareMat& left, const BasicConstMatrixView<T>& right) {
+    requireSameSize(left.n, right.getRows(), "multiplication");
+    const int n = left.n;
+    BasicSquareMat<T> result(n, n);
+    for (int i = 0; i < n; ++i) {
+        T* out = result[i];
+        for (int p = left.rowStart[i]; p < left.rowStart[i + 1]; ++p) {
+            const T aik = left.values[p];
+            const T* b = right[left.colIndex[p]];
+            for (int j = 0; j < n; ++j) {
+                out[j] += aik * b[j];
+            }
+        }
+    }
+    return result;
+}
+
+// Dense times sparse: each a(i, k) scatters a(i, k) * row k of right into row i.
+template <typename T>
+BasicSquareMat<T> BasicSparseSquareMat<T>::multiplyDense(const BasicConstMatrixView<T>& left, const BasicSparseSquareMat& right) {
+    requireSameSize(left.getRows(), right.n, "multiplication");
+    const int n = right.n;
+    BasicSquareMat<T> result(n, n);
+    for (int i = 0; i < n; ++i) {
+        const T* a = left[i];
+        T* out = result[i];
+        for (int k = 0; k < n; ++k) {
+            const T aik = a[k];
+            if (aik == T(0)) continue;
+            for (int p = right.rowStart[k]; p < right.rowStart[k + 1]; ++p) {
+                out[right.colIndex[p]] += aik * right.values[p];
+            }
+        }
+    }
+    return result;
+}
+
+// Sparse times sparse (Gustavson): accumulate each result row in a dense scratch row,
+// remembering which columns were touched so clearing it costs only the row's non-zeros.
+template <typename T>
+BasicSparseSquareMat<T> BasicSparseSquareMat<T>::multiply(const BasicSparseSquareMat& left, const BasicSparseSquareMat& right) {
+    requireSameSize(left.n, right.n, "multiplication");
+    const int n = left.n;
+    BasicSparseSquareMat result(n);
+    st::vector<T> accumulator(n, T(0));
+    st::vector<char> touched(n, 0);
+    st::vector<int> columns;
+    for (int i = 0; i < n; ++i) {
+        columns.clear();
+        for (int p = left.rowStart[i]; p < left.rowStart[i + 1]; ++p) {
+            const T aik = left.values[p];
+            const int k = left.colIndex[p];
+            for (int q = right.rowStart[k]; q < right.rowStart[k + 1]; ++q) {
+                const int j = right.colIndex[q];
+                if (!touched[j]) {
+                    touched[j] = 1;
+                    columns.push_back(j);
+                }
+                accumulator[j] += aik * right.values[q];
+            }
+        }
+        st::sort(columns.begin(), columns.end());
+        for (int j : columns) {
+            if (accumulator[j] != T(0)) {
+                result.colIndex.push_back(j);
+                result.values.push_back(accumulator[j]);
+            }
+            accumulator[j] = T(0);
+            touched[j] = 0;
+        }
+        result.rowStart[i + 1] = (int)result.colIndex.size();
+    }
+    return result;
+}
+
+// Multiply each stored element by a scalar; a zero scalar leaves an empty matrix.
+template <typename T>
+BasicSparseSquareMat<T> BasicSparseSquareMat<T>::scale(const BasicSparseSquareMat& mat, T scalar) {
+    if (scalar == T(0)) return BasicSparseSquareMat(mat.n);
+    BasicSparseSquareMat result(mat);
+    for (T& value : result.values) value *= scalar;
+    return result;
+}
+
+// Element-wise product of two sparse matrices: merge the sorted columns of each row pair.
+template <typename T>
+BasicSparseSquareMat<T> BasicSparseSquareMat<T>::hadamard(const BasicSparseSquareMat& left, const BasicSparseSquareMat& right) {
+    requireSameSize(left.n, right.n, "element-wise multiplication");
+    BasicSparseSquareMat result(left.n);
+    for (int i = 0; i < left.n; ++i) {
+        int p = left.rowStart[i];
+        int q = right.rowStart[i];
+        while (p < left.rowStart[i + 1] && q < right.rowStart[i + 1]) {
+            if (left.colIndex[p] < right.colIndex[q]) {
+                ++p;
+            } else if (right.colIndex[q] < left.colIndex[p]) {
+                ++q;
+            } else {
+                const T product = left.values[p] * right.values[q];
+                if (product != T(0)) {
+                    result.colIndex.push_back(left.colIndex[p]);
+                    result.values.push_back(product);
+                }
+                ++p;
+                ++q;
+            }
+        }
+        result.rowStart[i + 1] = (int)result.colIndex.size();
+    }
+    return result;
+}
+
+// Element-wise product with a dense matrix: only left's stored positions can be non-zero.
+template <typename T>
+BasicSparseSquareMat<T> BasicSparseSquareMat<T>::hadamard(const BasicSparseSquareMat& left, const BasicConstMatrixView<T>& right) {
+    requireSameSize(left.n, right.getRows(), "element-wise multiplication");
+    BasicSparseSquareMat result(left.n);
+    for (int i = 0; i < left.n; ++i) {
+        const T* b = right[i];
+        for (int p = left.rowStart[i]; p < left.rowStart[i + 1]; ++p) {
+            const T product = left.values[p] * b[left.colIndex[p]];
+            if (product != T(0)) {
+                result.colIndex.push_back(left.colIndex[p]);
+                result.values.push_back(product);
+            }
+        }
+        result.rowStart[i + 1] = (int)result.colIndex.size();
+    }
+    return result;
+}
+
+// Transpose by counting sort on the column indices; rows of the result come out sorted.
+template <typename T>
+BasicSparseSquareMat<T> BasicSparseSquareMat<T>::transpose(const BasicSparseSquareMat& mat) {
+    BasicSparseSquareMat result(mat.n);
+    for (int col : mat.colIndex) ++result.rowStart[col + 1];
+    for (int i = 0; i < mat.n; ++i) result.rowStart[i + 1] += result.rowStart[i];
+    result.colIndex.resize(mat.colIndex.size());
+    result.values.resize(mat.values.size());
+    st::vector<int> next(result.rowStart.begin(), result.rowStart.end() - 1);
+    for (int i = 0; i < mat.n; ++i) {
+        for (int p = mat.rowStart[i]; p < mat.rowStart[i + 1]; ++p) {
+            const int slot = next[mat.colIndex[p]]++;
+            result.colIndex[slot] = i;
+            result.values[slot] = mat.values[p];
+        }
+    }
+    return result;
+}
+
+// Explicit instantiations for the supported element types.
+template class BasicSparseSquareMat<float>;
+template class BasicSparseSquareMat<double>;
+template class BasicSparseSquareMat<std::int64_t>;
+template class BasicSparseSquareMat<std::complex<double>>;
+
+}
@@ -0,0 +1,240 @@
+// adar101101@gmail.com
+
+#pragma once
+#include <complex>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+#include "SquareMat.hpp"
+
+/**
+ * @file SparseSquareMat.hpp
+ * @brief Declaration of the BasicSparseSquareMat class, a square matrix in compressed sparse row format.
+ */
+
+namespace Matrix {
+
+/**
+ * @class BasicSparseSquareMat
+ * @brief Square matrix of T that stores only its non-zero elements, in CSR (compressed sparse row) format.
+ *
+ * Memory and the cost of every operation grow with the number of non-zeros rather than with n²,
+ * so graphs with tens of thousands of nodes fit where a dense SquareMat would not. Products with
+ * dense matrices (and views) return a SquareMat; products of two sparse matrices stay sparse.
+ * Explicit zeros are never stored.
+ *
+ * The member definitions live in SparseSquareMat.cpp and are explicitly instantiated for the same
+ * element types as BasicSquareMat.
+ * @tparam T Element type.
+ */
+template <typename T>
+class BasicSparseSquareMat {
+public:
+    /// One element given to the triplet constructor.
+    struct Entry {
+        int row;
+        int col;
+        T value;
+    };
+
+private:
+    int n;                        ///< Number of rows and columns.
+    std::vector<int> rowStart;    ///< Row i's elements are [rowStart[i], rowStart[i + 1]) of colIndex and values.
+    std::vector<int> colIndex;    ///< Column of each non-zero, ascending within a row.
+    std::vector<T> values;        ///< Value of each non-zero.
+
+    // Kernels behind the non-member operators.
+    static BasicSquareMat<T> multiplyDense(const BasicSparseSquareMat& left, const BasicConstMatrixView<T>& right);
+    static BasicSquareMat<T> multiplyDense(const BasicConstMatrixView<T>& left, const BasicSparseSquareMat& right);
+    static BasicSparseSquareMat multiply(const BasicSparseSquareMat& left, const BasicSparseSquareMat& right);
+    static BasicSparseSquareMat scale(const BasicSparseSquareMat& mat, T scalar);
+    static BasicSparseSquareMat hadamard(const BasicSparseSquareMat& left, const BasicSparseSquareMat& right);
+    static BasicSparseSquareMat hadamard(const BasicSparseSquareMat& left, const BasicConstMatrixView<T>& right);
+    static BasicSparseSquareMat transpose(const BasicSparseSquareMat& mat);
+
+public:
+    //
+    // Constructors
+    //
+
+    /**
+     * @brief Constructs an all-zero sparse matrix.
+     * @param size Number of rows and columns.
+     * @throws std::invalid_argument if size <= 0.
+     */
+    explicit BasicSparseSquareMat(int size);
+
+    /**
+     * @brief Constructs a sparse matrix from (row, col, value) triplets in any order.
+     *
+     * Entries at the same position are summed; entries that are (or sum to) zero are dropped.
+     * @param size Number of rows and columns.
+     * @param entries Non-zero elements.
+     * @throws std::invalid_argument if size <= 0.
+     * @throws std::out_of_range if an entry lies outside the matrix.
+     */
+    BasicSparseSquareMat(int size, std::vector<Entry> entries);
+
+    /**
+     * @brief Converts a dense matrix (or view) to sparse form, keeping its non-zero elements.
+     * @param dense Matrix to convert.
+     */
+    explicit BasicSparseSquareMat(const BasicConstMatrixView<T>& dense);
+
+    //
+    // Element Access
+    //
+
+    /**
+     * @brief Returns the element at (row, col); absent elements are zero.
+     * @param row Rows number.
+     * @param col Columns number.
+     * @return Element value.
+     * @throws std::out_of_range if the index is outside the matrix.
+     */
+    T operator()(int row, int col) const;
+
+    //
+    // Utilities
+    //
+
+    /**
+     * @brief Returns the number of rows.
+     * @return Number of rows.
+     */
+    int getRows() const;
+
+    /**
+     * @brief Returns the number of columns.
+     * @return Number of columns.
+     */
+    int getCols() const;
+
+    /**
+     * @brief Returns the number of stored (non-zero) elements.
+     * @return Number of non-zeros.
+     */
+    size_t nonZeros() const;
+
+    /**
+     * @brief Returns the sum of all elements in the matrix.
+     * @return Sum of elements.
+     */
+    T countSum() const;
+
+    /**
+     * @brief Converts to a dense matrix.
+     * @return Dense copy of this matrix.
+     */
+    BasicSquareMat<T> toDense() const;
+
+    /**
+     * @brief Checks if two sparse matrices are equal (same size and same elements).
+     * @param other Matrix to compare.
+     * @return True if equal.
+     */
+    bool operator==(const BasicSparseSquareMat& other) const;
+
+    /**
+     * @brief Checks if two sparse matrices are not equal.
+     * @param other Matrix to compare.
+     * @return True if not equal.
+     */
+    bool operator!=(const BasicSparseSquareMat& other) const;
+
+    /**
+     * @brief Raises the matrix to an integer non-negative power, staying sparse.
+     * @param power Exponent.
+     * @return Matrix raised to the given power (the identity for power 0).
+     * @throws std::invalid_argument if power < 0.
+     */
+    BasicSparseSquareMat operator^(long long power) const;
+
+    //
+    // Friend Non-member Operators
+    //
+
+    /**
+     * @brief Multiplies a sparse matrix by a dense matrix or view.
+     * @param left Sparse operand.
+     * @param right Dense operand.
+     * @return New dense matrix containing the product.
+     */
+    friend BasicSquareMat<T> operator*(const BasicSparseSquareMat& left, const BasicConstMatrixView<T>& right) { return multiplyDense(left, right); }
+
+    /**
+     * @brief Multiplies a dense matrix or view by a sparse matrix.
+     * @param left Dense operand.
+     * @param right Sparse operand.
+     * @return New dense matrix containing the product.
+     */
+    friend BasicSquareMat<T> operator*(const BasicConstMatrixView<T>& left, const BasicSparseSquareMat& right) { return multiplyDense(left, right); }
+
+    /**
+     * @brief Multiplies two sparse matrices.
+     * @param left Left operand.
+     * @param right Right operand.
+     * @return New sparse matrix containing the product.
+     */
+    friend BasicSparseSquareMat operator*(const BasicSparseSquareMat& left, const BasicSparseSquareMat& right) { return multiply(left, right); }
+
+    /**
+     * @brief Multiplies each stored element by a scalar.
+     * @param mat Matrix operand.
+     * @param scalar Scalar operand.
+     * @return New sparse matrix with elements scaled.
+     */
+    friend BasicSparseSquareMat operator*(const BasicSparseSquareMat& mat, T scalar) { return scale(mat, scalar); }
+
+    /**
+     * @brief Multiplies each stored element by a scalar (scalar on left).
+     * @param scalar Scalar operand.
+     * @param mat Matrix operand.
+     * @return New sparse matrix with elements scaled.
+     */
+    friend BasicSparseSquareMat operator*(T scalar, const BasicSparseSquareMat& mat) { return scale(mat, scalar); }
+
+    /**
+     * @brief Element-wise multiplication of two sparse matrices.
+     * @param left Left operand.
+     * @param right Right operand.
+     * @return New sparse matrix with element-wise products.
+     */
+    friend BasicSparseSquareMat operator%(const BasicSparseSquareMat& left, const BasicSparseSquareMat& right) { return hadamard(left, right); }
+
+    /**
+     * @brief Element-wise multiplication with a dense matrix or view; the result is as sparse as left.
+     * @param left Sparse operand.
+     * @param right Dense operand.
+     * @return New sparse matrix with element-wise products.
+     */
+    friend BasicSparseSquareMat operator%(const BasicSparseSquareMat& left, const BasicConstMatrixView<T>& right) { return hadamard(left, right); }
+
+    /**
+     * @brief Element-wise multiplication with a dense matrix or view (dense on left).
+     * @param left Dense operand.
+     * @param right Sparse operand.
+     * @return New sparse matrix with element-wise products.
+     */
+    friend BasicSparseSquareMat operator%(const BasicConstMatrixView<T>& left, const BasicSparseSquareMat& right) { return hadamard(right, left); }
+
+    /**
+     * @brief Returns the transpose of the matrix.
+     * @param mat Matrix to transpose.
+     * @return Transposed sparse matrix.
+     */
+    friend BasicSparseSquareMat operator~(const BasicSparseSquareMat& mat) { return transpose(mat); }
+};
+
+/// Sparse matrix of doubles.
+using SparseSquareMat = BasicSparseSquareMat<double>;
+
+/// Exact sparse integer matrix, e.g. adjacency matrices for path counting.
+using SparseSquareMatI64 = BasicSparseSquareMat<std::int64_t>;
+
+extern template class BasicSparseSquareMat<float>;
+extern template class BasicSparseSquareMat<double>;
+extern template class BasicSparseSquareMat<std::int64_t>;
+extern template class BasicSparseSquareMat<std::complex<double>>;
+
+}
@@ -3,200 +3,669 @@
 #include <stdexcept>
 #include <iostream>
 #include <cmath>
+#include <algorithm>
+#include <atomic>
+#include <string>
+#include <new>
+#include <complex>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <type_traits>
+#include <vector>
 #include "SquareMat.hpp"
+#include "Parallel.hpp"
+#include "Gemm.hpp"
+#include "Simd.hpp"
+#include "Strassen.hpp"
 
 namespace st = std;
 
 namespace Matrix {
 
+using detail::IsComplex;
+
+namespace {
+
+// Throw if two matrices or views differ in size; what names the operation for the message.
+template <typename T>
+void requireSameSize(const BasicConstMatrixView<T>& left, const BasicConstMatrixView<T>& right, const char* what) {
+    if (left.getRows() != right.getRows() || left.getCols() != right.getCols()) {
+        throw st::invalid_argument(st::string("Matrices must have the same dimensions for ") + what);
+    }
+}
+
+// Run body(begin, end) over the rows of an element-wise kernel: split across the Parallel
+// workers when the block is at least Parallel::threshold() elements, on this thread otherwise.
+template <typename Body>
+void forEachRowBlock(int rows, int cols, Body body) {
+    if ((size_t)rows * cols >= Parallel::threshold()) {
+        Parallel::forRows(rows, body);
+    } else {
+        body(0, rows);
+    }
+}
+
+// out(i, j) = a(i, j) op b(i, j), row by row, through an element-wise kernel of
+// detail::simdKernels. out may be the same block as a or b.
+template <typename T>
+void zipRows(const BasicMatrixView<T>& out, const BasicConstMatrixView<T>& a, const BasicConstMatrixView<T>& b,
+             typename detail::SimdKernels<T>::Binary kernel) {
+    const int n = out.getCols();
+    forEachRowBlock(out.getRows(), n, [&](int begin, int end) {
+        for (int i = begin; i < end; ++i) {
+            kernel(a.getData() + (size_t)i * a.getStride(), b.getData() + (size_t)i * b.getStride(),
+                   out.getData() + (size_t)i * out.getStride(), (size_t)n);
+        }
+    });
+}
+
+// out(i, j) = a(i, j) op scalar, row by row, through a scalar kernel of detail::simdKernels.
+// out may be the same block as a.
+template <typename T>
+void scaleRows(const BasicMatrixView<T>& out, const BasicConstMatrixView<T>& a, T scalar,
+               typename detail::SimdKernels<T>::WithScalar kernel) {
+    const int n = out.getCols();
+    forEachRowBlock(out.getRows(), n, [&](int begin, int end) {
+        for (int i = begin; i < end; ++i) {
+            kernel(a.getData() + (size_t)i * a.getStride(), scalar, out.getData() + (size_t)i * out.getStride(),
+                   (size_t)n);
+        }
+    });
+}
+
+// out(i, j) = f(a(i, j)), row by row. out may be the same block as a.
+template <typename T, typename F>
+void mapRows(const BasicMatrixView<T>& out, const BasicConstMatrixView<T>& a, F f) {
+    const int n = out.getCols();
+    forEachRowBlock(out.getRows(), n, [&](int begin, int end) {
+        for (int i = begin; i < end; ++i) {
+            const T* x = a.getData() + (size_t)i * a.getStride();
+            T* z = out.getData() + (size_t)i * out.getStride();
+            for (int j = 0; j < n; ++j) {
+                z[j] = f(x[j]);
+            }
+        }
+    });
+}
+
+#ifdef MATRIX_DEBUG_UNINITIALIZED
+// Value written into uninitialized matrices in debug builds: NaN, or the smallest integer.
+template <typename T>
+T poisonValue() {
+    if constexpr (IsComplex<T>::value) {
+        const typename T::value_type nan = st::numeric_limits<typename T::value_type>::quiet_NaN();
+        return T(nan, nan);
+    } else if constexpr (st::numeric_limits<T>::has_quiet_NaN) {
+        return st::numeric_limits<T>::quiet_NaN();
+    } else {
+        return st::numeric_limits<T>::lowest();
+    }
+}
+#endif
+
+// Check a scalar modulo up front: complex elements and a zero divisor are rejected.
+template <typename T>
+void requireModulo(int scalar) {
+    if constexpr (IsComplex<T>::value) {
+        throw st::invalid_argument("Modulo is not defined for complex matrices");
+    }
+    if (scalar == 0) {
+        throw st::invalid_argument("Modulo by zero");
+    }
+}
+
+// One element modulo a scalar: fmod for floating point, % for integers.
+template <typename T>
+T modElement(T value, int scalar) {
+    if constexpr (st::is_integral<T>::value) {
+        return value % scalar;
+    } else if constexpr (IsComplex<T>::value) {
+        return value;
+    } else {
+        return st::fmod(value, scalar);
+    }
+}
+
+}
+
+// Compute the padded row stride: whole cache lines, never a power of two of a line or more.
+template <typename T>
+int BasicSquareMat<T>::leadingDimension(int columns) {
+    if (columns <= INLINE_DIM) return columns;
+    const int perLine = (int)(ALIGNMENT / sizeof(T));
+    int ld = (columns + perLine - 1) / perLine * perLine;
+    if (ld >= perLine * 8 && (ld & (ld - 1)) == 0) {
+        ld += perLine;
+    }
+    return ld;
+}
+
+// Allocate one contiguous row-major buffer: inline for tiny matrices, otherwise cache-line aligned
+// from the matrix's arena or the heap (through the BufferPool when enabled).
+template <typename T>
+void BasicSquareMat<T>::allocateStorage(bool zero) {
+    size_t count = (size_t)rows * stride;
+    if (count <= sizeof(local) / sizeof(T)) {
+        data = local;
+    } else if (arena) {
+        data = static_cast<T*>(arena->acquire(count * sizeof(T)));
+    } else {
+        data = static_cast<T*>(detail::allocateBuffer(count * sizeof(T)));
+        if (count * sizeof(T) >= NumaPlacement::threshold()) {
+            detail::placeBuffer(data, count * sizeof(T));
+            if (NumaPlacement::mode() == NumaPlacement::Mode::FirstTouch) {
+                firstTouch(zero);
+                return;
+            }
+        }
+    }
+    if (zero) st::fill(data, data + count, T(0));
+}
+
+// Touch each block of rows from the Parallel worker that owns it in row-parallel kernels, so
+// the kernel places its pages on that worker's node: zero it, or if the caller is about to
+// overwrite every element, write one element per page.
+template <typename T>
+void BasicSquareMat<T>::firstTouch(bool zero) {
+    const size_t perPage = st::max<size_t>(1, 4096 / sizeof(T));
+    T* const base = data;
+    const int rowStride = stride;
+    Parallel::forRows(rows, [=](int begin, int end) {
+        T* first = base + (size_t)begin * rowStride;
+        T* last = base + (size_t)end * rowStride;
+        if (zero) {
+            st::fill(first, last, T(0));
+        } else {
+            for (T* p = first; p < last; p += perPage) *p = T(0);
+        }
+    });
+}
+
+// Free the element buffer and reset the matrix to the empty state. Arena buffers are only
+// handed back to their scope's count, and reclaimed when the scope ends; heap buffers may be parked in the BufferPool. A shared
+// buffer is only freed by its last owner, external ones through their deleter.
+template <typename T>
+void BasicSquareMat<T>::freeStorage() noexcept {
+    if (shared) {
+        if (shared->owners.fetch_sub(1, st::memory_order_acq_rel) == 1) {
+            if (shared->deleter) shared->deleter(data);
+            else detail::freeBuffer(data, (size_t)rows * stride * sizeof(T));
+            delete shared;
+        }
+        shared = nullptr;
+    } else if (data && !isInline()) {
+        if (arena) arena->release(data);
+        else detail::freeBuffer(data, (size_t)rows * stride * sizeof(T));
+    }
+    data = nullptr;
+}
+
+// Take over other's storage: inline elements are copied, heap buffers change hands.
+template <typename T>
+void BasicSquareMat<T>::takeStorage(BasicSquareMat& other) noexcept {
+    arena = other.arena;
+    shared = other.shared;
+    rows = other.rows;
+    columns = other.columns;
+    stride = other.stride;
+    size = other.size;
+    if (other.isInline()) {
+        st::copy(other.local, other.local + (size_t)rows * stride, local);
+        data = local;
+    } else {
+        data = other.data;
+    }
+    other.data = nullptr;
+    other.shared = nullptr;
+    other.rows = 0;
+    other.columns = 0;
+    other.stride = 0;
+    other.size = 0;
+}
+
+// Share other's copy-on-write buffer. Only heap matrices share: a matrix built inside an
+// ArenaScope gets its own arena copy, since the arena may not outlive the original.
+template <typename T>
+bool BasicSquareMat<T>::shareStorage(const BasicSquareMat& other) noexcept {
+    if (!other.isCopyOnWrite() || arena) return false;
+    rows = other.rows;
+    columns = other.columns;
+    stride = other.stride;
+    size = other.size;
+    data = other.data;
+    shared = other.shared;
+    shared->owners.fetch_add(1, st::memory_order_relaxed);
+    return true;
+}
+
+// Copy a shared buffer before the first write, leaving the other owners on the original. The
+// copy comes from allocateStorage, so it gets the same NUMA placement as a new matrix; a copy
+// small enough for inline storage needs no reference count.
+template <typename T>
+void BasicSquareMat<T>::unshare() {
+    if (shared->owners.load(st::memory_order_acquire) == 1) return;
+    T* const source = data;
+    detail::SharedBuffer* own = new detail::SharedBuffer;
+    try {
+        allocateStorage(false);
+    } catch (...) {
+        data = source;
+        delete own;
+        throw;
+    }
+    T* const copy = data;
+    st::copy(source, source + extent(), copy);
+    data = source;
+    freeStorage();
+    data = copy;
+    if (isInline()) {
+        delete own;
+    } else {
+        shared = own;
+    }
+}
+
 // Constructor: create a square matrix with given size, initializing all elements to zero.
 
-SquareMat::SquareMat(int rows, int columns) {
+template <typename T>
+BasicSquareMat<T>::BasicSquareMat(int rows, int columns)
+    : BasicSquareMat(rows, columns, columns > 0 ? leadingDimension(columns) : columns) {}
+
+// Constructor with explicit leading dimension: rows start stride elements apart.
+template <typename T>
+BasicSquareMat<T>::BasicSquareMat(int rows, int columns, int stride) {
     if (rows != columns) {
         throw st::invalid_argument("Matrix must be square");
     }
     if (rows <= 0 || columns <= 0) {
         throw st::invalid_argument("Matrix dimensions must be positive");
     }
+    if (stride < columns) {
+        throw st::invalid_argument("Stride must be at least the number of columns");
+    }
     this->rows = rows;
     this->columns = columns;
-    this->size = rows * columns;
-    data = new double*[rows];
-    for (int i = 0; i < rows; ++i) {
-        data[i] = new double[columns]();
-    }
+    this->stride = stride;
+    this->size = (size_t)rows * columns;
+    this->arena = ArenaScope::current();
+    this->shared = nullptr;
+    allocateStorage(true);
 
 }
 
-// Copy constructor: deep copy of another SquareMat.
-SquareMat::SquareMat(const SquareMat& other) {
+// Uninitialized constructor: allocate without zeroing. Only the padding past each row is
+// zeroed, so bulk copies over extent() never read unwritten memory.
+template <typename T>
+BasicSquareMat<T>::BasicSquareMat(int size, Uninitialized) {
+    if (size <= 0) {
+        throw st::invalid_argument("Matrix dimensions must be positive");
+    }
+    rows = size;
+    columns = size;
+    stride = leadingDimension(size);
+    this->size = (size_t)size * size;
+    arena = ArenaScope::current();
+    shared = nullptr;
+    allocateStorage(false);
+#ifdef MATRIX_DEBUG_UNINITIALIZED
+    st::fill(data, data + (size_t)rows * stride, poisonValue<T>());
+#endif
+    if (stride > columns) {
+        for (int i = 0; i < rows; ++i) {
+            st::fill(data + (size_t)i * stride + columns, data + (size_t)(i + 1) * stride, T(0));
+        }
+    }
+}
+
+// Copy constructor: deep copy of another SquareMat in one bulk copy, keeping its stride.
+// A copy-on-write matrix is shared instead.
+template <typename T>
+BasicSquareMat<T>::BasicSquareMat(const BasicSquareMat& other) {
+    arena = ArenaScope::current();
+    shared = nullptr;
+    if (shareStorage(other)) return;
     rows = other.rows;
     columns = other.columns;
+    stride = other.isExternal() ? leadingDimension(columns) : other.stride;
     size = other.size;
-    data = new double*[rows];
-    for (int i = 0; i < rows; ++i) {
-        data[i] = new double[columns];
-        for (int j = 0; j < columns; ++j) {
-            data[i][j] = other.data[i][j];
+    data = nullptr;
+    if (size == 0) return;
+    allocateStorage(false);
+    if (stride == other.stride) {
+        st::copy(other.data, other.data + other.extent(), data);
+    } else {
+        for (int i = 0; i < rows; ++i) {
+            st::copy(other[i], other[i] + columns, data + (size_t)i * stride);
         }
     }
 }
 
-// Move constructor: transfer ownership from another SquareMat (rvalue).
-SquareMat::SquareMat(SquareMat&& other) noexcept
-    : rows(other.rows), columns(other.columns), data(other.data), size(other.size) {
-    other.data = nullptr;
-    other.rows = 0;
-    other.columns = 0;
-    other.size = 0;
+// External buffer constructor: refer to the caller's elements, freeing them through deleter.
+template <typename T>
+BasicSquareMat<T>::BasicSquareMat(T* external, int size, int stride, st::function<void(void*)> deleter) {
+    if (external == nullptr) {
+        throw st::invalid_argument("Buffer must not be null");
+    }
+    if (size <= 0) {
+        throw st::invalid_argument("Matrix dimensions must be positive");
+    }
+    if (stride < size) {
+        throw st::invalid_argument("Stride must be at least the number of columns");
+    }
+    shared = new detail::SharedBuffer;
+    shared->copyOnWrite = false;
+    shared->deleter = st::move(deleter);
+    rows = size;
+    columns = size;
+    this->stride = stride;
+    this->size = (size_t)size * size;
+    arena = nullptr;
+    data = external;
+}
+
+// Identity matrix: the constructor already zeroed the buffer, so only the diagonal is written.
+template <typename T>
+BasicSquareMat<T> BasicSquareMat<T>::identity(int size) {
+    BasicSquareMat result(size, size);
+    for (int i = 0; i < size; ++i) {
+        result.data[(size_t)i * result.stride + i] = T(1);
+    }
+    return result;
 }
 
-// Move assignment operator: transfer ownership from another SquareMat (rvalue).
-SquareMat& SquareMat::operator=(SquareMat&& other) noexcept {
+// Wrap a caller-owned buffer: the deleter does nothing.
+template <typename T>
+BasicSquareMat<T> BasicSquareMat<T>::borrow(T* data, int size, int stride) {
+    return BasicSquareMat(data, size, stride, [](void*) {});
+}
+
+// Take ownership of a caller-allocated buffer.
+template <typename T>
+BasicSquareMat<T> BasicSquareMat<T>::adopt(T* data, int size, int stride, st::function<void(T*)> deleter) {
+    if (!deleter) {
+        throw st::invalid_argument("Deleter must not be empty");
+    }
+    return BasicSquareMat(data, size, stride, [deleter](void* buffer) { deleter(static_cast<T*>(buffer)); });
+}
+
+// Hand the buffer out with the deleter that frees it, leaving the matrix empty.
+template <typename T>
+typename BasicSquareMat<T>::Buffer BasicSquareMat<T>::release() {
+    if (data == nullptr) return Buffer(nullptr, [](T*) {});
+    detach();
+    const size_t bytes = (size_t)rows * stride * sizeof(T);
+    Buffer out(nullptr, [](T*) {});
+    if (isExternal()) {
+        st::function<void(void*)> deleter = st::move(shared->deleter);
+        out = Buffer(data, [deleter](T* buffer) { deleter(buffer); });
+    } else if (!isInline() && !arena) {
+        out = Buffer(data, [bytes](T* buffer) { detail::freeBuffer(buffer, bytes); });
+    } else if (isInline()) {
+        T* copy = static_cast<T*>(detail::allocateBuffer(bytes));
+        st::copy(data, data + extent(), copy);
+        out = Buffer(copy, [bytes](T* buffer) { detail::freeBuffer(buffer, bytes); });
+    } else {
+        // Arena elements go to a heap buffer from allocateStorage, placed like any other.
+        T* const source = data;
+        Arena* const from = arena;
+        arena = nullptr;
+        try {
+            allocateStorage(false);
+        } catch (...) {
+            data = source;
+            arena = from;
+            throw;
+        }
+        st::copy(source, source + extent(), data);
+        from->release(source);
+        arena = from;
+        out = Buffer(data, [bytes](T* buffer) { detail::freeBuffer(buffer, bytes); });
+    }
+    delete shared;
+    shared = nullptr;
+    data = nullptr;
+    rows = 0;
+    columns = 0;
+    stride = 0;
+    size = 0;
+    return out;
+}
+
+// Move constructor: transfer ownership from another SquareMat (rvalue); inline elements are copied.
+template <typename T>
+BasicSquareMat<T>::BasicSquareMat(BasicSquareMat&& other) noexcept {
+    takeStorage(other);
+}
+
+// View constructor: deep copy of the block a view refers to, with this matrix's own padded stride.
+template <typename T>
+BasicSquareMat<T>::BasicSquareMat(const BasicConstMatrixView<T>& source) {
+    rows = source.getRows();
+    columns = source.getCols();
+    stride = leadingDimension(columns);
+    size = (size_t)rows * columns;
+    arena = ArenaScope::current();
+    shared = nullptr;
+    allocateStorage(false);
+    for (int i = 0; i < rows; ++i) {
+        st::copy(source[i], source[i] + columns, (*this)[i]);
+    }
+}
+
+// Move assignment operator: transfer ownership from another SquareMat (rvalue); inline elements are copied.
+// Buffers only change hands between matrices with the same memory source, otherwise the elements
+// are copied so this matrix keeps drawing from where it was constructed. An external buffer that
+// fits is kept and written to, as in copy assignment.
+template <typename T>
+BasicSquareMat<T>& BasicSquareMat<T>::operator=(BasicSquareMat&& other) {
     if (this != &other) {
-        for (int i = 0; i < rows; ++i) delete[] data[i];
-        delete[] data;
+        if (other.arena != arena || assignsInPlace(other)) {
+            return *this = static_cast<const BasicSquareMat&>(other);
+        }
+        freeStorage();
+        takeStorage(other);
+    }
+    return *this;
+}
+
+// Destructor: free allocated memory of matrix.
+template <typename T>
+BasicSquareMat<T>::~BasicSquareMat() {
+    freeStorage();
+}
+
+// Copy assignment operator: deep copy from another SquareMat, reusing the buffer when sizes match.
+// A copy-on-write matrix is shared instead; a shared buffer of this matrix is never written to.
+// An external buffer of the right size that no other matrix shares always receives the copy.
+template <typename T>
+BasicSquareMat<T>& BasicSquareMat<T>::operator=(const BasicSquareMat& other) {
+    if (this == &other || (shared && shared == other.shared)) return *this;
+    if (assignsInPlace(other)) {
+        shared->copyOnWrite = other.isCopyOnWrite();
+    } else if (other.isCopyOnWrite() && !arena) {
+        freeStorage();
+        shareStorage(other);
+        return *this;
+    } else if (isCopyOnWrite()) {
+        freeStorage();
+    }
+    if (rows != other.rows || data == nullptr) {
+        freeStorage();
         rows = other.rows;
         columns = other.columns;
+        stride = other.isExternal() ? leadingDimension(columns) : other.stride;
         size = other.size;
-        data = other.data;
-        other.data = nullptr;
-        other.rows = 0;
-        other.columns = 0;
-        other.size = 0;
+        if (size == 0) return *this;
+        allocateStorage(false);
+    }
+    if (stride == other.stride) {
+        st::copy(other.data, other.data + other.extent(), data);
+    } else {
+        for (int i = 0; i < rows; ++i) {
+            st::copy(other[i], other[i] + columns, data + (size_t)i * stride);
+        }
     }
     return *this;
 }
 
-// Destructor: free allocated memory of matrix.
-SquareMat::~SquareMat() {
-    for (int i = 0; i < rows; ++i) { delete[] data[i]; }
-    delete[] data;
+// In-place matrix addition: add other to this matrix, without a temporary.
+template <typename T>
+BasicSquareMat<T>& BasicSquareMat<T>::operator+=(const BasicSquareMat& other) {
+    return *this += other.view();
 }
 
-// Copy assignment operator: deep copy from another SquareMat.
-SquareMat& SquareMat::operator=(const SquareMat& other) {
-    if (this == &other) return *this;
-    for (int i = 0; i < rows; ++i) {
-        delete[] data[i];
-    }
-    delete[] data;
-    rows = other.rows;
-    columns = other.columns;
-    size = other.size;
-    data = new double*[rows];
-    for (int i = 0; i < rows; ++i) {
-        data[i] = new double[columns];
-        for (int j = 0; j < columns; ++j){
-            data[i][j] = other.data[i][j];
-        }
-    }
+// In-place addition of a view.
+template <typename T>
+BasicSquareMat<T>& BasicSquareMat<T>::operator+=(const BasicConstMatrixView<T>& other) {
+    requireSameSize(view(), other, "addition");
+    zipRows(view(), view(), other, detail::simdKernels<T>().add);
     return *this;
 }
 
-// In-place matrix addition: add other to this matrix.
-SquareMat& SquareMat::operator+=(const SquareMat& other) {
-    *this = *this + other;
-    return *this;
+// In-place matrix subtraction: subtract other from this matrix, without a temporary.
+template <typename T>
+BasicSquareMat<T>& BasicSquareMat<T>::operator-=(const BasicSquareMat& other) {
+    return *this -= other.view();
 }
 
-// In-place matrix subtraction: subtract other from this matrix.
-SquareMat& SquareMat::operator-=(const SquareMat& other) {
-    *this = *this - other;
+// In-place subtraction of a view.
+template <typename T>
+BasicSquareMat<T>& BasicSquareMat<T>::operator-=(const BasicConstMatrixView<T>& other) {
+    requireSameSize(view(), other, "subtraction");
+    zipRows(view(), view(), other, detail::simdKernels<T>().subtract);
     return *this;
 }
 
-// In-place matrix multiplication: multiply this matrix by other.
-SquareMat& SquareMat::operator*=(const SquareMat& other) {
+// In-place matrix multiplication: multiply this matrix by other. The product needs a temporary;
+// assigning it back keeps an external buffer.
+template <typename T>
+BasicSquareMat<T>& BasicSquareMat<T>::operator*=(const BasicSquareMat& other) {
     *this = *this * other;
     return *this;
 }
 
-// In-place scalar multiplication: multiply this matrix by scalar.
-SquareMat& SquareMat::operator*=(double scalar) {
-    *this = *this * scalar;
+// In-place matrix multiplication by a view.
+template <typename T>
+BasicSquareMat<T>& BasicSquareMat<T>::operator*=(const BasicConstMatrixView<T>& other) {
+    *this = multiply(*this, other);
     return *this;
 }
 
-// In-place scalar division: divide this matrix by scalar.
-SquareMat& SquareMat::operator/=(double scalar) {
-    *this = *this / scalar;
+// In-place scalar multiplication: multiply this matrix by scalar, without a temporary.
+template <typename T>
+BasicSquareMat<T>& BasicSquareMat<T>::operator*=(T scalar) {
+    scaleRows(view(), view(), scalar, detail::simdKernels<T>().scale);
     return *this;
 }
 
-// In-place scalar modulo: apply modulo for each element with given scalar.
-SquareMat& SquareMat::operator%=(const int scalar) {
-    *this = *this % scalar;
+// In-place scalar division: divide this matrix by scalar, without a temporary.
+template <typename T>
+BasicSquareMat<T>& BasicSquareMat<T>::operator/=(T scalar) {
+    if (scalar == T(0)) {
+        throw std::invalid_argument("Division by zero");
+    }
+    scaleRows(view(), view(), scalar, detail::simdKernels<T>().divide);
     return *this;
 }
 
-// In-place element-wise modulo: apply element-wise modulo operation with other matrix.
+// In-place scalar modulo: apply modulo for each element with given scalar, without a temporary.
+template <typename T>
+BasicSquareMat<T>& BasicSquareMat<T>::operator%=(const int scalar) {
+    requireModulo<T>(scalar);
+    mapRows(view(), view(), [scalar](T a) { return modElement(a, scalar); });
+    return *this;
+}
+
+// In-place element-wise modulo: apply element-wise modulo operation with other matrix, without a temporary.
+
+template <typename T>
+BasicSquareMat<T>& BasicSquareMat<T>::operator%=(const BasicSquareMat& other) {
+    return *this %= other.view();
+}
 
-SquareMat& SquareMat::operator%=(const SquareMat& other) {
-    *this = *this % other;
+// In-place element-wise multiplication by a view.
+template <typename T>
+BasicSquareMat<T>& BasicSquareMat<T>::operator%=(const BasicConstMatrixView<T>& other) {
+    requireSameSize(view(), other, "element-wise multiplication");
+    zipRows(view(), view(), other, detail::simdKernels<T>().multiply);
     return *this;
 }
 
 // Prefix increment: increase each element by 1.
 
-SquareMat& SquareMat::operator++() {
+template <typename T>
+BasicSquareMat<T>& BasicSquareMat<T>::operator++() {
+    detach();
     for (int i = 0; i < rows; ++i){
+        T* row = data + (size_t)i * stride;
         for (int j = 0; j < columns; ++j){
-            data[i][j]++;
+            row[j] += T(1);
         }
     }
     return *this;
 }
 
 // Postfix increment: increase each element by 1, returns copy before increment.
-SquareMat SquareMat::operator++(int) {
-    SquareMat tmp(*this);
+template <typename T>
+BasicSquareMat<T> BasicSquareMat<T>::operator++(int) {
+    BasicSquareMat tmp(*this);
     ++(*this);
     return tmp;
 }
 
 // Prefix decrement: decrease each element by 1.
 
-SquareMat& SquareMat::operator--() {
+template <typename T>
+BasicSquareMat<T>& BasicSquareMat<T>::operator--() {
+    detach();
     for (int i = 0; i < rows; ++i){
+        T* row = data + (size_t)i * stride;
         for (int j = 0; j < columns; ++j){
-            data[i][j]--;
+            row[j] -= T(1);
         }
     }
     return *this;
 }
 
 // Postfix decrement: decrease each element by 1, returns copy before decrement.
-SquareMat SquareMat::operator--(int) {
-    SquareMat tmp(*this);
+template <typename T>
+BasicSquareMat<T> BasicSquareMat<T>::operator--(int) {
+    BasicSquareMat tmp(*this);
     --(*this);
     return tmp;
 }
 
 // Access element at (row, col) with bounds checking.
-double& SquareMat::operator()(int row, int col) {
+template <typename T>
+T& BasicSquareMat<T>::operator()(int row, int col) {
     if (row < 0 || row >= rows || col < 0 || col >= columns) {
         throw std::out_of_range("Index out of range of matrix");
     }
-    return data[row][col];
+    detach();
+    return data[(size_t)row * stride + col];
 }
 
 // Access element at (row, col) with bounds checking (const version).
-const double& SquareMat::operator()(int row, int col) const {
+template <typename T>
+const T& BasicSquareMat<T>::operator()(int row, int col) const {
     if (row < 0 || row >= rows || col < 0 || col >= columns) {
         throw std::out_of_range("Index out of range of matrix");
     }
-    return data[row][col];
+    return data[(size_t)row * stride + col];
 }
 
 // Compare matrices for equality (all elements and size).
-bool SquareMat::operator==(const SquareMat& other) const {
+template <typename T>
+bool BasicSquareMat<T>::operator==(const BasicSquareMat& other) const {
     if (rows != other.rows || columns != other.columns) {
         return false;
     }
     for (int i = 0; i < rows; ++i){
+        const T* a = (*this)[i];
+        const T* b = other[i];
         for (int j = 0; j < columns; ++j){
-            if (data[i][j] != other.data[i][j])
+            if (a[j] != b[j])
                 return false;
         }
     }
@@ -204,222 +673,317 @@ bool SquareMat::operator==(const SquareMat& other) const {
 }
 
 // Compare matrices for inequality.
-bool SquareMat::operator!=(const SquareMat& other) const {
+template <typename T>
+bool BasicSquareMat<T>::operator!=(const BasicSquareMat& other) const {
     return !(*this == other);
 }
 
+// Ordering compares sums, which complex numbers do not have.
+template <typename T>
+void BasicSquareMat<T>::requireOrdered() {
+    if constexpr (IsComplex<T>::value) {
+        throw std::invalid_argument("Ordering comparisons are not defined for complex matrices");
+    }
+}
+
 // Compare matrices: true if sum of this matrix > other.
-bool SquareMat::operator>(const SquareMat& other) const {
-    return this->countSum() > other.countSum();
+template <typename T>
+bool BasicSquareMat<T>::operator>(const BasicSquareMat& other) const {
+    requireOrdered();
+    if constexpr (IsComplex<T>::value) return false;
+    else return this->countSum() > other.countSum();
 }
 
 // Compare matrices: true if sum of this matrix >= other.
-bool SquareMat::operator>=(const SquareMat& other) const {
-    return countSum() >= other.countSum();
+template <typename T>
+bool BasicSquareMat<T>::operator>=(const BasicSquareMat& other) const {
+    requireOrdered();
+    if constexpr (IsComplex<T>::value) return false;
+    else return countSum() >= other.countSum();
 }
 
 // Compare matrices: true if sum of this matrix < other.
-bool SquareMat::operator<(const SquareMat& other) const {
-    return countSum() < other.countSum();
+template <typename T>
+bool BasicSquareMat<T>::operator<(const BasicSquareMat& other) const {
+    requireOrdered();
+    if constexpr (IsComplex<T>::value) return false;
+    else return countSum() < other.countSum();
 }
 
 // Compare matrices: true if sum of this matrix <= other.
-bool SquareMat::operator<=(const SquareMat& other) const {
-    return countSum() <= other.countSum();
+template <typename T>
+bool BasicSquareMat<T>::operator<=(const BasicSquareMat& other) const {
+    requireOrdered();
+    if constexpr (IsComplex<T>::value) return false;
+    else return countSum() <= other.countSum();
 }
 
 // Get number of rows in the matrix.
-int SquareMat::getRows() const { return rows; }
+template <typename T>
+int BasicSquareMat<T>::getRows() const { return rows; }
 
 // Get number of columns in the matrix.
-int SquareMat::getCols() const { return columns; }
+template <typename T>
+int BasicSquareMat<T>::getCols() const { return columns; }
+
+// Get the leading dimension (row stride in elements).
+template <typename T>
+int BasicSquareMat<T>::getStride() const { return stride; }
+
+// Get the start of the aligned element buffer, for writing.
+template <typename T>
+T* BasicSquareMat<T>::getData() {
+    detach();
+    return data;
+}
+
+// Get the start of the aligned element buffer, for reading.
+template <typename T>
+const T* BasicSquareMat<T>::getData() const { return data; }
+
+// Switch to copy-on-write mode: give the heap buffer a reference count.
+template <typename T>
+void BasicSquareMat<T>::enableCopyOnWrite() {
+    if (shared) {
+        shared->copyOnWrite = true;
+        return;
+    }
+    if (!data || isInline() || arena) return;
+    shared = new detail::SharedBuffer;
+}
+
+// Whether copies share the buffer.
+template <typename T>
+bool BasicSquareMat<T>::isCopyOnWrite() const { return shared && shared->copyOnWrite; }
+
+// Number of matrices sharing the buffer.
+template <typename T>
+int BasicSquareMat<T>::useCount() const {
+    return shared ? shared->owners.load(st::memory_order_relaxed) : 1;
+}
+
+// Writable view of the whole matrix.
+template <typename T>
+BasicMatrixView<T> BasicSquareMat<T>::view() {
+    detach();
+    return BasicMatrixView<T>(data, rows, stride);
+}
+
+// Read-only view of the whole matrix.
+template <typename T>
+BasicConstMatrixView<T> BasicSquareMat<T>::view() const {
+    return BasicConstMatrixView<T>(data, rows, stride);
+}
+
+// Writable view of a square block.
+template <typename T>
+BasicMatrixView<T> BasicSquareMat<T>::block(int row, int col, int size) {
+    return view().block(row, col, size);
+}
+
+// Read-only view of a square block.
+template <typename T>
+BasicConstMatrixView<T> BasicSquareMat<T>::block(int row, int col, int size) const {
+    return view().block(row, col, size);
+}
 
 // Fill all elements of the matrix with given value.
-void SquareMat::fill(double value) {
+template <typename T>
+void BasicSquareMat<T>::fill(T value) {
+    detach();
+    const auto fillRow = detail::simdKernels<T>().fill;
     for (int i = 0; i < rows; ++i){
-        for (int j = 0; j < columns; ++j){
-            data[i][j] = value;
-        }
+        fillRow(data + (size_t)i * stride, value, (size_t)columns);
     }
 }
 
 
 // Calculate sum of all elements in the matrix.
-double SquareMat::countSum() const {
-    double sum = 0;
+template <typename T>
+T BasicSquareMat<T>::countSum() const {
+    T sum = 0;
+    const auto sumRow = detail::simdKernels<T>().sum;
     for (int i = 0; i < rows; ++i){
-        for (int j = 0; j < columns; ++j){
-            sum += data[i][j];
-        }
+        sum += sumRow(data + (size_t)i * stride, (size_t)columns);
     }
     return sum;
 }
 
 // Matrix exponentiation: raise the matrix to an integer non-negative power.
-SquareMat SquareMat::operator^(int scalar) const {
-    if (scalar < 0) {
+// Exponentiation by squaring over the bits of power, lowest first. The first set bit copies the
+// current square into the result instead of multiplying the identity by it; every later product
+// goes into the free scratch matrix, which then swaps roles with the operand it replaces.
+template <typename T>
+BasicSquareMat<T> BasicSquareMat<T>::operator^(long long power) const {
+    if (power < 0) {
         throw std::invalid_argument("Negative exponents are not supported for matrices");
     }
-    SquareMat result(rows, columns);
-    for (int i = 0; i < rows; ++i) {
-        for (int j = 0; j < columns; ++j)
-            result[i][j] = (i == j) ? 1 : 0;
-    }
-    if (scalar == 0) { return result; }
-    SquareMat helper(*this);
-    for (int i = 0; i < scalar; i++){
-            result *= *this;}
-
-    return result;
-}
-
-// Calculate determinant of a square matrix (recursive for size > 2).
-double getDeterminant(const SquareMat& mat)  {
-    if (mat.getRows() == 2) {
-        return (mat)(0, 0) * (mat)(1, 1) - (mat)(0, 1) * (mat)(1, 0);
-    }
-    double det = 0;
-    for (int i = 0; i < mat.getCols(); ++i) {
-        SquareMat minor(mat.getRows() - 1,  mat.getCols() - 1);
-        for (int r = 1; r < mat.getRows(); ++r) {
-            int colIndex = 0;
-            for (int c = 0; c < mat.getCols(); ++c) {
-                if (c == i) continue;
-                minor[r - 1][colIndex] = mat[r][c];
-                ++colIndex;
+    if (power == 0) {
+        return identity(rows);
+    }
+    BasicSquareMat first(*this);
+    first.detach();
+    BasicSquareMat second(rows, uninitialized);
+    BasicSquareMat third(rows, uninitialized);
+    BasicSquareMat* base = &first;
+    BasicSquareMat* result = &second;
+    BasicSquareMat* scratch = &third;
+    bool started = false;
+    while (true) {
+        if (power & 1) {
+            if (started) {
+                multiplyInto(result->view(), base->view(), *scratch);
+                st::swap(result, scratch);
+            } else {
+                for (int i = 0; i < rows; ++i) {
+                    const T* src = base->data + (size_t)i * base->stride;
+                    st::copy(src, src + columns, result->data + (size_t)i * result->stride);
+                }
+                started = true;
             }
         }
-        det += ((i % 2 == 0) ? 1 : -1) * mat[0][i] * getDeterminant(minor);
+        power >>= 1;
+        if (power == 0) break;
+        multiplyInto(base->view(), base->view(), *scratch);
+        st::swap(base, scratch);
+    }
+    return st::move(*result);
+}
+
+// Determinant of the minor made of rows row.. of mat and the count columns listed in cols, by
+// cofactor expansion along its first row (recursive for size > 2). Minors are never copied: each
+// level only lists its remaining columns, in the next slice of scratch.
+template <typename T>
+T getDeterminant(const BasicConstMatrixView<T>& mat, int row, const int* cols, int count, int* scratch) {
+    const T* top = mat[row];
+    if (count == 2) {
+        const T* next = mat[row + 1];
+        return top[cols[0]] * next[cols[1]] - top[cols[1]] * next[cols[0]];
+    }
+    int* minorCols = scratch;
+    T det = 0;
+    for (int i = 0; i < count; ++i) {
+        int colIndex = 0;
+        for (int c = 0; c < count; ++c) {
+            if (c == i) continue;
+            minorCols[colIndex] = cols[c];
+            ++colIndex;
+        }
+        det += ((i % 2 == 0) ? T(1) : T(-1)) * top[cols[i]] * getDeterminant(mat, row + 1, minorCols, count - 1, scratch + count - 1);
     }
     return det;
 }
 
+// Calculate determinant of a square matrix or block (size >= 2).
+template <typename T>
+T getDeterminant(const BasicConstMatrixView<T>& mat) {
+    const int n = mat.getCols();
+    st::vector<int> columns((size_t)n * (n + 1) / 2);
+    for (int c = 0; c < n; ++c) columns[c] = c;
+    return getDeterminant(mat, 0, columns.data(), n, columns.data() + n);
+}
+
 // Determinant operator: returns the determinant of the matrix.
-double SquareMat::operator!() const {
+template <typename T>
+T BasicSquareMat<T>::operator!() const {
     if (rows != columns) {
         throw std::invalid_argument("Matrix must be square for determinant calculation");
     }
     if (rows == 1) { return (*this[0][0]); }
-    else return getDeterminant(*this);
+    else return getDeterminant(view());
 }
 
 // Add two matrices (element-wise).
-SquareMat operator+(const SquareMat& left, const SquareMat& right) {
-    if (left.getRows() != right.getRows() || left.getCols() != right.getCols()) {
-        throw std::invalid_argument("Matrices must have the same dimensions for addition");
-    }
-    SquareMat result(left.getRows(), left.getCols());
-    for (int i = 0; i < left.getRows(); ++i){
-        for (int j = 0; j < left.getCols(); ++j){
-            result[i][j] = left[i][j] + right[i][j];
-        }
-    }
+template <typename T>
+BasicSquareMat<T> BasicSquareMat<T>::add(const BasicConstMatrixView<T>& left, const BasicConstMatrixView<T>& right) {
+    requireSameSize(left, right, "addition");
+    BasicSquareMat result(left.getRows(), uninitialized);
+    zipRows(result.view(), left, right, detail::simdKernels<T>().add);
     return result;
 }
 
 // Subtract one matrix from another (element-wise).
-SquareMat operator-(const SquareMat& left, const SquareMat& right) {
-    if (left.getRows() != right.getRows() || left.getCols() != right.getCols()) {
-        throw std::invalid_argument("Matrices must have the same dimensions for subtraction");
-    }
-    SquareMat result(left.getRows(), left.getCols());
-    for (int i = 0; i < left.getRows(); ++i){
-        for (int j = 0; j < left.getCols(); ++j){
-            result[i][j] = left[i][j] - right[i][j];
-        }
-    }
+template <typename T>
+BasicSquareMat<T> BasicSquareMat<T>::subtract(const BasicConstMatrixView<T>& left, const BasicConstMatrixView<T>& right) {
+    requireSameSize(left, right, "subtraction");
+    BasicSquareMat result(left.getRows(), uninitialized);
+    zipRows(result.view(), left, right, detail::simdKernels<T>().subtract);
     return result;
 }
 
-// Multiply two matrices (matrix product).
-
-SquareMat operator*(const SquareMat& left, const SquareMat& right) {
-    if (left.getRows() != right.getRows() || left.getCols() != right.getCols()) {
-        throw std::invalid_argument("Matrices must have the same dimensions for multiplication");
-    }
-    SquareMat result(left.getRows(), left.getCols());
-    for (int i = 0; i < left.getRows(); ++i) {
-        for (int j = 0; j < right.getCols(); ++j) {
-            result[i][j] = 0;
-            for (int k = 0; k < left.getCols(); ++k) {
-                result[i][j] += left[i][k] * right[k][j];
-            }
-        }
-    }
+// Multiply two matrices (matrix product) into a new matrix.
+template <typename T>
+BasicSquareMat<T> BasicSquareMat<T>::multiply(const BasicConstMatrixView<T>& left, const BasicConstMatrixView<T>& right) {
+    requireSameSize(left, right, "multiplication");
+    BasicSquareMat result(left.getRows(), uninitialized);
+    multiplyInto(left, right, result);
     return result;
 }
 
-// Multiply each element by a scalar.
-SquareMat operator*(const SquareMat& mat, double scalar) {
-    SquareMat result(mat.getRows(), mat.getCols());
-    for (int i = 0; i < mat.getRows(); ++i){
-        for (int j = 0; j < mat.getCols(); ++j){
-            result[i][j] = mat[i][j] * scalar;
-        }
+// Write the product of two same-size views into out, an exclusively owned matrix of that size
+// that overlaps neither, with the blocked, packed engine of Gemm.cpp or with Strassen-Winograd
+// when enabled; both write every element of out.
+template <typename T>
+void BasicSquareMat<T>::multiplyInto(const BasicConstMatrixView<T>& left, const BasicConstMatrixView<T>& right,
+                                     BasicSquareMat& out) {
+    const int n = left.getRows();
+    if (Strassen::enabled()) {
+        detail::strassen(n, left.getData(), (size_t)left.getStride(), right.getData(), (size_t)right.getStride(),
+                         out.data, (size_t)out.stride);
+    } else {
+        detail::gemm(n, n, n, left.getData(), (size_t)left.getStride(), right.getData(), (size_t)right.getStride(),
+                     out.data, (size_t)out.stride);
     }
-    return result;
 }
 
-// Multiply each element by a scalar (scalar on left).
-SquareMat operator*(double scalar, const SquareMat& mat) {
-    return mat * scalar;
+// Multiply each element by a scalar.
+template <typename T>
+BasicSquareMat<T> BasicSquareMat<T>::scale(const BasicConstMatrixView<T>& mat, T scalar) {
+    BasicSquareMat result(mat.getRows(), uninitialized);
+    scaleRows(result.view(), mat, scalar, detail::simdKernels<T>().scale);
+    return result;
 }
 
 // Element-wise multiplication of two matrices.
-SquareMat operator%(const SquareMat& left, const SquareMat& right) {
-    if (left.getRows() != right.getRows() || left.getCols() != right.getCols()) {
-        throw std::invalid_argument("Matrices must have the same dimensions for element-wise multiplication");
-    }
-    SquareMat result(left.getRows(), left.getCols());
-    for (int i = 0; i < left.getRows(); ++i){
-        for (int j = 0; j < left.getCols(); ++j){
-            result[i][j] = left[i][j] * right[i][j];
-        }
-    }
+template <typename T>
+BasicSquareMat<T> BasicSquareMat<T>::hadamard(const BasicConstMatrixView<T>& left, const BasicConstMatrixView<T>& right) {
+    requireSameSize(left, right, "element-wise multiplication");
+    BasicSquareMat result(left.getRows(), uninitialized);
+    zipRows(result.view(), left, right, detail::simdKernels<T>().multiply);
     return result;
-
 }
 
-// Element-wise modulo operation (fmod) with a scalar.
-SquareMat operator%(const SquareMat& mat, int scalar) {
-    if (scalar == 0) {
-        throw std::invalid_argument("Modulo by zero");
-    }
-    SquareMat result(mat.getRows(), mat.getCols());
-    for (int i = 0; i < mat.getRows(); ++i)
-        for (int j = 0; j < mat.getCols(); ++j){
-            result[i][j] = std::fmod(mat[i][j], scalar);
-    }
+// Element-wise modulo operation with a scalar: fmod for floating point, % for integers.
+template <typename T>
+BasicSquareMat<T> BasicSquareMat<T>::modulo(const BasicConstMatrixView<T>& mat, int scalar) {
+    requireModulo<T>(scalar);
+    BasicSquareMat result(mat.getRows(), uninitialized);
+    mapRows(result.view(), mat, [scalar](T a) { return modElement(a, scalar); });
     return result;
 }
 
 // Divide each element by a scalar.
-SquareMat operator/(const SquareMat& mat, double scalar) {
-    if (scalar == 0.0) {
+template <typename T>
+BasicSquareMat<T> BasicSquareMat<T>::divide(const BasicConstMatrixView<T>& mat, T scalar) {
+    if (scalar == T(0)) {
         throw std::invalid_argument("Division by zero");
     }
-    SquareMat result(mat.getRows(), mat.getCols());
-    for (int i = 0; i < mat.getRows(); ++i){
-        for (int j = 0; j < mat.getCols(); ++j){
-            result[i][j] = mat[i][j] / scalar;
-        }
-    }
+    BasicSquareMat result(mat.getRows(), uninitialized);
+    scaleRows(result.view(), mat, scalar, detail::simdKernels<T>().divide);
     return result;
 }
 
-// Transpose of the matrix: returns transposed matrix.
-
-SquareMat operator~(const SquareMat& mat) {
-    SquareMat result(mat.getRows(), mat.getCols());
-    for (int i = 0; i < mat.getRows(); ++i){
-        for (int j = 0; j < mat.getCols(); ++j){
-            result[i][j] = mat[j][i];
-        }
-    }
+// Transpose of the matrix: returns transposed matrix, built tile by tile by the transpose kernel.
+template <typename T>
+BasicSquareMat<T> BasicSquareMat<T>::transpose(const BasicConstMatrixView<T>& mat) {
+    BasicSquareMat result(mat.getRows(), uninitialized);
+    detail::simdKernels<T>().transpose(mat.getData(), (size_t)mat.getStride(), result.data, (size_t)result.stride,
+                                       mat.getRows(), mat.getCols());
     return result;
 }
 // Output the matrix to an output stream, formatted as rows of elements.
-std::ostream& operator<<(std::ostream& stream, const SquareMat& mat) {
+template <typename T>
+std::ostream& BasicSquareMat<T>::print(std::ostream& stream, const BasicSquareMat& mat) {
     for (int i = 0; i < mat.getRows(); ++i) {
         for (int j = 0; j < mat.getCols(); ++j) {
             stream << "[ " << mat[i][j] << " ]";
@@ -429,4 +993,10 @@ std::ostream& operator<<(std::ostream& stream, const SquareMat& mat) {
     return stream;
 }
 
-}
\ No newline at end of file
+// Explicit instantiations for the supported element types.
+template class BasicSquareMat<float>;
+template class BasicSquareMat<double>;
+template class BasicSquareMat<std::int64_t>;
+template class BasicSquareMat<std::complex<double>>;
+
+}
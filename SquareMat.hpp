@@ -1,8 +1,20 @@
 // adar101101@gmail.com
 
 #pragma once
+#include <complex>
+#include <cstdint>
+#include <functional>
 #include <iostream>
+#include <memory>
 #include <stdexcept>
+#include <type_traits>
+#include "MatrixMemory.hpp"
+#include "MatrixView.hpp"
+#if defined(__has_include)
+#if __has_include(<span>) && __cplusplus >= 202002L
+#include <span>
+#endif
+#endif
 
 /**
  * @file SquareMat.hpp
@@ -11,25 +23,167 @@
 
 namespace Matrix {
 
+namespace detail {
+
+/// True for std::complex element types, which have no ordering and no modulo.
+template <typename T> struct IsComplex : std::false_type {};
+template <typename T> struct IsComplex<std::complex<T>> : std::true_type {};
+
+}
+
+/// Tag type selecting the constructor that leaves the elements unwritten.
+struct Uninitialized {
+    explicit Uninitialized() = default;
+};
+
+/**
+ * @brief Tag for BasicSquareMat(size, uninitialized): skip zeroing when every element will be written.
+ *
+ * Building with MATRIX_DEBUG_UNINITIALIZED defined fills such matrices with NaN (the smallest
+ * value for integer elements) instead, so reads of elements never written stand out.
+ */
+inline constexpr Uninitialized uninitialized{};
+
 /**
- * @class SquareMat
- * @brief Represents a square matrix of doubles with extensive operator overloading for arithmetic and utility operations.
+ * @class BasicSquareMat
+ * @brief Represents a square matrix of T with extensive operator overloading for arithmetic and utility operations.
  *
  * This class supports deep copy, move semantics, arithmetic operations (including element-wise and scalar),
  * increment/decrement, comparisons, matrix exponentiation, determinant calculation, and more.
  * All operations enforce square matrix dimensions unless explicitly stated.
+ *
+ * The member definitions live in SquareMat.cpp and are explicitly instantiated for float, double,
+ * std::int64_t and std::complex<double>; use the aliases below. Ordering comparisons and scalar
+ * modulo throw std::invalid_argument for complex elements.
+ * @tparam T Element type.
  */
-class SquareMat {
+template <typename T>
+class BasicSquareMat {
+    static_assert(std::is_trivially_copyable<T>::value, "SquareMat elements must be trivially copyable");
+
+public:
+    /// Alignment in bytes of every heap matrix buffer (one cache line).
+    static constexpr size_t ALIGNMENT = 64;
+
+    /// Largest dimension whose elements are kept inside the object instead of on the heap.
+    static constexpr int INLINE_DIM = 4;
+
 private:
     int rows;         
     int columns;         
-    double** data;  
+    int stride;     ///< Leading dimension: distance in elements between the starts of two rows.
+    T* data;   ///< Row-major buffer of rows * stride elements (heap, arena, or local for tiny matrices).
+    Arena* arena;   ///< Arena this matrix draws its buffers from, fixed at construction (nullptr = heap).
+    detail::SharedBuffer* shared;   ///< Reference count in copy-on-write mode or for external buffers (nullptr = sole owner).
+    alignas(ALIGNMENT) T local[INLINE_DIM * INLINE_DIM];  ///< Inline storage for matrices up to INLINE_DIM x INLINE_DIM.
+
+    /**
+     * @brief Checks whether the elements live in the inline buffer.
+     * @return True if data points at local.
+     */
+    bool isInline() const { return data == local; }
+
+    /**
+     * @brief Takes over the storage of another matrix, copying inline elements and stealing other buffers.
+     * @param other Matrix to take from; left empty afterwards.
+     */
+    void takeStorage(BasicSquareMat& other) noexcept;
+
+    /**
+     * @brief Refers to other's copy-on-write buffer instead of copying it, if both use the heap.
+     * @param other Matrix to share with.
+     * @return True if the buffer is now shared.
+     */
+    bool shareStorage(const BasicSquareMat& other) noexcept;
+
+    /**
+     * @brief Makes the buffer exclusive before a write, copying it if other matrices still share it.
+     */
+    void detach() { if (shared) unshare(); }
+
+    /**
+     * @brief Slow path of detach(): copies a buffer that has other owners.
+     */
+    void unshare();
+
+    /**
+     * @brief Checks whether the elements live in a buffer supplied through borrow() or adopt().
+     * @return True for external buffers.
+     */
+    bool isExternal() const { return shared && shared->deleter; }
+
+    /**
+     * @brief Checks whether assigning other copies its elements into this matrix's external buffer.
+     * @param other Matrix about to be assigned.
+     * @return True if the buffer is external, not shared with other matrices, and of other's size.
+     */
+    bool assignsInPlace(const BasicSquareMat& other) const {
+        return isExternal() && rows == other.rows && shared->owners.load(std::memory_order_relaxed) == 1;
+    }
+
+    /**
+     * @brief Number of elements from (0, 0) through the last element of the last row.
+     * @return Extent of the buffer that holds elements.
+     */
+    size_t extent() const { return rows ? (size_t)(rows - 1) * stride + columns : 0; }
+
+    /**
+     * @brief Wraps an external buffer; see borrow() and adopt().
+     */
+    BasicSquareMat(T* external, int size, int stride, std::function<void(void*)> deleter);
+
+    /**
+     * @brief Throws std::invalid_argument for element types without an ordering (complex).
+     */
+    static void requireOrdered();
+
+    // Kernels behind the non-member operators of matrices and views.
+    friend class BasicConstMatrixView<T>;
+    static BasicSquareMat add(const BasicConstMatrixView<T>& left, const BasicConstMatrixView<T>& right);
+    static BasicSquareMat subtract(const BasicConstMatrixView<T>& left, const BasicConstMatrixView<T>& right);
+    static BasicSquareMat multiply(const BasicConstMatrixView<T>& left, const BasicConstMatrixView<T>& right);
+    static void multiplyInto(const BasicConstMatrixView<T>& left, const BasicConstMatrixView<T>& right,
+                             BasicSquareMat& out);
+    static BasicSquareMat scale(const BasicConstMatrixView<T>& mat, T scalar);
+    static BasicSquareMat divide(const BasicConstMatrixView<T>& mat, T scalar);
+    static BasicSquareMat hadamard(const BasicConstMatrixView<T>& left, const BasicConstMatrixView<T>& right);
+    static BasicSquareMat modulo(const BasicConstMatrixView<T>& mat, int scalar);
+    static BasicSquareMat transpose(const BasicConstMatrixView<T>& mat);
+    static std::ostream& print(std::ostream& stream, const BasicSquareMat& mat);
+
+    /**
+     * @brief Allocates the contiguous element buffer for the current dimensions.
+     * @param zero Whether to zero-initialize the elements.
+     */
+    void allocateStorage(bool zero);
+
+    /**
+     * @brief Touches a new heap buffer one row block per Parallel worker (NumaPlacement::Mode::FirstTouch).
+     * @param zero Whether to zero-initialize the elements, rather than touch one per page.
+     */
+    void firstTouch(bool zero);
+
+    /**
+     * @brief Frees the element buffer and leaves the matrix empty.
+     */
+    void freeStorage() noexcept;
 
 
 public:
     size_t size;   
       
 
+    /**
+     * @brief Computes the padded leading dimension used for a given row length.
+     *
+     * Rows are rounded up to a whole number of cache lines, and strides that would land on a
+     * power of two are bumped by one more line to avoid cache-set conflicts. Rows of tiny
+     * matrices (up to INLINE_DIM) are left unpadded so they fit the inline buffer.
+     * @param columns Number of columns in a row.
+     * @return Stride in elements (always >= columns).
+     */
+    static int leadingDimension(int columns);
+
     // 
     // Constructors & Destructor
     // 
@@ -39,50 +193,162 @@ public:
      * @param rows Number of rows (must equal columns).
      * @param columns Number of columns (must equal rows).
      */
-    SquareMat(int rows, int columns);
+    BasicSquareMat(int rows, int columns);
+
+    /**
+     * @brief Constructs a square matrix with an explicit leading dimension.
+     * @param rows Number of rows (must equal columns).
+     * @param columns Number of columns (must equal rows).
+     * @param stride Distance in elements between rows (must be >= columns).
+     */
+    BasicSquareMat(int rows, int columns, int stride);
+
+    /**
+     * @brief Constructs a square matrix without initializing its elements.
+     *
+     * For results about to be overwritten in full, this saves the zeroing pass over the buffer.
+     * Reading an element before writing it gives an unspecified value.
+     * @param size Number of rows and columns.
+     * @throws std::invalid_argument if size <= 0.
+     */
+    BasicSquareMat(int size, Uninitialized);
 
     /**
      * @brief Copy constructor. Performs a deep copy of another matrix.
      * @param other Matrix to copy.
      */
-    SquareMat(const SquareMat& other);
+    BasicSquareMat(const BasicSquareMat& other);
 
     /**
      * @brief Move constructor. Transfers ownership of resources from another matrix.
      * @param other Matrix to move from.
      */
-    SquareMat(SquareMat&& other) noexcept;
+    BasicSquareMat(BasicSquareMat&& other) noexcept;
+
+    /**
+     * @brief Creates an identity matrix, writing only its diagonal into a zeroed buffer.
+     * @param size Number of rows and columns.
+     * @return The size x size identity.
+     * @throws std::invalid_argument if size <= 0.
+     */
+    static BasicSquareMat identity(int size);
+
+    /**
+     * @brief Wraps an existing row-major buffer without copying it; the caller keeps ownership.
+     *
+     * The buffer must outlive the matrix. It does not need to be 64-byte aligned. Writes through
+     * the matrix go to the buffer; copies of the matrix get their own storage. The matrix stays
+     * on the buffer through copy and move assignment of a matrix of the same size and through the
+     * in-place operators (including *=): the result is copied into the buffer. Only assigning a
+     * matrix of another size, or writing while copy-on-write copies still share the buffer,
+     * moves the matrix to its own heap storage.
+     * @param data Pointer to element (0, 0).
+     * @param size Number of rows and columns.
+     * @param stride Distance in elements between rows (must be >= size).
+     * @return Matrix viewing the buffer.
+     * @throws std::invalid_argument if data is null, size <= 0 or stride < size.
+     */
+    static BasicSquareMat borrow(T* data, int size, int stride);
+
+    /**
+     * @brief Takes ownership of an existing row-major buffer without copying it.
+     *
+     * The deleter is called with data when the last matrix referring to the buffer lets go of it,
+     * unless release() hands the buffer back first. Assignment and the in-place operators keep
+     * writing into the buffer under the same rules as borrow().
+     * @param data Pointer to element (0, 0).
+     * @param size Number of rows and columns.
+     * @param stride Distance in elements between rows (must be >= size).
+     * @param deleter Frees the buffer.
+     * @return Matrix owning the buffer.
+     * @throws std::invalid_argument if data is null, size <= 0 or stride < size.
+     */
+    static BasicSquareMat adopt(T* data, int size, int stride, std::function<void(T*)> deleter);
+
+#if defined(__cpp_lib_span)
+    /**
+     * @brief Wraps a span of row-major elements without copying it; the caller keeps ownership.
+     * @param elements Buffer holding at least (size - 1) * stride + size elements.
+     * @param size Number of rows and columns.
+     * @param stride Distance in elements between rows (must be >= size).
+     * @return Matrix viewing the buffer.
+     * @throws std::invalid_argument if the span is too short, size <= 0 or stride < size.
+     */
+    static BasicSquareMat borrow(std::span<T> elements, int size, int stride) {
+        if (size > 0 && stride >= size && elements.size() < (size_t)(size - 1) * stride + size) {
+            throw std::invalid_argument("Buffer is too small for the matrix");
+        }
+        return borrow(elements.data(), size, stride);
+    }
+#endif
+
+    /// Buffer handed out by release(), with the deleter that frees it.
+    using Buffer = std::unique_ptr<T[], std::function<void(T*)>>;
+
+    /**
+     * @brief Hands the element buffer out and leaves the matrix empty, like a moved-from matrix.
+     *
+     * An adopted buffer comes back with its original deleter and a borrowed one with a deleter
+     * that does nothing. Heap buffers are handed out as they are (read getStride() first); inline and
+     * arena elements, and buffers still shared copy-on-write, are copied to a new heap buffer first.
+     * @return The buffer, or an empty Buffer if the matrix is already empty.
+     */
+    Buffer release();
+
+    /**
+     * @brief Copies the block referenced by a view into a new matrix.
+     * @param source View to copy (e.g. a block of another matrix).
+     */
+    explicit BasicSquareMat(const BasicConstMatrixView<T>& source);
 
     /**
      * @brief Copy assignment operator. Deep copies another matrix into this one.
+     *
+     * A borrowed or adopted buffer of the same size receives the elements; see borrow().
      * @param other Matrix to copy.
      * @return Reference to this matrix.
      */
-    SquareMat& operator=(const SquareMat& other);
+    BasicSquareMat& operator=(const BasicSquareMat& other);
 
     /**
      * @brief Move assignment operator. Transfers resources from another matrix into this one.
+     *
+     * If the two matrices draw from different memory sources (heap vs. an Arena), the elements
+     * are copied instead, so a matrix never ends up holding a buffer from a shorter-lived arena.
+     * Likewise a borrowed or adopted buffer of the same size receives a copy of the elements
+     * rather than being replaced by other's buffer; see borrow().
      * @param other Matrix to move from.
      * @return Reference to this matrix.
      */
-    SquareMat& operator=(SquareMat&& other) noexcept;
+    BasicSquareMat& operator=(BasicSquareMat&& other);
 
     /**
      * @brief Destructor. Frees all allocated memory.
      */
-    ~SquareMat();
+    ~BasicSquareMat();
 
     
     /**
      * @brief Return matrix row, given row index. can be used by adding another [] to the return value for get cell data.
      * @param row Index of wanted row
-     * @return Pointer to the wanted row
+     * @return Pointer to the wanted row inside the contiguous buffer
      */
  
 
-    double* operator[](size_t row) const {
+    T* operator[](size_t row) {
     if (row >= (size_t)rows) throw std::out_of_range("Row index out of range");
-    return this->data[row];
+    detach();
+    return this->data + row * stride;
+}
+
+    /**
+     * @brief Return matrix row for reading, given row index.
+     * @param row Index of wanted row
+     * @return Pointer to the wanted row inside the contiguous buffer
+     */
+    const T* operator[](size_t row) const {
+    if (row >= (size_t)rows) throw std::out_of_range("Row index out of range");
+    return this->data + row * stride;
 }
     
 
@@ -96,7 +362,7 @@ public:
      * @param col Columns number.
      * @return Reference to the element.
      */
-    double& operator()(int row, int col);
+    T& operator()(int row, int col);
 
     /**
      * @brief Accesses the element at (row, col), for const contexts.
@@ -104,7 +370,51 @@ public:
      * @param col Columns number.
      * @return Const reference to the element.
      */
-    const double& operator()(int row, int col) const;
+    const T& operator()(int row, int col) const;
+
+    // 
+    // Views
+    // 
+
+    /**
+     * @brief Returns a writable view of the whole matrix.
+     * @return View sharing this matrix's elements.
+     * @throws std::invalid_argument if the matrix is empty (e.g. moved from).
+     */
+    BasicMatrixView<T> view();
+
+    /**
+     * @brief Returns a read-only view of the whole matrix.
+     * @return View sharing this matrix's elements.
+     * @throws std::invalid_argument if the matrix is empty (e.g. moved from).
+     */
+    BasicConstMatrixView<T> view() const;
+
+    /**
+     * @brief Returns a writable view of a square block, without copying.
+     * @param row First row of the block.
+     * @param col First column of the block.
+     * @param size Number of rows and columns of the block.
+     * @return View of the block.
+     * @throws std::out_of_range if the block does not fit inside the matrix.
+     */
+    BasicMatrixView<T> block(int row, int col, int size);
+
+    /**
+     * @brief Returns a read-only view of a square block, without copying.
+     * @param row First row of the block.
+     * @param col First column of the block.
+     * @param size Number of rows and columns of the block.
+     * @return View of the block.
+     * @throws std::out_of_range if the block does not fit inside the matrix.
+     */
+    BasicConstMatrixView<T> block(int row, int col, int size) const;
+
+    /**
+     * @brief Implicit read-only view of the whole matrix, so matrices and views mix in operators.
+     * @throws std::invalid_argument if the matrix is empty (e.g. moved from).
+     */
+    operator BasicConstMatrixView<T>() const { return view(); }
 
     // 
     // Arithmetic Assignment Operators (in-place)
@@ -115,28 +425,49 @@ public:
      * @param other Matrix to add.
      * @return Reference to this matrix.
      */
-    SquareMat& operator+=(const SquareMat& other);
+    BasicSquareMat& operator+=(const BasicSquareMat& other);
+
+    /**
+     * @brief In-place addition of a view (e.g. a block of another matrix).
+     * @param other View to add; must not overlap this matrix unless it is the whole matrix.
+     * @return Reference to this matrix.
+     */
+    BasicSquareMat& operator+=(const BasicConstMatrixView<T>& other);
 
     /**
      * @brief In-place matrix subtraction.
      * @param other Matrix to subtract.
      * @return Reference to this matrix.
      */
-    SquareMat& operator-=(const SquareMat& other);
+    BasicSquareMat& operator-=(const BasicSquareMat& other);
+
+    /**
+     * @brief In-place subtraction of a view (e.g. a block of another matrix).
+     * @param other View to subtract; must not overlap this matrix unless it is the whole matrix.
+     * @return Reference to this matrix.
+     */
+    BasicSquareMat& operator-=(const BasicConstMatrixView<T>& other);
 
     /**
      * @brief In-place matrix multiplication.
      * @param other Matrix to multiply by.
      * @return Reference to this matrix.
      */
-    SquareMat& operator*=(const SquareMat& other);
+    BasicSquareMat& operator*=(const BasicSquareMat& other);
+
+    /**
+     * @brief In-place matrix multiplication by a view.
+     * @param other View to multiply by.
+     * @return Reference to this matrix.
+     */
+    BasicSquareMat& operator*=(const BasicConstMatrixView<T>& other);
 
     /**
      * @brief In-place scalar multiplication.
      * @param scalar Scalar value to multiply by.
      * @return Reference to this matrix.
      */
-    SquareMat& operator*=(double scalar);
+    BasicSquareMat& operator*=(T scalar);
 
     /**
      * @brief In-place scalar division.
@@ -144,7 +475,7 @@ public:
      * @return Reference to this matrix.
      * @throws std::invalid_argument if scalar == 0.
      */
-    SquareMat& operator/=(double scalar);
+    BasicSquareMat& operator/=(T scalar);
 
     /**
      * @brief In-place scalar modulo operation (applies fmod to each element).
@@ -152,14 +483,21 @@ public:
      * @return Reference to this matrix.
      * @throws std::invalid_argument if scalar == 0.
      */
-    SquareMat& operator%=(const int scalar);
+    BasicSquareMat& operator%=(const int scalar);
 
     /**
      * @brief In-place element-wise modulo operation.
      * @param other Matrix to modulo with.
      * @return Reference to this matrix.
      */
-    SquareMat& operator%=(const SquareMat& other);
+    BasicSquareMat& operator%=(const BasicSquareMat& other);
+
+    /**
+     * @brief In-place element-wise multiplication by a view.
+     * @param other View to multiply with; must not overlap this matrix unless it is the whole matrix.
+     * @return Reference to this matrix.
+     */
+    BasicSquareMat& operator%=(const BasicConstMatrixView<T>& other);
 
     // 
     // Increment / Decrement
@@ -169,25 +507,25 @@ public:
      * @brief Prefix increment: increases each element by 1.
      * @return Reference to this matrix.
      */
-    SquareMat& operator++();
+    BasicSquareMat& operator++();
 
     /**
      * @brief Postfix increment: increases each element by 1, returns copy before increment.
      * @return Copy of this matrix before increment.
      */
-    SquareMat operator++(int);
+    BasicSquareMat operator++(int);
 
     /**
      * @brief Prefix decrement: decreases each element by 1.
      * @return Reference to this matrix.
      */
-    SquareMat& operator--();
+    BasicSquareMat& operator--();
 
     /**
      * @brief Postfix decrement: decreases each element by 1, returns copy before decrement.
      * @return Copy of this matrix before decrement.
      */
-    SquareMat operator--(int);
+    BasicSquareMat operator--(int);
 
     // 
     // Comparison Operators
@@ -198,42 +536,42 @@ public:
      * @param other Matrix to compare.
      * @return True if equal.
      */
-    bool operator==(const SquareMat& other) const;
+    bool operator==(const BasicSquareMat& other) const;
 
     /**
      * @brief Checks if two matrices are not equal.
      * @param other Matrix to compare.
      * @return True if not equal.
      */
-    bool operator!=(const SquareMat& other) const;
+    bool operator!=(const BasicSquareMat& other) const;
 
     /**
      * @brief Compares sum of elements. True if this matrix's sum > other's sum.
      * @param other Matrix to compare.
      * @return True if sum is greater.
      */
-    bool operator>(const SquareMat& other) const;
+    bool operator>(const BasicSquareMat& other) const;
 
     /**
      * @brief Compares sum of elements. True if this matrix's sum >= other's sum.
      * @param other Matrix to compare.
      * @return True if sum is greater or equal.
      */
-    bool operator>=(const SquareMat& other) const;
+    bool operator>=(const BasicSquareMat& other) const;
 
     /**
      * @brief Compares sum of elements. True if this matrix's sum < other's sum.
      * @param other Matrix to compare.
      * @return True if sum is less.
      */
-    bool operator<(const SquareMat& other) const;
+    bool operator<(const BasicSquareMat& other) const;
 
     /**
      * @brief Compares sum of elements. True if this matrix's sum <= other's sum.
      * @param other Matrix to compare.
      * @return True if sum is less or equal.
      */
-    bool operator<=(const SquareMat& other) const;
+    bool operator<=(const BasicSquareMat& other) const;
 
     // 
     // Utilities
@@ -251,38 +589,87 @@ public:
      */
     int getCols() const;
 
+    /**
+     * @brief Returns the leading dimension (row stride in elements) of the buffer.
+     * @return Row stride.
+     */
+    int getStride() const;
+
+    /**
+     * @brief Returns the start of the 64-byte aligned element buffer, for writing.
+     * @return Pointer to element (0, 0); row i starts at getData() + i * getStride().
+     */
+    T* getData();
+
+    /**
+     * @brief Returns the start of the 64-byte aligned element buffer, for reading.
+     * @return Pointer to element (0, 0); row i starts at getData() + i * getStride().
+     */
+    const T* getData() const;
+
+    /**
+     * @brief Switches the matrix to copy-on-write mode.
+     *
+     * Copies of a copy-on-write matrix (copy construction and assignment, pass and return by
+     * value, postfix ++/--) share its buffer instead of duplicating it. The buffer is duplicated
+     * on the first write through operator(), operator[], getData(), view(), block(), fill or an
+     * in-place operator, if it is still shared at that point. Copies inherit the mode; assigning
+     * a matrix that is not in copy-on-write mode turns it off. Pointers and views taken before a
+     * copy keep referring to the shared buffer, so take them after copying.
+     * Has no effect on matrices up to INLINE_DIM x INLINE_DIM or with arena storage, which are
+     * always copied.
+     */
+    void enableCopyOnWrite();
+
+    /**
+     * @brief Returns whether the matrix is in copy-on-write mode.
+     * @return True if copies share the buffer.
+     */
+    bool isCopyOnWrite() const;
+
+    /**
+     * @brief Returns how many matrices currently share this matrix's buffer.
+     * @return Number of owners (1 when the buffer is exclusive).
+     */
+    int useCount() const;
+
     /**
      * @brief Sets all elements to the specified value.
      * @param value Value to assign to all elements.
      */
-    void fill(double value);
+    void fill(T value);
 
     /**
      * @brief Returns the sum of all elements in the matrix.
      * @return Sum of elements.
      */
-    double countSum() const;
+    T countSum() const;
 
     // 
     // Exponentiation and Determinant
     // 
 
     /**
-     * @brief Raises the matrix to an integer non-negative power.
-     * @param power Exponent (must be > 0).
+     * @brief Raises the matrix to an integer non-negative power by repeated squaring.
+     *
+     * Uses O(log power) products, written alternately into two scratch matrices, so no matrix
+     * is allocated inside the loop. The single long long parameter accepts an exponent of any
+     * integer type (int, long, unsigned, size_t, ...) without overload ambiguity.
+     * @param power Exponent.
      * @return Matrix raised to the given power.
      * @throws std::invalid_argument if power < 0.
      */
-    SquareMat operator^(int power) const;
+    BasicSquareMat operator^(long long power) const;
 
     /**
      * @brief Computes the determinant of the matrix.
      * @return Determinant value.
      */
-    double operator!() const;
+    T operator!() const;
 
     // 
     // Friend Non-member Operators
+    // (defined inline so implicit conversions apply; the kernels live in BasicSquareMat.cpp)
     // 
 
     /**
@@ -291,7 +678,7 @@ public:
      * @param right Right operand.
      * @return New matrix containing the sum.
      */
-    friend SquareMat operator+(const SquareMat& left, const SquareMat& right);
+    friend BasicSquareMat operator+(const BasicSquareMat& left, const BasicSquareMat& right) { return add(left, right); }
 
     /**
      * @brief Subtracts one matrix from another (element-wise).
@@ -299,7 +686,7 @@ public:
      * @param right Right operand.
      * @return New matrix containing the difference.
      */
-    friend SquareMat operator-(const SquareMat& left, const SquareMat& right);
+    friend BasicSquareMat operator-(const BasicSquareMat& left, const BasicSquareMat& right) { return subtract(left, right); }
 
     /**
      * @brief Multiplies two matrices (matrix product).
@@ -307,7 +694,7 @@ public:
      * @param right Right operand.
      * @return New matrix containing the product.
      */
-    friend SquareMat operator*(const SquareMat& left, const SquareMat& right);
+    friend BasicSquareMat operator*(const BasicSquareMat& left, const BasicSquareMat& right) { return multiply(left, right); }
 
     /**
      * @brief Multiplies each element by a scalar.
@@ -315,7 +702,7 @@ public:
      * @param scalar Scalar operand.
      * @return New matrix with elements scaled.
      */
-    friend SquareMat operator*(const SquareMat& mat, double scalar);
+    friend BasicSquareMat operator*(const BasicSquareMat& mat, T scalar) { return scale(mat, scalar); }
 
     /**
      * @brief Multiplies each element by a scalar (scalar on left).
@@ -323,7 +710,7 @@ public:
      * @param mat Matrix operand.
      * @return New matrix with elements scaled.
      */
-    friend SquareMat operator*(double scalar, const SquareMat& mat);
+    friend BasicSquareMat operator*(T scalar, const BasicSquareMat& mat) { return scale(mat, scalar); }
 
     /**
      * @brief Divides each element by a scalar.
@@ -331,7 +718,7 @@ public:
      * @param scalar Scalar divisor.
      * @return New matrix with elements divided.
      */
-    friend SquareMat operator/(const SquareMat& mat, double scalar);
+    friend BasicSquareMat operator/(const BasicSquareMat& mat, T scalar) { return divide(mat, scalar); }
 
     /**
      * @brief Element-wise multiplication (Hadamard product).
@@ -339,22 +726,23 @@ public:
      * @param right Right operand.
      * @return New matrix with element-wise products.
      */
-    friend SquareMat operator%(const SquareMat& left, const SquareMat& right);
+    friend BasicSquareMat operator%(const BasicSquareMat& left, const BasicSquareMat& right) { return hadamard(left, right); }
 
     /**
-     * @brief Element-wise modulo operation (fmod) with a scalar.
+     * @brief Element-wise modulo operation with a scalar (fmod for floating point, % for integers).
+     * @throws std::invalid_argument if scalar == 0 or the elements are complex.
      * @param mat Matrix operand.
      * @param scalar Scalar operand.
      * @return New matrix with elements modulo scalar.
      */
-    friend SquareMat operator%(const SquareMat& mat, int scalar);
+    friend BasicSquareMat operator%(const BasicSquareMat& mat, int scalar) { return modulo(mat, scalar); }
 
     /**
      * @brief Returns the transpose of the matrix.
      * @param mat Matrix to transpose.
      * @return Transposed matrix.
      */
-    friend SquareMat operator~(const SquareMat& mat);
+    friend BasicSquareMat operator~(const BasicSquareMat& mat) { return transpose(mat); }
 
     /**
      * @brief Outputs the matrix to an output stream, formatted as rows of elements.
@@ -362,7 +750,24 @@ public:
      * @param mat Matrix to output.
      * @return Reference to the output stream.
      */
-    friend std::ostream& operator<<(std::ostream& stream, const SquareMat& mat);
+    friend std::ostream& operator<<(std::ostream& stream, const BasicSquareMat& mat) { return print(stream, mat); }
 };
 
-}
\ No newline at end of file
+/// Matrix of doubles, the default element type.
+using SquareMat = BasicSquareMat<double>;
+
+/// Single-precision matrix: half the memory traffic of SquareMat.
+using SquareMatF = BasicSquareMat<float>;
+
+/// Exact integer matrix, e.g. for path counting with operator^.
+using SquareMatI64 = BasicSquareMat<std::int64_t>;
+
+/// Complex-valued matrix.
+using SquareMatC = BasicSquareMat<std::complex<double>>;
+
+extern template class BasicSquareMat<float>;
+extern template class BasicSquareMat<double>;
+extern template class BasicSquareMat<std::int64_t>;
+extern template class BasicSquareMat<std::complex<double>>;
+
+}
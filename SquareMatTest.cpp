@@ -8,6 +8,21 @@
 #include <ctime>
 #include <cmath>
 #include <stdexcept>
+#include <cstdint>
+#include <complex>
+#include <algorithm>
+#include <thread>
+#include <vector>
+#if defined(__linux__)
+#include <csignal>
+#include <cstdio>
+#include <sched.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+#if defined(MATRIX_DEBUG_ARENA) && defined(__SANITIZE_ADDRESS__)
+#include <sanitizer/asan_interface.h>
+#endif
 
 // Shim for gmtime_s on MinGW/Windows
 inline int gmtime_s(std::tm* tmDest, const time_t* sourceTime) {
@@ -19,6 +34,17 @@ inline int gmtime_s(std::tm* tmDest, const time_t* sourceTime) {
 
 #include "doctest.h"
 #include "SquareMat.hpp"
+#include "FixedSquareMat.hpp"
+#include "SparseSquareMat.hpp"
+#include "SymmetricMat.hpp"
+#include "TriangularMat.hpp"
+#include "BandedMat.hpp"
+#include "DiagonalMat.hpp"
+#include "TiledMat.hpp"
+#include "MortonMat.hpp"
+#include "Parallel.hpp"
+#include "Simd.hpp"
+#include "Strassen.hpp"
 
 namespace Mat = Matrix;
 
@@ -51,6 +77,20 @@ bool isEqual(const Mat::SquareMat& m1, const Mat::SquareMat& m2) {
     return true;
 }
 
+/**
+ * @brief Builds a matrix of small integers that vary with row, column and seed.
+ * @param n Number of rows and columns.
+ * @param seed Shifts the pattern, so different seeds give different operands.
+ * @return Matrix with elements in [-5, 5]; their products are exact in floating point.
+ */
+template <typename T = double>
+Mat::BasicSquareMat<T> sampleMatrix(int n, int seed) {
+    Mat::BasicSquareMat<T> m(n, n);
+    for (int i = 0; i < n; ++i)
+        for (int j = 0; j < n; ++j) m[i][j] = T((i * 5 + j * 3 + seed) % 11 - 5);
+    return m;
+}
+
 /**
  * @brief Fills a matrix with zeros.
  * @param m Matrix to fill.
@@ -81,6 +121,25 @@ void fillArbitrary(Mat::SquareMat& m) {
 }
 
 
+/**
+ * @brief Reference matrix product by the textbook triple loop.
+ * @param a Left operand.
+ * @param b Right operand.
+ * @return a * b.
+ */
+template <typename T>
+Mat::BasicSquareMat<T> naiveProduct(const Mat::BasicSquareMat<T>& a, const Mat::BasicSquareMat<T>& b) {
+    const int n = a.getRows();
+    Mat::BasicSquareMat<T> result(n, n);
+    for (int i = 0; i < n; ++i)
+        for (int j = 0; j < n; ++j) {
+            T sum = T(0);
+            for (int k = 0; k < n; ++k) sum += a[i][k] * b[k][j];
+            result[i][j] = sum;
+        }
+    return result;
+}
+
 TEST_SUITE("Matrix Construction and Fill") {
     TEST_CASE("Matrix cannot be created with non-positive dimensions") {
         // Check that creating a matrix with non-positive dimensions throws an exception
@@ -212,6 +271,19 @@ TEST_SUITE("Copy and Move Semantics") {
             for (int j = 0; j < DEFAULT_SIZE; ++j)
                 CHECK(isEqual(n(i,j), 7.0));
     }
+    TEST_CASE("Copy assignment between different sizes") {
+        // Check that copy assignment reallocates when the sizes differ and reuses the buffer otherwise
+        Mat::SquareMat small(2,2); small.fill(1.5);
+        Mat::SquareMat big(5,5); big.fill(-2.0);
+        small = big;
+        CHECK(small.getRows() == 5);
+        CHECK(isEqual(small, big));
+        Mat::SquareMat same(5,5);
+        double* before = same[0];
+        same = big;
+        CHECK(same[0] == before);
+        CHECK(isEqual(same, big));
+    }
 
 
 }
@@ -284,6 +356,75 @@ TEST_SUITE("Row Access Operator []") {
             for (int j=0; j<3; ++j)
                 CHECK(m[i][j] == i*10 + j);
     }
+
+    TEST_CASE("Rows share one contiguous buffer") {
+        Mat::SquareMat m(3,3);
+        CHECK(m[1] == m[0] + m.getStride());
+        CHECK(m[2] == m[1] + m.getStride());
+        CHECK(m.getData() == m[0]);
+    }
+
+    TEST_CASE("Rows are cache-line aligned with a padded stride") {
+        for (int n : {5, 7, 8, 9, 64, 100}) {
+            Mat::SquareMat m(n,n);
+            CHECK(m.getStride() >= n);
+            for (int i = 0; i < n; ++i)
+                CHECK(reinterpret_cast<std::uintptr_t>(m[i]) % Mat::SquareMat::ALIGNMENT == 0);
+        }
+        // Power-of-two row lengths get one extra cache line of padding
+        CHECK(Mat::SquareMat::leadingDimension(64) == 72);
+        CHECK(Mat::SquareMat::leadingDimension(512) == 520);
+        CHECK(Mat::SquareMat::leadingDimension(10) == 16);
+    }
+
+    TEST_CASE("Tiny matrices keep their elements inline") {
+        auto isInside = [](const Mat::SquareMat& m) {
+            const char* p = reinterpret_cast<const char*>(m.getData());
+            const char* obj = reinterpret_cast<const char*>(&m);
+            return p >= obj && p < obj + sizeof(m);
+        };
+        for (int n = 1; n <= Mat::SquareMat::INLINE_DIM; ++n) {
+            Mat::SquareMat m(n,n);
+            CHECK(isInside(m));
+            CHECK(m.getStride() == n);
+        }
+        Mat::SquareMat big(Mat::SquareMat::INLINE_DIM + 1, Mat::SquareMat::INLINE_DIM + 1);
+        CHECK_FALSE(isInside(big));
+
+        // Moving inline storage copies the elements into the destination object
+        Mat::SquareMat a(3,3); fillArbitrary(a);
+        Mat::SquareMat keep(a);
+        Mat::SquareMat moved(std::move(a));
+        CHECK(isInside(moved));
+        CHECK(isEqual(moved, keep));
+        CHECK(a.getRows() == 0);
+
+        // Move assignment across inline and heap storage in both directions
+        Mat::SquareMat target(6,6); target.fill(1.0);
+        target = std::move(moved);
+        CHECK(isInside(target));
+        CHECK(isEqual(target, keep));
+        Mat::SquareMat heap(6,6); heap.fill(2.0);
+        Mat::SquareMat heapCopy(heap);
+        target = std::move(heap);
+        CHECK_FALSE(isInside(target));
+        CHECK(isEqual(target, heapCopy));
+        target = keep;
+        CHECK(isEqual(target, keep));
+    }
+
+    TEST_CASE("Explicit leading dimension") {
+        Mat::SquareMat m(3,3,5);
+        CHECK(m.getStride() == 5);
+        CHECK(m[1] == m[0] + 5);
+        fillArbitrary(m);
+        Mat::SquareMat padded(3,3);
+        padded = m;
+        CHECK(padded.getStride() != 5);
+        CHECK(isEqual(padded, m));
+        CHECK(isEqual(m * 2.0 / 2.0, m));
+        CHECK_THROWS_AS(Mat::SquareMat(3,3,2), std::invalid_argument);
+    }
 }
 
 TEST_SUITE("Arithmetic Operations") {
@@ -480,6 +621,30 @@ TEST_SUITE("Exponentiation and Determinant") {
             for (int j=0;j<DEFAULT_SIZE;++j)
                 CHECK(isEqual(b2(i,j), (i==j)?32:0));
     }
+    TEST_CASE("Exponentiation by squaring") {
+        // Check every power up to 20 against repeated multiplication, and that the operand is untouched
+        Mat::SquareMatI64 g(40, 40);
+        for (int i = 0; i < 40; ++i) { g(i, (i + 1) % 40) = 1; g(i, (i * 7) % 40) = 1; }
+        Mat::SquareMatI64 original(g);
+        Mat::SquareMatI64 expected = Mat::SquareMatI64::identity(40);
+        for (int p = 1; p <= 20; ++p) {
+            expected = expected * g;
+            CHECK((g ^ p) == expected);
+        }
+        CHECK(g == original);
+        // Powers beyond int: a 3-cycle permutation repeats every 3 powers
+        Mat::SquareMatI64 cycle(3, 3);
+        cycle(0, 1) = cycle(1, 2) = cycle(2, 0) = 1;
+        CHECK((cycle ^ 3000000000LL) == Mat::SquareMatI64::identity(3));
+        CHECK((cycle ^ 3000000001LL) == cycle);
+        CHECK((cycle ^ 0LL) == Mat::SquareMatI64::identity(3));
+        CHECK_THROWS_AS(cycle ^ -1LL, std::invalid_argument);
+        // Any integer type is accepted as the exponent
+        CHECK((cycle ^ 4L) == cycle);
+        CHECK((cycle ^ 4u) == cycle);
+        CHECK((cycle ^ (size_t)4) == cycle);
+        CHECK((cycle ^ (short)3) == Mat::SquareMatI64::identity(3));
+    }
     TEST_CASE("Determinant calculation") {
         // Check that determinant calculation is correct for common cases
         Mat::SquareMat a(2,2);
@@ -640,3 +805,1390 @@ TEST_SUITE("Exception Handling") {
         CHECK_THROWS(m % 0);
     }
 }
+
+TEST_SUITE("Fixed-size Matrices") {
+    constexpr Mat::FixedSquareMat<3> DIAG{2,0,0, 0,3,0, 0,0,4};
+    static_assert((!DIAG) == 24.0, "determinant is evaluated at compile time");
+    static_assert((DIAG * DIAG)(2,2) == 16.0, "product is evaluated at compile time");
+
+    TEST_CASE("Fixed matrices match the dynamic operators") {
+        Mat::SquareMat a(DEFAULT_SIZE, DEFAULT_SIZE), b(DEFAULT_SIZE, DEFAULT_SIZE);
+        fillArbitrary(a);
+        fillArbitrary(b);
+        b(1,1) = 3.0;
+        Mat::FixedSquareMat<3> fa(a), fb(b);
+        CHECK(isEqual(fa + fb, a + b));
+        CHECK(isEqual(fa - fb, a - b));
+        CHECK(isEqual(fa * fb, a * b));
+        CHECK(isEqual(fa * 2.5, a * 2.5));
+        CHECK(isEqual(2.5 * fa, 2.5 * a));
+        CHECK(isEqual(fa / 4.0, a / 4.0));
+        CHECK(isEqual(fa % fb, a % b));
+        CHECK(isEqual(fa % 3, a % 3));
+        CHECK(isEqual(~fa, ~a));
+        CHECK(isEqual(fa ^ 3, a ^ 3));
+        CHECK(isEqual(fa ^ 0, a ^ 0));
+        CHECK(isEqual(!fa, !a));
+        CHECK(isEqual(fa.countSum(), a.countSum()));
+        CHECK((fa > fb) == (a > b));
+        CHECK((fa <= fb) == (a <= b));
+        CHECK_THROWS_AS(fa ^ -1, std::invalid_argument);
+        CHECK_THROWS_AS(fa / 0.0, std::invalid_argument);
+        CHECK_THROWS_AS(fa % 0, std::invalid_argument);
+        CHECK_THROWS_AS(fa(3,0), std::out_of_range);
+    }
+
+    TEST_CASE("Fixed determinant for 1x1 through 5x5") {
+        Mat::FixedSquareMat<1> one{7.0};
+        CHECK(isEqual(!one, 7.0));
+        Mat::FixedSquareMat<4> m4{1,2,3,4, 5,6,7,8, 2,6,4,8, 3,1,1,2};
+        CHECK(isEqual(!m4, !Mat::SquareMat(m4)));
+        Mat::FixedSquareMat<5> m5;
+        for (int i = 0; i < 5; ++i)
+            for (int j = 0; j < 5; ++j)
+                m5(i,j) = (i == j) ? 2.0 : 1.0 / (1 + i + j);
+        CHECK(isEqual(!m5, !Mat::SquareMat(m5)));
+    }
+
+    TEST_CASE("Fixed in-place, increment and comparison operators") {
+        Mat::FixedSquareMat<2> m{1,2,3,4};
+        Mat::FixedSquareMat<2> before = m++;
+        CHECK(before == Mat::FixedSquareMat<2>{1,2,3,4});
+        CHECK(m == Mat::FixedSquareMat<2>{2,3,4,5});
+        --m;
+        m += m;
+        m -= Mat::FixedSquareMat<2>::identity();
+        m *= 2.0;
+        m /= 2.0;
+        CHECK(m == Mat::FixedSquareMat<2>{1,4,6,7});
+        m *= Mat::FixedSquareMat<2>::identity();
+        m %= 4;
+        CHECK(m == Mat::FixedSquareMat<2>{1,0,2,3});
+        m.fill(1.5);
+        CHECK(isEqual(m.countSum(), 6.0));
+        CHECK(m != Mat::FixedSquareMat<2>());
+        CHECK_THROWS_AS((Mat::FixedSquareMat<2>{1,2,3}), std::invalid_argument);
+    }
+
+    TEST_CASE("Fixed and dynamic matrices mix") {
+        Mat::SquareMat d(2,2);
+        d.fill(1.0);
+        Mat::FixedSquareMat<2> f{1,2,3,4};
+        Mat::SquareMat sum = d + f;
+        CHECK(isEqual(sum(1,1), 5.0));
+        Mat::SquareMat prod = f * d;  // fixed operand is converted to dynamic
+        CHECK(isEqual(prod(0,0), 3.0));
+        CHECK_THROWS_AS(Mat::FixedSquareMat<3>{d}, std::invalid_argument);
+    }
+}
+
+TEST_SUITE("Element Types") {
+    TEST_CASE("Single-precision matrices") {
+        Mat::SquareMatF a(3,3);
+        a.fill(1.5f);
+        Mat::SquareMatF b = a * a + a;
+        CHECK(b(2,1) == doctest::Approx(8.25f));
+        CHECK((b / 2.0f)(0,0) == doctest::Approx(4.125f));
+        CHECK((a % 1)(1,1) == doctest::Approx(0.5f));
+        CHECK(b > a);
+    }
+
+    TEST_CASE("Integer matrices count paths exactly") {
+        // [[1,1],[1,0]]^n holds Fibonacci numbers; F(91) does not fit a double exactly
+        Mat::SquareMatI64 fib(2,2);
+        fib(0,0) = 1; fib(0,1) = 1; fib(1,0) = 1;
+        Mat::SquareMatI64 p = fib ^ 90;
+        CHECK(p(0,0) == 4660046610375530309LL);
+        CHECK(p(0,1) == 2880067194370816120LL);
+        CHECK(!fib == -1);
+        Mat::SquareMatI64 m(3,3);
+        m.fill(17);
+        CHECK((m % 5)(2,2) == 2);
+        CHECK((m / 4)(0,0) == 4);
+        ++m;
+        CHECK(m.countSum() == 18 * 9);
+    }
+
+    TEST_CASE("Complex matrices") {
+        using C = std::complex<double>;
+        Mat::SquareMatC a(2,2);
+        a(0,0) = C(1,1); a(0,1) = C(0,2);
+        a(1,0) = C(3,0); a(1,1) = C(1,-1);
+        C det = !a;
+        CHECK(isEqual(det.real(), 2.0));
+        CHECK(isEqual(det.imag(), -6.0));
+        Mat::SquareMatC t = ~a;
+        CHECK(t(0,1) == C(3,0));
+        CHECK((a * C(0,1))(1,0) == C(0,3));
+        CHECK(a == a + Mat::SquareMatC(2,2));
+        CHECK_THROWS_AS(a % 2, std::invalid_argument);
+        CHECK_THROWS_AS((void)(a < t), std::invalid_argument);
+    }
+
+    TEST_CASE("Fixed matrices with other element types") {
+        Mat::FixedSquareMat<2, std::int64_t> f{2,1,1,1};
+        CHECK((f ^ 10)(0,0) == 10946);
+        CHECK((f ^ 10L) == (f ^ 10));
+        CHECK((f ^ (size_t)10) == (f ^ 10));
+        Mat::FixedSquareMat<2, std::int64_t> swap{0,1,1,0};
+        CHECK((swap ^ 3000000001LL) == swap);
+        CHECK(!f == 1);
+        Mat::SquareMatI64 d = f;
+        CHECK(d(0,1) == 1);
+    }
+}
+
+TEST_SUITE("Arena Allocation") {
+    TEST_CASE("Arena hands out aligned chunks and rewinds") {
+        Mat::Arena arena(4096);
+        void* a = arena.allocate(10);
+        void* b = arena.allocate(100);
+        CHECK(reinterpret_cast<std::uintptr_t>(a) % 64 == 0);
+        CHECK(reinterpret_cast<std::uintptr_t>(b) % 64 == 0);
+        CHECK(arena.bytesUsed() == 64 + 128);
+        Mat::Arena::Mark m = arena.mark();
+        arena.allocate(10000);  // larger than a block
+        CHECK(arena.bytesUsed() > 10000);
+        arena.rewind(m);
+        CHECK(arena.bytesUsed() == 64 + 128);
+        arena.reset();
+        CHECK(arena.bytesUsed() == 0);
+        CHECK(arena.allocate(10) == a);
+    }
+
+    TEST_CASE("Temporaries inside a scope draw from the arena") {
+        Mat::Arena arena;
+        Mat::SquareMat a(16,16), b(16,16);
+        a.fill(1.0); b.fill(2.0);
+        Mat::SquareMat kept(16,16);
+        const double* keptData = kept.getData();
+        CHECK(Mat::ArenaScope::current() == nullptr);
+        {
+            Mat::ArenaScope scope(arena);
+            CHECK(Mat::ArenaScope::current() == &arena);
+            Mat::SquareMat c = (a + b) * 2.0 - ~a;
+            CHECK(arena.bytesUsed() > 0);
+            size_t used = arena.bytesUsed();
+            c += a;
+            c %= b;
+            c *= 0.5;
+            CHECK(arena.bytesUsed() == used);  // compound operators work in place
+            kept = std::move(c);               // different source: elements are copied
+            CHECK(kept.getData() == keptData);
+        }
+        CHECK(arena.bytesUsed() == 0);
+        CHECK(Mat::ArenaScope::current() == nullptr);
+        CHECK(isEqual(kept(3,4), 6.0));
+        // Blocks are reused by the next scope
+        size_t reserved = arena.bytesReserved();
+        for (int k = 0; k < 10; ++k) {
+            Mat::ArenaScope scope(arena);
+            Mat::SquareMat t = a * b + a;
+            CHECK(isEqual(t(0,0), 33.0));
+        }
+        CHECK(arena.bytesReserved() == reserved);
+    }
+
+    TEST_CASE("Nested arena scopes") {
+        Mat::Arena outer, inner;
+        Mat::ArenaScope first(outer);
+        Mat::SquareMat x(8,8); x.fill(1.0);
+        {
+            Mat::ArenaScope second(inner);
+            Mat::SquareMat y = x + x;
+            CHECK(inner.bytesUsed() > 0);
+            x = y;  // copied into x's own arena buffer
+        }
+        CHECK(inner.bytesUsed() == 0);
+        CHECK(Mat::ArenaScope::current() == &outer);
+        CHECK(isEqual(x.countSum(), 128.0));
+    }
+
+    TEST_CASE("Arena buffers are counted until their matrices are gone") {
+        Mat::Arena arena;
+        Mat::SquareMat a(8,8);
+        a.fill(1.0);
+        Mat::SquareMat kept(8,8);
+        {
+            Mat::ArenaScope outer(arena);
+            Mat::SquareMat x = a + a;
+            {
+                Mat::ArenaScope inner(arena);
+                Mat::SquareMat y = x * 2.0;
+                std::vector<Mat::SquareMat> local;
+                local.push_back(y + x);            // moved into storage that ends with the scope
+                kept = local.back();
+            }
+            Mat::SquareMat::Buffer out = x.release();   // copied out to the heap, uncounted
+            CHECK(isEqual(out[0], 2.0));
+        }
+        CHECK(isEqual(kept(7, 7), 6.0));
+        CHECK(arena.bytesUsed() == 0);
+    }
+
+#if defined(__linux__)
+    // Runs body in a child process and reports whether it was ended by std::abort().
+    template <typename Body>
+    bool abortsInChild(Body body) {
+        std::fflush(nullptr);
+        const pid_t child = fork();
+        if (child == 0) {
+            if (!std::freopen("/dev/null", "w", stderr)) _exit(2);
+            body();
+            _exit(0);
+        }
+        int status = 0;
+        waitpid(child, &status, 0);
+        return WIFSIGNALED(status) && WTERMSIG(status) == SIGABRT;
+    }
+
+    Mat::SquareMat sumInOwnScope(Mat::Arena& arena, const Mat::SquareMat& a) {
+        Mat::ArenaScope scope(arena);
+        return a + a;
+    }
+
+    TEST_CASE("Ending a scope while its matrices escape aborts") {
+        Mat::SquareMat a(8,8);
+        a.fill(1.0);
+        CHECK(abortsInChild([&] {
+            Mat::Arena arena;
+            std::vector<Mat::SquareMat> escaped;
+            {
+                Mat::ArenaScope scope(arena);
+                escaped.push_back(a + a);
+            }
+        }));
+        CHECK(abortsInChild([&] {
+            Mat::Arena arena;
+            Mat::SquareMat escaped = sumInOwnScope(arena, a);
+        }));
+        CHECK(!abortsInChild([&] {
+            Mat::Arena arena;
+            Mat::ArenaScope scope(arena);
+            std::vector<Mat::SquareMat> local;
+            local.push_back(a + a);
+        }));
+    }
+#endif
+
+#ifdef MATRIX_DEBUG_ARENA
+    TEST_CASE("Rewound arena memory is poisoned") {
+        Mat::Arena arena;
+        Mat::Arena::Mark start = arena.mark();
+        double* chunk = static_cast<double*>(arena.allocate(64));
+        chunk[0] = 1.0;
+        arena.rewind(start);
+#if defined(__SANITIZE_ADDRESS__)
+        CHECK(__asan_address_is_poisoned(chunk));
+#else
+        CHECK(std::isnan(chunk[0]));
+#endif
+        CHECK(arena.allocate(64) == chunk);
+        chunk[0] = 2.0;                         // handed out again: usable
+        CHECK(isEqual(chunk[0], 2.0));
+    }
+#endif
+}
+
+TEST_SUITE("Buffer Pool") {
+    TEST_CASE("Freed buffers are reused by same-size matrices") {
+        Mat::BufferPool::trim();
+        Mat::BufferPool::resetStats();
+        Mat::BufferPool::enable(true);
+        const double* first;
+        {
+            Mat::SquareMat a(32,32);
+            a.fill(3.0);
+            first = a.getData();
+        }
+        Mat::BufferPool::Stats afterFree = Mat::BufferPool::stats();
+        CHECK(afterFree.retainedBuffers == 1);
+        CHECK(afterFree.retainedBytes == 32u * Mat::SquareMat::leadingDimension(32) * sizeof(double));
+        {
+            Mat::SquareMat b(32,32);
+            CHECK(b.getData() == first);
+            CHECK(isEqual(b.countSum(), 0.0));  // recycled buffers are still zeroed
+            Mat::SquareMat c(33,33);            // different size: a miss
+        }
+        Mat::BufferPool::Stats s = Mat::BufferPool::stats();
+        CHECK(s.hits == 1);
+        CHECK(s.misses == 2);
+        CHECK(s.retainedBuffers == 2);
+        Mat::BufferPool::trim();
+        CHECK(Mat::BufferPool::stats().retainedBytes == 0);
+        Mat::BufferPool::enable(false);
+    }
+
+    TEST_CASE("Pool respects its retention limit") {
+        Mat::BufferPool::trim();
+        size_t oldLimit = Mat::BufferPool::limit();
+        Mat::BufferPool::setLimit(64 * 1024);
+        Mat::BufferPool::enable(true);
+        {
+            Mat::SquareMat big(200,200);      // over the limit: freed normally
+            Mat::SquareMat small(16,16);
+        }
+        CHECK(Mat::BufferPool::stats().retainedBuffers == 1);
+        Mat::BufferPool::enable(false);
+        Mat::BufferPool::trim();
+        Mat::BufferPool::setLimit(oldLimit);
+    }
+}
+
+TEST_SUITE("Huge Pages") {
+    TEST_CASE("Large buffers are mapped 2 MiB aligned and unmapped on free") {
+        size_t oldThreshold = Mat::HugePages::threshold();
+        Mat::HugePages::setThreshold(size_t(1) << 20);
+        Mat::HugePages::resetStats();
+        size_t mappedBefore = Mat::HugePages::stats().mappedBytes;
+        {
+            Mat::SquareMat big(512,512);
+            Mat::SquareMat small(64,64);    // under the threshold: ordinary heap
+            big[511][511] = 4.0;
+            CHECK(isEqual(big.countSum(), 4.0));
+#if defined(__linux__)
+            Mat::HugePages::Stats s = Mat::HugePages::stats();
+            CHECK(reinterpret_cast<std::uintptr_t>(big.getData()) % Mat::HugePages::HUGE_PAGE == 0);
+            CHECK(s.mappedBytes - mappedBefore >= 512u * 512u * sizeof(double));
+            CHECK(s.transparentBuffers + s.fallbacks + s.explicitBuffers == 1);
+#endif
+        }
+        CHECK(Mat::HugePages::stats().mappedBytes == mappedBefore);
+        Mat::HugePages::setThreshold(oldThreshold);
+    }
+
+    TEST_CASE("Explicit mode uses hugetlbfs or falls back; Off maps nothing") {
+        size_t oldThreshold = Mat::HugePages::threshold();
+        Mat::HugePages::setThreshold(size_t(1) << 20);
+        Mat::HugePages::setMode(Mat::HugePages::Mode::Explicit);
+        Mat::HugePages::resetStats();
+        {
+            Mat::SquareMat a(512,512);
+            a.fill(1.0);
+            Mat::SquareMat b = a * 2.0;
+            CHECK(isEqual(b.countSum(), 2.0 * 512 * 512));
+#if defined(__linux__)
+            Mat::HugePages::Stats s = Mat::HugePages::stats();
+            CHECK(s.transparentBuffers + s.fallbacks + s.explicitBuffers == 2);
+#endif
+        }
+        Mat::HugePages::setMode(Mat::HugePages::Mode::Off);
+        Mat::HugePages::resetStats();
+        {
+            Mat::SquareMat c(512,512);
+        }
+        CHECK(Mat::HugePages::stats().transparentBuffers == 0);
+        Mat::HugePages::setMode(Mat::HugePages::Mode::Transparent);
+        Mat::HugePages::setThreshold(oldThreshold);
+    }
+}
+
+TEST_SUITE("Parallel and NUMA Placement") {
+    TEST_CASE("forRows covers every row once, with a stable block-to-thread mapping") {
+        for (int threads : {1, 3, 8}) {
+            Mat::Parallel::setThreads(threads);
+            CHECK(Mat::Parallel::threads() == threads);
+            for (int rows : {1, 5, 100}) {
+                std::vector<int> hits(rows, 0);
+                std::vector<std::thread::id> first(rows), second(rows);
+                Mat::Parallel::forRows(rows, [&](int begin, int end) {
+                    for (int i = begin; i < end; ++i) { ++hits[i]; first[i] = std::this_thread::get_id(); }
+                });
+                Mat::Parallel::forRows(rows, [&](int begin, int end) {
+                    for (int i = begin; i < end; ++i) second[i] = std::this_thread::get_id();
+                });
+                CHECK(std::count(hits.begin(), hits.end(), 1) == rows);
+                CHECK(first == second);
+                CHECK(first[0] == std::this_thread::get_id());
+            }
+        }
+        CHECK_THROWS_AS(Mat::Parallel::forRows(10, [](int begin, int) {
+            if (begin > 0) throw std::runtime_error("block failed");
+        }), std::runtime_error);
+        Mat::Parallel::setThreads(0);
+        CHECK(Mat::Parallel::threads() >= 1);
+    }
+
+    TEST_CASE("Row-parallel element-wise kernels match the serial results") {
+        Mat::SquareMat a(70,70), b(70,70);
+        for (int i = 0; i < 70; ++i)
+            for (int j = 0; j < 70; ++j) { a[i][j] = i * 0.5 - j; b[i][j] = (i + j) % 7 + 1; }
+        Mat::Parallel::setThreads(1);
+        Mat::SquareMat sum = a + b, diff = a - b, had = a % b, scaled = a * 3.0, divided = a / 2.0;
+        Mat::Parallel::setThreads(4);
+        size_t oldThreshold = Mat::Parallel::threshold();
+        Mat::Parallel::setThreshold(1);
+        CHECK((a + b) == sum);
+        CHECK((a - b) == diff);
+        CHECK((a % b) == had);
+        CHECK((a * 3.0) == scaled);
+        CHECK((a / 2.0) == divided);
+        Mat::SquareMat c(a);
+        c += b;
+        CHECK(c == sum);
+        Mat::Parallel::setThreshold(oldThreshold);
+        Mat::Parallel::setThreads(0);
+    }
+
+    TEST_CASE("Products split across workers match the serial product exactly") {
+        Mat::SquareMat big(160, 160);
+        for (int i = 0; i < 160; ++i)
+            for (int j = 0; j < 160; ++j) big[i][j] = std::sin(i * 0.37 + j * 0.11);
+        Mat::ConstMatrixView a = big.block(0, 3, 157), b = big.block(2, 0, 157);
+        Mat::SquareMatF af(90, 90);
+        for (int i = 0; i < 90; ++i)
+            for (int j = 0; j < 90; ++j) af[i][j] = (float)std::cos(i - j * 0.5);
+        Mat::Parallel::setThreads(1);
+        Mat::SquareMat serial = a * b;
+        Mat::SquareMatF serialF = af * af;
+        size_t oldThreshold = Mat::Parallel::productThreshold();
+        Mat::Parallel::setProductThreshold(1);
+        CHECK(Mat::Parallel::productThreshold() == 1);
+        for (int threads : {2, 3, 7}) {
+            Mat::Parallel::setThreads(threads);
+            CHECK((a * b) == serial);
+            CHECK((af * af) == serialF);
+        }
+        Mat::SquareMat c(serial);
+        c *= b;
+        Mat::Parallel::setThreads(1);
+        Mat::SquareMat d(serial);
+        d *= b;
+        CHECK(c == d);
+        Mat::Parallel::setProductThreshold(oldThreshold);
+        Mat::Parallel::setThreads(0);
+    }
+
+    TEST_CASE("Placement modes keep matrices correct") {
+        size_t oldThreshold = Mat::NumaPlacement::threshold();
+        Mat::NumaPlacement::setThreshold(0);
+        Mat::Parallel::setThreads(4);
+        for (Mat::NumaPlacement::Mode mode : {Mat::NumaPlacement::Mode::FirstTouch, Mat::NumaPlacement::Mode::Interleave,
+                                              Mat::NumaPlacement::Mode::Bind}) {
+            Mat::NumaPlacement::setMode(mode);
+            Mat::SquareMat a(300,300);
+            CHECK(isEqual(a.countSum(), 0.0));
+            a[299][299] = 2.0;
+            Mat::SquareMat b(a);
+            CHECK(b == a);
+            CHECK(isEqual((a + b).countSum(), 4.0));
+            // Copy-on-write detaches and release() copies go through the same allocation path
+            a.enableCopyOnWrite();
+            Mat::SquareMat shared(a);
+            shared(0, 0) = 1.0;
+            CHECK(a.useCount() == 1);
+            CHECK(isEqual(shared.countSum(), 3.0));
+            CHECK(isEqual(a.countSum(), 2.0));
+            Mat::Arena arena;
+            Mat::SquareMat::Buffer out(nullptr, [](double*) {});
+            {
+                Mat::ArenaScope scope(arena);
+                Mat::SquareMat temp = a + a;
+                out = temp.release();
+            }
+            CHECK(isEqual(out[299 * Mat::SquareMat::leadingDimension(300) + 299], 4.0));
+        }
+        Mat::NumaPlacement::setMode(Mat::NumaPlacement::Mode::Local);
+        Mat::NumaPlacement::setThreshold(oldThreshold);
+        Mat::Parallel::setThreads(0);
+        CHECK(Mat::NumaPlacement::nodeCount() >= 1);
+        CHECK_THROWS_AS(Mat::NumaPlacement::setNode(-1), std::invalid_argument);
+        CHECK_THROWS_AS(Mat::NumaPlacement::setNode(Mat::NumaPlacement::nodeCount()), std::invalid_argument);
+    }
+
+#if defined(__linux__)
+    TEST_CASE("Workers are pinned in FirstTouch mode") {
+        // Number of CPUs each worker (blocks 1..3) may run on
+        auto workerCpus = [] {
+            std::vector<int> counts(4, 0);
+            Mat::Parallel::forRows(4, [&](int begin, int) {
+                cpu_set_t set;
+                CPU_ZERO(&set);
+                sched_getaffinity(0, sizeof(set), &set);
+                counts[begin] = CPU_COUNT(&set);
+            });
+            return counts;
+        };
+        cpu_set_t process;
+        CPU_ZERO(&process);
+        sched_getaffinity(0, sizeof(process), &process);
+        Mat::Parallel::setThreads(4);
+        Mat::NumaPlacement::setMode(Mat::NumaPlacement::Mode::FirstTouch);
+        std::vector<int> pinned = workerCpus();
+        for (int t = 1; t < 4; ++t) CHECK(pinned[t] == 1);
+        Mat::NumaPlacement::setMode(Mat::NumaPlacement::Mode::Local);
+        std::vector<int> free = workerCpus();
+        for (int t = 1; t < 4; ++t) CHECK(free[t] == CPU_COUNT(&process));
+        Mat::Parallel::setThreads(0);
+    }
+#endif
+}
+
+TEST_SUITE("Matrix Views") {
+    TEST_CASE("Blocks share the matrix's elements") {
+        Mat::SquareMat m(6,6);
+        for (int i = 0; i < 6; ++i)
+            for (int j = 0; j < 6; ++j) m[i][j] = i * 6 + j;
+        Mat::MatrixView b = m.block(2, 3, 3);
+        CHECK(b.getRows() == 3);
+        CHECK(b.getStride() == m.getStride());
+        CHECK(b.getData() == &m[2][3]);
+        CHECK(isEqual(b(1, 2), 23.0));
+        b(0, 0) = -1;
+        CHECK(isEqual(m[2][3], -1.0));
+        Mat::ConstMatrixView inner = b.block(1, 1, 2);
+        CHECK(inner.getData() == &m[3][4]);
+        CHECK(isEqual(inner.countSum(), 22.0 + 23 + 28 + 29));
+        CHECK_THROWS_AS(m.block(4, 4, 3), std::out_of_range);
+        CHECK_THROWS_AS(b.block(0, 0, 4), std::out_of_range);
+        CHECK_THROWS_AS(b(3, 0), std::out_of_range);
+    }
+
+    TEST_CASE("Operators accept views and matrices") {
+        Mat::SquareMat m(4,4);
+        for (int i = 0; i < 4; ++i)
+            for (int j = 0; j < 4; ++j) m[i][j] = i + 2 * j;
+        Mat::SquareMat a(m.block(0, 0, 2));
+        Mat::SquareMat b(m.block(2, 2, 2));
+        CHECK((m.block(0, 0, 2) + m.block(2, 2, 2)) == a + b);
+        CHECK((m.block(0, 0, 2) * b) == a * b);
+        CHECK((a - m.block(2, 2, 2)) == a - b);
+        CHECK((m.block(2, 2, 2) % m.block(0, 0, 2)) == b % a);
+        CHECK((~m.block(0, 2, 2)) == ~Mat::SquareMat(m.block(0, 2, 2)));
+        CHECK((2.0 * m.block(1, 1, 2)) == Mat::SquareMat(m.block(1, 1, 2)) * 2.0);
+        CHECK_THROWS_AS(m.block(0, 0, 2) + m.block(0, 0, 3), std::invalid_argument);
+
+        Mat::SquareMat c(a);
+        c += m.block(2, 2, 2);
+        CHECK(c == a + b);
+        c *= m.block(0, 0, 2);
+        CHECK(c == (a + b) * a);
+    }
+
+    TEST_CASE("Writable views update blocks in place") {
+        Mat::SquareMat m(8,8);
+        Mat::SquareMat ones(3,3);
+        ones.fill(1.0);
+        m.block(5, 0, 3).fill(2.0);
+        m.block(5, 0, 3) += ones;
+        m.block(0, 5, 3).assign(m.block(5, 0, 3));
+        m.block(0, 5, 3) *= 2.0;
+        CHECK(isEqual(m[6][1], 3.0));
+        CHECK(isEqual(m[1][6], 6.0));
+        CHECK(isEqual(m.countSum(), 9 * 3.0 + 9 * 6.0));
+    }
+
+    TEST_CASE("Determinant does not allocate minors") {
+        Mat::SquareMat m(6,6);
+        for (int i = 0; i < 6; ++i)
+            for (int j = 0; j < 6; ++j) m[i][j] = (i == j) ? 2.0 : 1.0 / (1 + i + j);
+        Mat::BufferPool::trim();
+        Mat::BufferPool::resetStats();
+        Mat::BufferPool::enable(true);
+        double det = !m;
+        Mat::BufferPool::Stats s = Mat::BufferPool::stats();
+        Mat::BufferPool::enable(false);
+        CHECK(s.hits + s.misses == 0);
+        CHECK(det == doctest::Approx(!Mat::FixedSquareMat<6>(m)));
+    }
+}
+
+TEST_SUITE("Copy-on-Write") {
+    TEST_CASE("Copies share the buffer until the first write") {
+        Mat::SquareMat a(20,20);
+        a.fill(1.0);
+        a.enableCopyOnWrite();
+        CHECK(a.isCopyOnWrite());
+        Mat::SquareMat b(a);
+        Mat::SquareMat c(5,5);
+        c = a;
+        const Mat::SquareMat& cb = b;
+        CHECK(cb.getData() == static_cast<const Mat::SquareMat&>(a).getData());
+        CHECK(a.useCount() == 3);
+        CHECK(isEqual(cb[3][4] + cb(5, 6), 2.0));   // const reads do not copy
+        CHECK(a.useCount() == 3);
+
+        b(0, 0) = 7.0;
+        CHECK(a.useCount() == 2);
+        CHECK(b.useCount() == 1);
+        CHECK(b.isCopyOnWrite());
+        CHECK(isEqual(a[0][0], 1.0));
+        CHECK(isEqual(b[0][0], 7.0));
+        c += a;
+        CHECK(a.useCount() == 1);
+        CHECK(isEqual(c.countSum(), 800.0));
+        CHECK(isEqual(a.countSum(), 400.0));
+    }
+
+    TEST_CASE("Every writer detaches") {
+        Mat::SquareMat a(10,10);
+        a.enableCopyOnWrite();
+        Mat::SquareMat b = a; ++b;
+        Mat::SquareMat c = a; c.fill(2.0);
+        Mat::SquareMat d = a; d[1][1] = 3.0;
+        Mat::SquareMat e = a; e.getData()[0] = 4.0;
+        Mat::SquareMat f = a; f.block(0, 0, 2).fill(5.0);
+        Mat::SquareMat g = a; g *= 6.0;
+        CHECK(a.useCount() == 1);
+        CHECK(isEqual(a.countSum(), 0.0));
+        CHECK(isEqual(b.countSum(), 100.0));
+        CHECK(isEqual(c.countSum(), 200.0));
+        CHECK(isEqual(d.countSum(), 3.0));
+        CHECK(isEqual(e.countSum(), 4.0));
+        CHECK(isEqual(f.countSum(), 20.0));
+    }
+
+    TEST_CASE("Postfix operators and mode propagation") {
+        Mat::SquareMat a(12,12);
+        a.enableCopyOnWrite();
+        Mat::SquareMat before = a++;
+        CHECK(isEqual(before.countSum(), 0.0));
+        CHECK(isEqual(a.countSum(), 144.0));
+        CHECK(before.useCount() == 1);
+
+        Mat::SquareMat plain(12,12);
+        a = plain;                  // the mode follows the assigned value
+        CHECK(!a.isCopyOnWrite());
+
+        Mat::SquareMat tiny(3,3);
+        tiny.enableCopyOnWrite();   // inline storage is always copied
+        CHECK(!tiny.isCopyOnWrite());
+    }
+
+    TEST_CASE("Copies inside an arena scope are not shared") {
+        Mat::SquareMat a(16,16);
+        a.fill(1.0);
+        a.enableCopyOnWrite();
+        Mat::Arena arena;
+        {
+            Mat::ArenaScope scope(arena);
+            Mat::SquareMat copy(a);
+            CHECK(a.useCount() == 1);
+            CHECK(isEqual(copy.countSum(), 256.0));
+        }
+        CHECK(isEqual(a.countSum(), 256.0));
+    }
+}
+
+TEST_SUITE("External Buffers") {
+    TEST_CASE("Borrowed buffers are used in place") {
+        double buffer[3 * 5] = {};
+        for (int i = 0; i < 3; ++i)
+            for (int j = 0; j < 3; ++j) buffer[i * 5 + j] = i * 3 + j;
+        {
+            Mat::SquareMat m = Mat::SquareMat::borrow(buffer, 3, 5);
+            CHECK(m.getData() == buffer);
+            CHECK(m.getStride() == 5);
+            CHECK(isEqual(m[2][1], 7.0));
+            m(0, 0) = 42.0;
+            Mat::SquareMat copy(m);              // copies get their own storage
+            copy(1, 1) = -1.0;
+            CHECK(copy.getStride() == 3);
+            CHECK(isEqual(m[1][1], 4.0));
+            CHECK(isEqual((m + m)[2][2], 16.0));
+        }
+        CHECK(isEqual(buffer[0], 42.0));         // still owned by the caller
+        CHECK_THROWS_AS(Mat::SquareMat::borrow(nullptr, 3, 3), std::invalid_argument);
+        CHECK_THROWS_AS(Mat::SquareMat::borrow(buffer, 3, 2), std::invalid_argument);
+    }
+
+    TEST_CASE("Assignment keeps writing into external buffers") {
+        double buffer[6 * 7] = {};
+        Mat::SquareMat a(6,6), b(6,6);
+        for (int i = 0; i < 6; ++i)
+            for (int j = 0; j < 6; ++j) { a(i, j) = i + j; b(i, j) = i == j ? 2.0 : 0.0; }
+        Mat::SquareMat m = Mat::SquareMat::borrow(buffer, 6, 7);
+        m = a + b;                               // move assignment
+        CHECK(m.getData() == buffer);
+        CHECK(isEqual(buffer[3 * 7 + 3], 8.0));
+        m *= b;                                  // product assigned back
+        CHECK(m.getData() == buffer);
+        CHECK(isEqual(buffer[3 * 7 + 3], 16.0));
+        CHECK(isEqual(buffer[1 * 7 + 2], 6.0));
+        m = a;                                   // copy assignment
+        CHECK(m.getData() == buffer);
+        CHECK(isEqual(buffer[5 * 7 + 4], 9.0));
+        m += b;
+        CHECK(isEqual(buffer[0], 2.0));
+        CHECK(m.getStride() == 7);
+        m = Mat::SquareMat(3,3);                 // another size lets go of the buffer
+        CHECK(m.getData() != buffer);
+        CHECK(isEqual(buffer[0], 2.0));
+
+        int freed = 0;
+        {
+            Mat::SquareMat adopted = Mat::SquareMat::adopt(new double[36](), 6, 6,
+                                                           [&freed](double* p) { ++freed; delete[] p; });
+            const double* raw = static_cast<const Mat::SquareMat&>(adopted).getData();
+            adopted = a * b;
+            adopted *= b;
+            CHECK(static_cast<const Mat::SquareMat&>(adopted).getData() == raw);
+            CHECK(adopted == a * b * b);
+            CHECK(freed == 0);
+        }
+        CHECK(freed == 1);
+    }
+
+    TEST_CASE("Adopted buffers are freed through their deleter") {
+        int freed = 0;
+        auto deleter = [&freed](double* p) { ++freed; delete[] p; };
+        {
+            double* raw = new double[64]();
+            Mat::SquareMat m = Mat::SquareMat::adopt(raw, 8, 8, deleter);
+            Mat::SquareMat moved(std::move(m));
+            CHECK(moved.getData() == raw);
+            moved.fill(1.0);
+            CHECK(isEqual(moved.countSum(), 64.0));
+        }
+        CHECK(freed == 1);
+        {
+            Mat::SquareMat m = Mat::SquareMat::adopt(new double[64](), 8, 8, deleter);
+            m.enableCopyOnWrite();
+            Mat::SquareMat copy(m);
+            CHECK(m.useCount() == 2);
+            m = Mat::SquareMat(8, 8);            // copy still holds the buffer
+            CHECK(freed == 1);
+        }
+        CHECK(freed == 2);
+    }
+
+    TEST_CASE("release hands the buffer back out") {
+        int freed = 0;
+        double* raw = new double[36]();
+        Mat::SquareMat m = Mat::SquareMat::adopt(raw, 6, 6, [&freed](double* p) { ++freed; delete[] p; });
+        m(5, 5) = 3.0;
+        Mat::SquareMat::Buffer out = m.release();
+        CHECK(out.get() == raw);
+        CHECK(isEqual(out[35], 3.0));
+        CHECK(m.getRows() == 0);
+        CHECK(freed == 0);
+        out.reset();
+        CHECK(freed == 1);
+
+        Mat::SquareMat heap(10,10);
+        heap(9, 9) = 2.0;
+        const double* before = static_cast<const Mat::SquareMat&>(heap).getData();
+        int ld = heap.getStride();
+        Mat::SquareMat::Buffer owned = heap.release();
+        CHECK(owned.get() == before);
+        CHECK(isEqual(owned[9 * ld + 9], 2.0));
+
+        Mat::SquareMat tiny(2,2);
+        tiny(1, 0) = 5.0;
+        Mat::SquareMat::Buffer copied = tiny.release();   // inline elements are copied out
+        CHECK(isEqual(copied[2], 5.0));
+        CHECK(!tiny.release());
+    }
+}
+
+TEST_SUITE("Sparse Matrices") {
+    Mat::SquareMat randomSparse(int n, int seed) {
+        Mat::SquareMat m(n,n);
+        for (int i = 0; i < n; ++i)
+            for (int j = 0; j < n; ++j)
+                if ((i * 7 + j * 13 + seed) % 5 == 0) m[i][j] = (i + 2 * j + seed) % 9 - 4;
+        return m;
+    }
+
+    TEST_CASE("Conversions and element access") {
+        Mat::SparseSquareMat s(4, {{0, 3, 2.0}, {2, 1, -1.0}, {0, 3, 1.0}, {1, 1, 5.0}, {3, 0, 0.0}});
+        CHECK(s.nonZeros() == 3);
+        CHECK(isEqual(s(0, 3), 3.0));
+        CHECK(isEqual(s(3, 0), 0.0));
+        CHECK(isEqual(s.countSum(), 7.0));
+        Mat::SquareMat d = s.toDense();
+        CHECK(isEqual(d[2][1], -1.0));
+        CHECK(Mat::SparseSquareMat(d) == s);
+        CHECK_THROWS_AS(s(4, 0), std::out_of_range);
+        CHECK_THROWS_AS(Mat::SparseSquareMat(3, {{3, 0, 1.0}}), std::out_of_range);
+        CHECK_THROWS_AS(Mat::SparseSquareMat(0), std::invalid_argument);
+    }
+
+    TEST_CASE("Products and element-wise operations match dense results") {
+        Mat::SquareMat a = randomSparse(9, 1);
+        Mat::SquareMat b = randomSparse(9, 3);
+        Mat::SparseSquareMat sa(a), sb(b);
+        CHECK((sa * b) == a * b);
+        CHECK((a * sb) == a * b);
+        CHECK((sa * sb).toDense() == a * b);
+        CHECK((sa * b.block(0, 0, 9)) == a * b);
+        CHECK((sa % sb).toDense() == a % b);
+        CHECK((sa % b).toDense() == a % b);
+        CHECK((b % sa).toDense() == b % a);
+        CHECK((~sa).toDense() == ~a);
+        CHECK((2.0 * sa).toDense() == a * 2.0);
+        CHECK((sa * 0.0).nonZeros() == 0);
+        CHECK_THROWS_AS(sa * Mat::SparseSquareMat(3), std::invalid_argument);
+        CHECK_THROWS_AS(sa * Mat::SquareMat(3,3), std::invalid_argument);
+    }
+
+    TEST_CASE("Sparse powers count paths") {
+        // Directed cycle 0 -> 1 -> ... -> 9999 -> 0: far too large to hold densely.
+        const int n = 10000;
+        std::vector<Mat::SparseSquareMatI64::Entry> edges;
+        for (int i = 0; i < n; ++i) edges.push_back({i, (i + 1) % n, 1});
+        Mat::SparseSquareMatI64 g(n, edges);
+        Mat::SparseSquareMatI64 p = g ^ 3;
+        CHECK(p.nonZeros() == (size_t)n);
+        CHECK(p(0, 3) == 1);
+        CHECK(p(n - 1, 2) == 1);
+        CHECK((g ^ 0).nonZeros() == (size_t)n);
+        CHECK((g ^ 0)(5, 5) == 1);
+        CHECK_THROWS_AS(g ^ -1, std::invalid_argument);
+        // Powers beyond int: the cycle returns to the identity every n steps
+        CHECK((g ^ 3000000000LL) == (g ^ 0));
+        CHECK((g ^ (size_t)(n + 3)) == p);
+        CHECK((g ^ 3L) == p);
+
+        Mat::SquareMatI64 small(4,4);
+        small[0][1] = small[1][2] = small[2][0] = small[1][3] = 1;
+        CHECK((Mat::SparseSquareMatI64(small) ^ 5).toDense() == (small ^ 5));
+    }
+}
+
+TEST_SUITE("Symmetric Matrices") {
+    TEST_CASE("Packed storage mirrors the upper triangle") {
+        Mat::SymmetricMat s(4);
+        s(0, 3) = 2.0;
+        s(2, 1) = -1.5;
+        CHECK(isEqual(s(3, 0), 2.0));
+        CHECK(isEqual(s(1, 2), -1.5));
+        CHECK(isEqual(s.countSum(), 1.0));
+        Mat::SquareMat d = s.toDense();
+        CHECK(d == ~d);
+        CHECK(Mat::SymmetricMat(d) == s);
+        CHECK_THROWS_AS(s(4, 0), std::out_of_range);
+        CHECK_THROWS_AS(Mat::SymmetricMat(0), std::invalid_argument);
+    }
+
+    TEST_CASE("Gram products and element-wise operations") {
+        Mat::SquareMat a = sampleMatrix(7, 1);
+        Mat::SquareMat b = sampleMatrix(7, 4);
+        Mat::SymmetricMat g = Mat::SymmetricMat::gram(a);
+        CHECK(g.toDense() == a * ~a);
+        Mat::SymmetricMat h = Mat::SymmetricMat::gram(b);
+        CHECK((g + h).toDense() == a * ~a + b * ~b);
+        CHECK((g - h).toDense() == a * ~a - b * ~b);
+        CHECK((g * 3.0).toDense() == (a * ~a) * 3.0);
+        CHECK((g / 2.0).toDense() == (a * ~a) / 2.0);
+        CHECK(isEqual(g.countSum(), (a * ~a).countSum()));
+        CHECK_THROWS_AS(g / 0.0, std::invalid_argument);
+        CHECK_THROWS_AS(g + Mat::SymmetricMat(3), std::invalid_argument);
+    }
+
+    TEST_CASE("Symmetric products match dense results") {
+        Mat::SquareMat a = sampleMatrix(9, 2);
+        Mat::SquareMat b = sampleMatrix(9, 5);
+        Mat::SymmetricMat s(a);
+        Mat::SquareMat sd = s.toDense();
+        CHECK((s * b) == sd * b);
+        CHECK((b * s) == b * sd);
+        CHECK((s * s) == sd * sd);
+        CHECK((s * b.block(0, 0, 9)) == sd * b);
+        CHECK_THROWS_AS(s * Mat::SquareMat(3,3), std::invalid_argument);
+    }
+}
+
+TEST_SUITE("Triangular Matrices") {
+    Mat::SquareMat triangularSample(int n, bool upper) {
+        Mat::SquareMat m(n,n);
+        for (int i = 0; i < n; ++i)
+            for (int j = 0; j < n; ++j)
+                if (upper ? j >= i : j <= i) m[i][j] = (i == j) ? 2.0 + i : (i * 3 + j) % 5 - 2;
+        return m;
+    }
+
+    TEST_CASE("Packed storage and element access") {
+        Mat::UpperTriangularMat u(3);
+        u.set(0, 2, 4.0);
+        u.set(1, 1, -1.0);
+        CHECK(isEqual(u(0, 2), 4.0));
+        CHECK(isEqual(u(2, 0), 0.0));
+        CHECK_THROWS_AS(u.set(2, 0, 1.0), std::out_of_range);
+        CHECK_THROWS_AS(u(3, 0), std::out_of_range);
+        Mat::SquareMat d = triangularSample(5, false);
+        Mat::LowerTriangularMat l(d);
+        CHECK(l.toDense() == d);
+        CHECK(isEqual(l.countSum(), d.countSum()));
+        CHECK((~l).toDense() == ~d);
+    }
+
+    TEST_CASE("Determinant is the product of the diagonal") {
+        Mat::SquareMat d = triangularSample(6, true);
+        Mat::UpperTriangularMat u(d);
+        CHECK(isEqual(!u, 2.0 * 3 * 4 * 5 * 6 * 7));
+        CHECK(isEqual(!u, !d));
+        Mat::UpperTriangularMat big(200);
+        for (int i = 0; i < 200; ++i) big.set(i, i, 1.0);
+        CHECK(isEqual(!big, 1.0));
+    }
+
+    TEST_CASE("Products match dense results") {
+        Mat::SquareMat ud = triangularSample(7, true);
+        Mat::SquareMat ld = triangularSample(7, false);
+        Mat::SquareMat dense = ud + ld;
+        Mat::UpperTriangularMat u(ud);
+        Mat::LowerTriangularMat l(ld);
+        CHECK((u * u).toDense() == ud * ud);
+        CHECK((l * l).toDense() == ld * ld);
+        CHECK((u * l) == ud * ld);
+        CHECK((l * u) == ld * ud);
+        CHECK((u * dense) == ud * dense);
+        CHECK((dense * l) == dense * ld);
+        CHECK((u + u).toDense() == ud * 2.0);
+        CHECK((u - u * 2.0).toDense() == ud * -1.0);
+        CHECK_THROWS_AS(u * Mat::UpperTriangularMat(3), std::invalid_argument);
+    }
+
+    TEST_CASE("Triangular solve") {
+        Mat::SquareMat ud = triangularSample(6, true);
+        Mat::SquareMat ld = triangularSample(6, false);
+        Mat::SquareMat b(6,6);
+        for (int i = 0; i < 6; ++i)
+            for (int j = 0; j < 6; ++j) b[i][j] = i - 2 * j;
+        Mat::SquareMat x = Mat::UpperTriangularMat(ud).solve(b);
+        Mat::SquareMat y = Mat::LowerTriangularMat(ld).solve(b);
+        Mat::SquareMat rx = ud * x - b;
+        Mat::SquareMat ry = ld * y - b;
+        for (int i = 0; i < 6; ++i)
+            for (int j = 0; j < 6; ++j) {
+                CHECK(std::abs(rx[i][j]) < 1e-9);
+                CHECK(std::abs(ry[i][j]) < 1e-9);
+            }
+        CHECK_THROWS_AS(Mat::UpperTriangularMat(4).solve(Mat::SquareMat(4,4)), std::invalid_argument);
+    }
+}
+
+TEST_SUITE("Banded Matrices") {
+    Mat::BandedMat bandSample(int n, int lower, int upper) {
+        Mat::BandedMat b(n, lower, upper);
+        for (int i = 0; i < n; ++i)
+            for (int j = std::max(0, i - lower); j <= std::min(n - 1, i + upper); ++j)
+                b.set(i, j, (i == j) ? 4.0 + i % 3 : (i * 3 + j * 5) % 7 - 3);
+        return b;
+    }
+
+    TEST_CASE("Band storage and element access") {
+        Mat::BandedMat b = bandSample(6, 1, 2);
+        CHECK(b.getLowerBandwidth() == 1);
+        CHECK(b.getUpperBandwidth() == 2);
+        CHECK(isEqual(b(5, 0), 0.0));
+        CHECK_THROWS_AS(b.set(3, 0, 1.0), std::out_of_range);
+        CHECK_THROWS_AS(b(6, 0), std::out_of_range);
+        CHECK_THROWS_AS(Mat::BandedMat(4, 4, 0), std::invalid_argument);
+        Mat::SquareMat d = b.toDense();
+        CHECK(Mat::BandedMat(d, 1, 2) == b);
+        CHECK(isEqual(b.countSum(), d.countSum()));
+        CHECK((~b).toDense() == ~d);
+        CHECK((~b).getLowerBandwidth() == 2);
+    }
+
+    TEST_CASE("Arithmetic matches dense results") {
+        Mat::BandedMat a = bandSample(8, 1, 1);
+        Mat::BandedMat b = bandSample(8, 2, 0);
+        Mat::SquareMat ad = a.toDense(), bd = b.toDense();
+        Mat::BandedMat sum = a + b;
+        CHECK(sum.getLowerBandwidth() == 2);
+        CHECK(sum.toDense() == ad + bd);
+        CHECK((a - b).toDense() == ad - bd);
+        CHECK((a * 2.0).toDense() == ad * 2.0);
+        Mat::BandedMat product = a * b;
+        CHECK(product.getLowerBandwidth() == 3);
+        CHECK(product.getUpperBandwidth() == 1);
+        CHECK(product.toDense() == ad * bd);
+        CHECK((a * bd) == ad * bd);
+        CHECK((ad * b) == ad * bd);
+        CHECK_THROWS_AS(a + bandSample(5, 1, 1), std::invalid_argument);
+    }
+
+    TEST_CASE("Determinants match cofactor expansion") {
+        for (int lower = 0; lower <= 2; ++lower) {
+            for (int upper = 0; upper <= 2; ++upper) {
+                Mat::BandedMat b = bandSample(7, lower, upper);
+                CHECK(!b == doctest::Approx(!b.toDense()));
+            }
+        }
+        Mat::BasicBandedMat<std::int64_t> exact(6, 2, 2);
+        Mat::SquareMatI64 dense(6,6);
+        for (int i = 0; i < 6; ++i)
+            for (int j = std::max(0, i - 2); j <= std::min(5, i + 2); ++j) {
+                exact.set(i, j, (i + 2 * j) % 5 - 1);
+                dense[i][j] = (i + 2 * j) % 5 - 1;
+            }
+        CHECK(!exact == !dense);
+    }
+
+    TEST_CASE("Large tridiagonal operators") {
+        // Second-difference operator: det of tridiag(-1, 2, -1) of size n is n + 1.
+        const int n = 200000;
+        Mat::BandedMat t(n, 1, 1);
+        for (int i = 0; i < n; ++i) {
+            t.set(i, i, 2.0);
+            if (i > 0) t.set(i, i - 1, -1.0);
+            if (i + 1 < n) t.set(i, i + 1, -1.0);
+        }
+        CHECK(!t == doctest::Approx(n + 1.0));
+        Mat::BandedMat t2 = t * t;
+        CHECK(t2.getLowerBandwidth() == 2);
+        CHECK(isEqual(t2(1000, 1000), 6.0));
+        CHECK(isEqual(t2(1000, 1002), 1.0));
+        CHECK(isEqual((t + t).countSum(), 4.0));
+    }
+}
+
+TEST_SUITE("Diagonal Matrices") {
+    TEST_CASE("Only the diagonal is stored, settable and raised to powers") {
+        Mat::DiagonalMat d({1.0, 2.0, 3.0});
+        CHECK(d.getRows() == 3);
+        CHECK(isEqual(d(1, 1), 2.0));
+        CHECK(isEqual(d(0, 2), 0.0));
+        CHECK_THROWS_AS(d(3, 0), std::out_of_range);
+        CHECK_THROWS_AS(d.set(0, 1, 5.0), std::out_of_range);
+        CHECK_THROWS_AS(Mat::DiagonalMat(0), std::invalid_argument);
+        d.set(2, 2, 4.0);
+        Mat::SquareMat dense = d.toDense();
+        CHECK(isEqual(dense[2][2], 4.0));
+        CHECK(isEqual(dense[0][1], 0.0));
+        CHECK(Mat::DiagonalMat(dense) == d);
+        CHECK(isEqual(d.countSum(), 7.0));
+        CHECK(isEqual(!d, 8.0));
+        CHECK((d ^ 3) == Mat::DiagonalMat({1.0, 8.0, 64.0}));
+        CHECK((d ^ (size_t)3) == (d ^ 3));
+        CHECK((Mat::DiagonalMat({1.0, -1.0}) ^ 3000000001LL) == Mat::DiagonalMat({1.0, -1.0}));
+        CHECK_THROWS_WITH_AS(d ^ -1, "Negative exponents are not supported for matrices", std::invalid_argument);
+        CHECK(~d == d);
+    }
+
+    TEST_CASE("Diagonal operands scale the rows and columns of dense ones") {
+        Mat::DiagonalMat a({2.0, -1.0, 0.5, 3.0});
+        Mat::DiagonalMat b({1.0, 4.0, 2.0, -2.0});
+        Mat::SquareMat m(4,4);
+        for (int i = 0; i < 4; ++i)
+            for (int j = 0; j < 4; ++j) m[i][j] = i * 4 + j + 1;
+        Mat::SquareMat ad = a.toDense(), bd = b.toDense();
+        CHECK((a * b).toDense() == ad * bd);
+        CHECK((a + b).toDense() == ad + bd);
+        CHECK((a - b).toDense() == ad - bd);
+        CHECK((2.0 * a).toDense() == ad * 2.0);
+        CHECK((a * m) == ad * m);
+        CHECK((m * a) == m * ad);
+        CHECK((m + a) == m + ad);
+        CHECK((a + m) == ad + m);
+        CHECK((m - a) == m - ad);
+        CHECK((a - m) == ad - m);
+        CHECK((a - m.block(0, 0, 4)) == ad - m);
+        CHECK_THROWS_AS(a - Mat::SquareMat(3,3), std::invalid_argument);
+        CHECK((a * m.block(0, 0, 4)) == ad * m);
+        CHECK_THROWS_AS(a * Mat::SquareMat(3,3), std::invalid_argument);
+    }
+
+    TEST_CASE("Identity") {
+        Mat::SquareMat id = Mat::SquareMat::identity(3);
+        CHECK(isEqual(id.countSum(), 3.0));
+        CHECK(isEqual(!id, 1.0));
+        Mat::Identity I(3);
+        CHECK(I.toDense() == id);
+        Mat::SquareMat m(3,3);
+        for (int i = 0; i < 3; ++i)
+            for (int j = 0; j < 3; ++j) m[i][j] = i - j * 2;
+        CHECK((I * m) == m);
+        CHECK((m * I) == m);
+        CHECK((m + I) == m + id);
+        CHECK((I + m) == m + id);
+        CHECK((m - I) == m - id);
+        CHECK((I - m) == id - m);
+        CHECK_THROWS_AS(I - Mat::SquareMat(2,2), std::invalid_argument);
+        Mat::SquareMatI64 k(3,3);
+        k(0, 1) = 5;
+        CHECK((I - k) == Mat::SquareMatI64::identity(3) - k);
+        CHECK((I * I).getRows() == 3);
+        Mat::DiagonalMat d = I;
+        CHECK(d == Mat::DiagonalMat({1.0, 1.0, 1.0}));
+        CHECK_THROWS_AS(I * Mat::SquareMat(2,2), std::invalid_argument);
+        CHECK((m ^ 0) == id);
+    }
+}
+
+TEST_SUITE("Tiled Matrices") {
+    TEST_CASE("Elements on either side of a tile edge land in their own tiles") {
+        Mat::SquareMat d = sampleMatrix(10, 1);
+        Mat::TiledMat t(d, 4);
+        CHECK(t.getTileSize() == 4);
+        CHECK(t.getTilesPerSide() == 3);
+        CHECK(isEqual(t.tileView(0, 0)(3, 3), d[3][3]));
+        CHECK(isEqual(t.tileView(0, 1)(3, 0), d[3][4]));
+        CHECK(isEqual(t.tileView(1, 0)(0, 3), d[4][3]));
+        CHECK(isEqual(t.tileView(2, 2)(1, 1), d[9][9]));
+        CHECK(isEqual(t.tileView(2, 2)(2, 2), 0.0));    // padding of the partial edge tile
+        CHECK(isEqual(t.tileView(1, 2)(3, 2), 0.0));
+        CHECK(t.toDense() == d);
+        CHECK(isEqual(t.countSum(), d.countSum()));
+        t.set(4, 8, 100.0);
+        CHECK(isEqual(t.tileView(1, 2)(0, 0), 100.0));
+        CHECK(isEqual(t(4, 8), 100.0));
+        CHECK(isEqual(t(3, 8), d[3][8]));
+        CHECK(isEqual(t.toDense()[4][8], 100.0));
+        CHECK(Mat::TiledMat(3, 64).getTileSize() == 3);
+        CHECK_THROWS_AS(t(10, 0), std::out_of_range);
+        CHECK_THROWS_AS(t.tileView(3, 0), std::out_of_range);
+        CHECK_THROWS_AS(Mat::TiledMat(4, 0), std::invalid_argument);
+    }
+
+    TEST_CASE("Sizes around the tile edge match dense results") {
+        // One short of, exactly at and one past each multiple of the tile.
+        for (int n : {3, 4, 5, 7, 8, 9, 12, 13}) {
+            Mat::SquareMat ad = sampleMatrix(n, 2), bd = sampleMatrix(n, 5);
+            Mat::TiledMat a(ad, 4), b(bd, 4);
+            CHECK((a * b).toDense() == ad * bd);
+            CHECK((~a).toDense() == ~ad);
+            CHECK((a + b).toDense() == ad + bd);
+            CHECK((a - b).toDense() == ad - bd);
+            CHECK((a % b).toDense() == ad % bd);
+            CHECK((a * 3.0).toDense() == ad * 3.0);
+            Mat::SquareMatI64 di = sampleMatrix<std::int64_t>(n, 3);
+            Mat::BasicTiledMat<std::int64_t> ti(di, 4);
+            CHECK((ti * ti).toDense() == di * di);
+            CHECK((~ti).toDense() == ~di);
+        }
+        for (int tile : {1, 3, 16}) {
+            Mat::SquareMat ad = sampleMatrix(10, 2), bd = sampleMatrix(10, 5);
+            Mat::TiledMat a(ad, tile), b(bd, tile);
+            CHECK((a * b).toDense() == ad * bd);
+            CHECK((~a).toDense() == ~ad);
+        }
+        Mat::TiledMat a(sampleMatrix(8, 0), 4);
+        CHECK_THROWS_AS(a * Mat::TiledMat(sampleMatrix(8, 0), 2), std::invalid_argument);
+        CHECK_THROWS_AS(a + Mat::TiledMat(6, 4), std::invalid_argument);
+    }
+}
+
+TEST_SUITE("Morton Matrices") {
+    TEST_CASE("Elements on either side of a leaf edge round-trip") {
+        Mat::SquareMat d = sampleMatrix(37, 1);
+        Mat::MortonMat m(d);
+        CHECK(m.getRows() == 37);
+        CHECK(m.toDense() == d);
+        CHECK(isEqual(m.countSum(), d.countSum()));
+        // 15|16 and 31|32 straddle leaves; 36 is the last row and column before the padding.
+        int edges[] = {0, 15, 16, 31, 32, 36};
+        double value = 100.0;
+        for (int r : edges)
+            for (int c : edges) {
+                CHECK(isEqual(m(r, c), d[r][c]));
+                m.set(r, c, value);
+                d[r][c] = value;
+                value += 1.0;
+            }
+        CHECK(m.toDense() == d);
+        CHECK(m == Mat::MortonMat(d));
+        CHECK_THROWS_AS(m(37, 0), std::out_of_range);
+        CHECK_THROWS_AS(m.set(0, 37, 1.0), std::out_of_range);
+        CHECK_THROWS_AS(Mat::MortonMat(0), std::invalid_argument);
+    }
+
+    TEST_CASE("Sizes around powers of two match dense results") {
+        // 2^k + 1 pads to nearly four times its area; the padding must stay zero.
+        for (int n : {1, 3, 15, 16, 17, 31, 33, 63, 65, 70}) {
+            Mat::SquareMat ad = sampleMatrix(n, 2), bd = sampleMatrix(n, 9);
+            Mat::MortonMat a(ad), b(bd);
+            CHECK((a * b).toDense() == ad * bd);
+            CHECK(a * b == Mat::MortonMat(ad * bd));
+            CHECK((~a).toDense() == ~ad);
+            CHECK(~a == Mat::MortonMat(~ad));
+            CHECK((a + b).toDense() == ad + bd);
+            CHECK((a - b).toDense() == ad - bd);
+            CHECK((a % b).toDense() == ad % bd);
+            CHECK((2.0 * a).toDense() == ad * 2.0);
+            Mat::SquareMatI64 di = sampleMatrix<std::int64_t>(n, 4);
+            Mat::BasicMortonMat<std::int64_t> mi(di);
+            CHECK((mi * mi).toDense() == di * di);
+            CHECK((~mi).toDense() == ~di);
+        }
+        CHECK_THROWS_AS(Mat::MortonMat(4) * Mat::MortonMat(5), std::invalid_argument);
+    }
+}
+
+TEST_SUITE("Uninitialized Construction") {
+    TEST_CASE("Uninitialized matrices are usable once written") {
+        Mat::SquareMat m(40, Mat::uninitialized);
+        CHECK(m.getRows() == 40);
+        CHECK(m.getCols() == 40);
+#ifdef MATRIX_DEBUG_UNINITIALIZED
+        CHECK(std::isnan(m[7][9]));
+#endif
+        m.fill(1.5);
+        CHECK(isEqual(m.countSum(), 1.5 * 1600));
+        Mat::SquareMat copy(m);
+        CHECK(copy == m);
+        Mat::SquareMatI64 small(3, Mat::uninitialized);
+        small.fill(2);
+        CHECK(small.countSum() == 18);
+        CHECK_THROWS_AS(Mat::SquareMat(0, Mat::uninitialized), std::invalid_argument);
+    }
+
+    TEST_CASE("Operator results are fully written") {
+        Mat::SquareMat a(33,33), b(33,33);
+        for (int i = 0; i < 33; ++i)
+            for (int j = 0; j < 33; ++j) { a[i][j] = i + j * 0.25; b[i][j] = (i * j) % 5 + 1; }
+        double sum = 0;
+        for (int i = 0; i < 33; ++i)
+            for (int j = 0; j < 33; ++j) sum += a[i][j] + b[i][j];
+        CHECK(isEqual((a + b).countSum(), sum));
+        CHECK(isEqual((a - b).countSum() + 2 * b.countSum(), sum));
+        CHECK(isEqual((~a).countSum(), a.countSum()));
+        CHECK(isEqual((a / 2.0).countSum(), a.countSum() / 2));
+        Mat::SquareMat p = a * b;
+        double p0 = 0;
+        for (int k = 0; k < 33; ++k) p0 += a[0][k] * b[k][32];
+        CHECK(isEqual(p[0][32], p0));
+        CHECK(!std::isnan((a % b).countSum()));
+        CHECK(!std::isnan((a % 3).countSum()));
+    }
+}
+
+TEST_SUITE("Blocked Multiplication") {
+    TEST_CASE("Products crossing every block edge match the reference exactly") {
+        // 261 is past KC and MC and leaves partial register tiles in both directions.
+        for (int n : {1, 5, 31, 33, 97, 261}) {
+            Mat::SquareMatI64 a(n, n), b(n, n);
+            for (int i = 0; i < n; ++i)
+                for (int j = 0; j < n; ++j) { a[i][j] = (i * 7 + j * 3) % 11 - 5; b[i][j] = (i + 2 * j) % 13 - 6; }
+            CHECK(a * b == naiveProduct(a, b));
+        }
+    }
+
+    TEST_CASE("Floating-point and complex products agree with the reference") {
+        Mat::SquareMat a(150, 150), b(150, 150);
+        Mat::SquareMatF af(70, 70), bf(70, 70);
+        Mat::SquareMatC ac(37, 37), bc(37, 37);
+        for (int i = 0; i < 150; ++i)
+            for (int j = 0; j < 150; ++j) { a[i][j] = std::sin(i + 0.5 * j); b[i][j] = std::cos(i * 0.3 - j); }
+        for (int i = 0; i < 70; ++i)
+            for (int j = 0; j < 70; ++j) { af[i][j] = (float)((i - j) % 4) * 0.5f; bf[i][j] = (float)((i * j) % 3); }
+        for (int i = 0; i < 37; ++i)
+            for (int j = 0; j < 37; ++j) { ac[i][j] = {double(i % 5), double(j % 3) - 1}; bc[i][j] = {1.0 / (i + j + 1), double(i % 2)}; }
+        CHECK(isEqual(a * b, naiveProduct(a, b)));
+        CHECK(af * bf == naiveProduct(af, bf));
+        Mat::SquareMatC pc = ac * bc, rc = naiveProduct(ac, bc);
+        for (int i = 0; i < 37; ++i)
+            for (int j = 0; j < 37; ++j) CHECK(std::abs(pc[i][j] - rc[i][j]) < EPS);
+    }
+
+    TEST_CASE("Views with a padded stride multiply like the copies they view") {
+        Mat::SquareMat m(120, 120);
+        for (int i = 0; i < 120; ++i)
+            for (int j = 0; j < 120; ++j) m[i][j] = (i * 31 + j * 17) % 23 - 11;
+        Mat::ConstMatrixView left = m.block(3, 5, 101), right = m.block(10, 0, 101);
+        Mat::SquareMat l(left), r(right);
+        CHECK((left * right) == naiveProduct(l, r));
+        Mat::SquareMat acc(101, 101);
+        acc.fill(1.0);
+        acc *= r;
+        Mat::SquareMat ones(101, 101);
+        ones.fill(1.0);
+        CHECK(acc == naiveProduct(ones, r));
+    }
+}
+
+TEST_SUITE("SIMD Dispatch") {
+    TEST_CASE("Levels up to the detected one can be selected") {
+        const Mat::Simd::Level best = Mat::Simd::detected();
+        CHECK(Mat::Simd::level() == best);
+        CHECK(std::string(Mat::Simd::name(Mat::Simd::Level::AVX2)) == "AVX2");
+        if (best != Mat::Simd::Level::AVX512) {
+            CHECK_THROWS_AS(Mat::Simd::setLevel(Mat::Simd::Level::AVX512), std::invalid_argument);
+        }
+        Mat::Simd::setLevel(Mat::Simd::Level::Generic);
+        CHECK(Mat::Simd::level() == Mat::Simd::Level::Generic);
+        Mat::Simd::setLevel(best);
+    }
+
+    TEST_CASE("Every level matches the generic kernels") {
+        // 37 and 45 leave tails after every register width and block size; the views are
+        // offset so their rows start unaligned.
+        Mat::SquareMat big(50, 50);
+        Mat::SquareMatF bigF(50, 50);
+        for (int i = 0; i < 50; ++i)
+            for (int j = 0; j < 50; ++j) {
+                big[i][j] = std::sin(i * 0.7 + j * 0.3);
+                bigF[i][j] = (float)std::cos(i * 0.2 - j * 0.9);
+            }
+        auto run = [&](auto& results, auto& resultsF, double& sum, float& sumF) {
+            Mat::ConstMatrixView a = big.block(1, 3, 37), b = big.block(5, 0, 37);
+            Mat::BasicConstMatrixView<float> af = bigF.block(0, 1, 45), bf = bigF.block(2, 5, 45);
+            results = {a + b, a - b, a % b, a * 1.5, a / 3.0, ~a, a * b};
+            resultsF = {af + bf, af - bf, af % bf, af * 1.5f, af / 3.0f, ~af, af * bf};
+            Mat::SquareMat filled(37, 37);
+            filled.fill(0.25);
+            results.push_back(filled);
+            sum = Mat::SquareMat(a).countSum();
+            sumF = Mat::SquareMatF(af).countSum();
+        };
+        std::vector<Mat::SquareMat> reference;
+        std::vector<Mat::SquareMatF> referenceF;
+        double sum;
+        float sumF;
+        const Mat::Simd::Level best = Mat::Simd::detected();
+        Mat::Simd::setLevel(Mat::Simd::Level::Generic);
+        run(reference, referenceF, sum, sumF);
+        for (int l = 1; l <= (int)best; ++l) {
+            Mat::Simd::setLevel((Mat::Simd::Level)l);
+            std::vector<Mat::SquareMat> got;
+            std::vector<Mat::SquareMatF> gotF;
+            double s;
+            float sF;
+            run(got, gotF, s, sF);
+            // Element-wise results, scaling and transposes are exact; products and sums may round
+            // differently because the vector kernels fuse and reorder additions.
+            for (int k = 0; k < 6; ++k) {
+                CHECK(got[k] == reference[k]);
+                CHECK(gotF[k] == referenceF[k]);
+            }
+            CHECK(got[7] == reference[7]);
+            CHECK(isEqual(got[6], reference[6]));
+            for (int i = 0; i < 45; ++i)
+                for (int j = 0; j < 45; ++j) CHECK(std::fabs(gotF[6][i][j] - referenceF[6][i][j]) < 1e-4);
+            CHECK(isEqual(s, sum));
+            CHECK(std::fabs(sF - sumF) < 1e-3);
+        }
+        Mat::Simd::setLevel(best);
+    }
+}
+
+TEST_SUITE("Strassen-Winograd") {
+    TEST_CASE("Settings") {
+        CHECK_FALSE(Mat::Strassen::enabled());
+        CHECK(Mat::Strassen::crossover() == 1024);
+        CHECK_THROWS_AS(Mat::Strassen::setCrossover(1), std::invalid_argument);
+    }
+
+    TEST_CASE("Odd and non-power-of-two sizes match the reference exactly for integers") {
+        // A crossover of 4 forces several levels, with odd sizes peeled at different depths.
+        Mat::Strassen::enable(true);
+        Mat::Strassen::setCrossover(4);
+        for (int n : {2, 3, 4, 7, 8, 13, 30, 37, 64, 101}) {
+            Mat::SquareMatI64 a(n, n), b(n, n);
+            for (int i = 0; i < n; ++i)
+                for (int j = 0; j < n; ++j) { a[i][j] = (i * 5 + j * 3) % 9 - 4; b[i][j] = (i * j + 2 * i) % 7 - 3; }
+            CHECK(a * b == naiveProduct(a, b));
+        }
+        Mat::Strassen::setCrossover(1024);
+        Mat::Strassen::enable(false);
+    }
+
+    TEST_CASE("Floating-point products agree with the classical kernel up to rounding") {
+        Mat::SquareMat big(210, 210);
+        for (int i = 0; i < 210; ++i)
+            for (int j = 0; j < 210; ++j) big[i][j] = std::sin(i * 0.13 - j * 0.29);
+        Mat::ConstMatrixView a = big.block(1, 0, 199), b = big.block(0, 7, 199);
+        Mat::SquareMat classical = a * b;
+        Mat::Strassen::enable(true);
+        Mat::Strassen::setCrossover(48);
+        Mat::SquareMat fast = a * b;
+        Mat::Strassen::setCrossover(1024);
+        Mat::SquareMat belowCrossover = a * b;
+        Mat::Strassen::enable(false);
+        CHECK(isEqual(fast, classical));
+        CHECK(belowCrossover == classical);
+    }
+}
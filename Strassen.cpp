@@ -0,0 +1,168 @@
+// adar101101@gmail.com
+
+#include <stdexcept>
+#include <atomic>
+#include <complex>
+#include <cstdint>
+#include "Strassen.hpp"
+#include "Gemm.hpp"
+#include "MatrixMemory.hpp"
+#include "Simd.hpp"
+
+namespace st = std;
+
+namespace Matrix {
+
+namespace {
+
+st::atomic<bool> strassenEnabled{false};
+st::atomic<int> strassenCrossover{1024};
+
+// Elements of workspace multiplyBlock needs for size n: two h x h temporaries per even level.
+size_t workspaceFor(int n, int crossover) {
+    if (n < crossover) return 0;
+    if (n % 2 != 0) return workspaceFor(n - 1, crossover);
+    const size_t h = (size_t)n / 2;
+    return 2 * h * h + workspaceFor(n / 2, crossover);
+}
+
+// Workspace from the matrix heap, returned on scope exit.
+template <typename T>
+class Workspace {
+public:
+    explicit Workspace(size_t count)
+        : bytes(count * sizeof(T)), data(static_cast<T*>(detail::allocateBuffer(bytes))) {}
+    ~Workspace() { detail::freeBuffer(data, bytes); }
+    Workspace(const Workspace&) = delete;
+    Workspace& operator=(const Workspace&) = delete;
+    T* get() const { return data; }
+
+private:
+    size_t bytes;
+    T* data;
+};
+
+// out = x op y over an h x h block, row by row through an element-wise kernel; out may be x or y.
+template <typename T>
+void combine(int h, const T* x, size_t ldx, const T* y, size_t ldy, T* out, size_t ldo,
+             typename detail::SimdKernels<T>::Binary kernel) {
+    for (int i = 0; i < h; ++i) {
+        kernel(x + (size_t)i * ldx, y + (size_t)i * ldy, out + (size_t)i * ldo, (size_t)h);
+    }
+}
+
+// C = A * B for n x n blocks. Below the crossover this is the classical kernel. An odd size
+// multiplies the leading even block recursively and adds the peeled last row and column with
+// thin GEMM updates. An even size follows the Strassen-Winograd schedule that needs only two
+// half-size temporaries, X for sums of A quadrants and Y for sums of B quadrants, building the
+// seven products P1..P7 and the sums U1..U7 in the quadrants of C.
+template <typename T>
+void multiplyBlock(int n, const T* a, size_t lda, const T* b, size_t ldb, T* c, size_t ldc, T* work,
+                   int crossover, const detail::SimdKernels<T>& kernels) {
+    if (n < crossover) {
+        detail::gemm(n, n, n, a, lda, b, ldb, c, ldc);
+        return;
+    }
+    if (n % 2 != 0) {
+        const int m = n - 1;
+        multiplyBlock(m, a, lda, b, ldb, c, ldc, work, crossover, kernels);
+        detail::gemm(m, m, 1, a + m, lda, b + (size_t)m * ldb, ldb, c, ldc, true);
+        detail::gemm(m, 1, n, a, lda, b + m, ldb, c + m, ldc);
+        detail::gemm(1, n, n, a + (size_t)m * lda, lda, b, ldb, c + (size_t)m * ldc, ldc);
+        return;
+    }
+    const int h = n / 2;
+    const size_t ld = (size_t)h;
+    const T* a11 = a;
+    const T* a12 = a + h;
+    const T* a21 = a + (size_t)h * lda;
+    const T* a22 = a21 + h;
+    const T* b11 = b;
+    const T* b12 = b + h;
+    const T* b21 = b + (size_t)h * ldb;
+    const T* b22 = b21 + h;
+    T* c11 = c;
+    T* c12 = c + h;
+    T* c21 = c + (size_t)h * ldc;
+    T* c22 = c21 + h;
+    T* x = work;
+    T* y = work + ld * h;
+    T* next = y + ld * h;
+    const auto add = kernels.add;
+    const auto sub = kernels.subtract;
+
+    combine(h, a11, lda, a21, lda, x, ld, sub);                                // X = S3 = A11 - A21
+    combine(h, b22, ldb, b12, ldb, y, ld, sub);                                // Y = T3 = B22 - B12
+    multiplyBlock(h, x, ld, y, ld, c21, ldc, next, crossover, kernels);        // C21 = P7 = S3 T3
+    combine(h, a21, lda, a22, lda, x, ld, add);                                // X = S1 = A21 + A22
+    combine(h, b12, ldb, b11, ldb, y, ld, sub);                                // Y = T1 = B12 - B11
+    multiplyBlock(h, x, ld, y, ld, c22, ldc, next, crossover, kernels);        // C22 = P5 = S1 T1
+    combine(h, x, ld, a11, lda, x, ld, sub);                                   // X = S2 = S1 - A11
+    combine(h, b22, ldb, y, ld, y, ld, sub);                                   // Y = T2 = B22 - T1
+    multiplyBlock(h, x, ld, y, ld, c12, ldc, next, crossover, kernels);        // C12 = P6 = S2 T2
+    combine(h, a12, lda, x, ld, x, ld, sub);                                   // X = S4 = A12 - S2
+    multiplyBlock(h, x, ld, b22, ldb, c11, ldc, next, crossover, kernels);     // C11 = P3 = S4 B22
+    multiplyBlock(h, a11, lda, b11, ldb, x, ld, next, crossover, kernels);     // X = P1 = A11 B11
+    combine(h, x, ld, c12, ldc, c12, ldc, add);                                // C12 = U2 = P1 + P6
+    combine(h, c12, ldc, c21, ldc, c21, ldc, add);                             // C21 = U3 = U2 + P7
+    combine(h, c12, ldc, c22, ldc, c12, ldc, add);                             // C12 = U4 = U2 + P5
+    combine(h, c21, ldc, c22, ldc, c22, ldc, add);                             // C22 = U7 = U3 + P5
+    combine(h, c12, ldc, c11, ldc, c12, ldc, add);                             // C12 = U5 = U4 + P3
+    combine(h, y, ld, b21, ldb, y, ld, sub);                                   // Y = T4 = T2 - B21
+    multiplyBlock(h, a22, lda, y, ld, c11, ldc, next, crossover, kernels);     // C11 = P4 = A22 T4
+    combine(h, c21, ldc, c11, ldc, c21, ldc, sub);                             // C21 = U6 = U3 - P4
+    multiplyBlock(h, a12, lda, b21, ldb, c11, ldc, next, crossover, kernels);  // C11 = P2 = A12 B21
+    combine(h, x, ld, c11, ldc, c11, ldc, add);                                // C11 = U1 = P1 + P2
+}
+
+}
+
+// Turn the Strassen-Winograd path on or off.
+void Strassen::enable(bool on) {
+    strassenEnabled.store(on, st::memory_order_relaxed);
+}
+
+// Whether the Strassen-Winograd path is on.
+bool Strassen::enabled() {
+    return strassenEnabled.load(st::memory_order_relaxed);
+}
+
+// Set the crossover size; below 2 there would be nothing to split.
+void Strassen::setCrossover(int size) {
+    if (size < 2) {
+        throw st::invalid_argument("Strassen crossover must be at least 2");
+    }
+    strassenCrossover.store(size, st::memory_order_relaxed);
+}
+
+// Crossover size.
+int Strassen::crossover() {
+    return strassenCrossover.load(st::memory_order_relaxed);
+}
+
+namespace detail {
+
+// Allocate the whole workspace up front, then recurse.
+template <typename T>
+void strassen(int n, const T* a, size_t lda, const T* b, size_t ldb, T* c, size_t ldc) {
+    const int crossover = Strassen::crossover();
+    const size_t count = workspaceFor(n, crossover);
+    if (count == 0) {
+        gemm(n, n, n, a, lda, b, ldb, c, ldc);
+        return;
+    }
+    Workspace<T> work(count);
+    multiplyBlock(n, a, lda, b, ldb, c, ldc, work.get(), crossover, simdKernels<T>());
+}
+
+// Explicit instantiations for the supported element types.
+template void strassen<float>(int, const float*, size_t, const float*, size_t, float*, size_t);
+template void strassen<double>(int, const double*, size_t, const double*, size_t, double*, size_t);
+template void strassen<std::int64_t>(int, const std::int64_t*, size_t, const std::int64_t*, size_t,
+                                     std::int64_t*, size_t);
+template void strassen<std::complex<double>>(int, const std::complex<double>*, size_t,
+                                             const std::complex<double>*, size_t, std::complex<double>*, size_t);
+
+}
+
+}
@@ -0,0 +1,71 @@
+// adar101101@gmail.com
+
+#pragma once
+#include <cstddef>
+
+/**
+ * @file Strassen.hpp
+ * @brief Opt-in Strassen-Winograd multiplication for large SquareMat products.
+ */
+
+namespace Matrix {
+
+/**
+ * @class Strassen
+ * @brief Settings of the Strassen-Winograd path of SquareMat's operator*.
+ *
+ * When enabled, products of size at least crossover() are split into quadrants and computed with
+ * 7 half-size products and 15 additions instead of 8 products, recursively, until the blocks are
+ * smaller than the crossover; those use the blocked GEMM engine (and its worker threads). An odd
+ * size is handled by peeling its last row and column off into thin GEMM updates. The temporary
+ * workspace is allocated once per product and is at most two thirds of one operand.
+ * Rounding differs from the classical product (errors grow slightly with each level), so the
+ * path is off by default. Settings apply to all threads.
+ */
+class Strassen {
+public:
+    /**
+     * @brief Turns the Strassen-Winograd path on or off (off by default).
+     * @param on Whether large products should use it.
+     */
+    static void enable(bool on);
+
+    /**
+     * @brief Returns whether the Strassen-Winograd path is on.
+     * @return True if enabled.
+     */
+    static bool enabled();
+
+    /**
+     * @brief Sets the size from which a product is split (1024 by default).
+     * @param size Smallest matrix size that is split; blocks below it use the classical kernel.
+     * @throws std::invalid_argument if size is less than 2.
+     */
+    static void setCrossover(int size);
+
+    /**
+     * @brief Returns the crossover size.
+     * @return Smallest matrix size that is split.
+     */
+    static int crossover();
+};
+
+namespace detail {
+
+/**
+ * @brief Computes C = A * B for n x n row-major operands with Strassen-Winograd recursion down
+ *        to Strassen::crossover(), regardless of Strassen::enabled().
+ * @param n Size of the operands.
+ * @param a First element of A.
+ * @param lda Distance in elements between rows of A.
+ * @param b First element of B.
+ * @param ldb Distance in elements between rows of B.
+ * @param c First element of C, which must not overlap A or B and may be uninitialized.
+ * @param ldc Distance in elements between rows of C.
+ */
+template <typename T>
+void strassen(int n, const T* a, size_t lda, const T* b, size_t ldb, T* c, size_t ldc);
+
+}
+
+}
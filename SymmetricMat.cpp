@@ -0,0 +1,233 @@
+// adar101101@gmail.com
+
+#include <stdexcept>
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <complex>
+#include <cstdint>
+#include "SymmetricMat.hpp"
+
+namespace st = std;
+
+namespace Matrix {
+
+namespace {
+
+// Throw if two operands differ in size; what names the operation for the message.
+void requireSameSize(int left, int right, const char* what) {
+    if (left != right) {
+        throw st::invalid_argument(st::string("Matrices must have the same dimensions for ") + what);
+    }
+}
+
+}
+
+// Constructor: all-zero matrix of n(n+1)/2 stored elements.
+template <typename T>
+BasicSymmetricMat<T>::BasicSymmetricMat(int size) {
+    if (size <= 0) {
+        throw st::invalid_argument("Matrix dimensions must be positive");
+    }
+    n = size;
+    packed.assign((size_t)size * (size + 1) / 2, T(0));
+}
+
+// Dense constructor: pack the upper triangle, row by row.
+template <typename T>
+BasicSymmetricMat<T>::BasicSymmetricMat(const BasicConstMatrixView<T>& dense) : BasicSymmetricMat(dense.getRows()) {
+    for (int i = 0; i < n; ++i) {
+        const T* row = dense[i];
+        st::copy(row + i, row + n, packed.begin() + rowOffset(i));
+    }
+}
+
+// A * ~A: element (i, j) is the dot product of rows i and j of a, computed for j >= i only.
+template <typename T>
+BasicSymmetricMat<T> BasicSymmetricMat<T>::gram(const BasicConstMatrixView<T>& a) {
+    BasicSymmetricMat result(a.getRows());
+    const int n = result.n;
+    T* out = result.packed.data();
+    for (int i = 0; i < n; ++i) {
+        const T* x = a[i];
+        for (int j = i; j < n; ++j) {
+            const T* y = a[j];
+            T dot = T(0);
+            for (int k = 0; k < n; ++k) {
+                dot += x[k] * y[k];
+            }
+            *out++ = dot;
+        }
+    }
+    return result;
+}
+
+// Access element at (row, col) with bounds checking; the lower triangle maps onto the upper.
+template <typename T>
+T& BasicSymmetricMat<T>::operator()(int row, int col) {
+    return const_cast<T&>(static_cast<const BasicSymmetricMat&>(*this)(row, col));
+}
+
+// Access element at (row, col) with bounds checking (const version).
+template <typename T>
+const T& BasicSymmetricMat<T>::operator()(int row, int col) const {
+    if (row < 0 || row >= n || col < 0 || col >= n) {
+        throw st::out_of_range("Index out of range of matrix");
+    }
+    if (row > col) st::swap(row, col);
+    return packed[rowOffset(row) + (col - row)];
+}
+
+// Get number of rows in the matrix.
+template <typename T>
+int BasicSymmetricMat<T>::getRows() const { return n; }
+
+// Get number of columns in the matrix.
+template <typename T>
+int BasicSymmetricMat<T>::getCols() const { return n; }
+
+// Fill all elements of the matrix with given value.
+template <typename T>
+void BasicSymmetricMat<T>::fill(T value) {
+    st::fill(packed.begin(), packed.end(), value);
+}
+
+// Calculate sum of all elements: diagonal once, every other stored element twice.
+template <typename T>
+T BasicSymmetricMat<T>::countSum() const {
+    T diagonal = T(0);
+    T offDiagonal = T(0);
+    const T* p = packed.data();
+    for (int i = 0; i < n; ++i) {
+        diagonal += *p++;
+        for (int j = i + 1; j < n; ++j) {
+            offDiagonal += *p++;
+        }
+    }
+    return diagonal + offDiagonal + offDiagonal;
+}
+
+// Unpack into a dense matrix, mirroring the upper triangle.
+template <typename T>
+BasicSquareMat<T> BasicSymmetricMat<T>::toDense() const {
+    BasicSquareMat<T> result(n, n);
+    for (int i = 0; i < n; ++i) {
+        const T* row = packed.data() + rowOffset(i);
+        T* out = result[i];
+        for (int j = i; j < n; ++j) {
+            out[j] = row[j - i];
+            result[j][i] = row[j - i];
+        }
+    }
+    return result;
+}
+
+// Compare matrices for equality (all stored elements and size).
+template <typename T>
+bool BasicSymmetricMat<T>::operator==(const BasicSymmetricMat& other) const {
+    return n == other.n && packed == other.packed;
+}
+
+// Compare matrices for inequality.
+template <typename T>
+bool BasicSymmetricMat<T>::operator!=(const BasicSymmetricMat& other) const {
+    return !(*this == other);
+}
+
+// Add two symmetric matrices over the packed triangles.
+template <typename T>
+BasicSymmetricMat<T> BasicSymmetricMat<T>::add(const BasicSymmetricMat& left, const BasicSymmetricMat& right) {
+    requireSameSize(left.n, right.n, "addition");
+    BasicSymmetricMat result(left.n);
+    st::transform(left.packed.begin(), left.packed.end(), right.packed.begin(), result.packed.begin(),
+                  [](T a, T b) { return a + b; });
+    return result;
+}
+
+// Subtract one symmetric matrix from another over the packed triangles.
+template <typename T>
+BasicSymmetricMat<T> BasicSymmetricMat<T>::subtract(const BasicSymmetricMat& left, const BasicSymmetricMat& right) {
+    requireSameSize(left.n, right.n, "subtraction");
+    BasicSymmetricMat result(left.n);
+    st::transform(left.packed.begin(), left.packed.end(), right.packed.begin(), result.packed.begin(),
+                  [](T a, T b) { return a - b; });
+    return result;
+}
+
+// Multiply each stored element by a scalar.
+template <typename T>
+BasicSymmetricMat<T> BasicSymmetricMat<T>::scale(const BasicSymmetricMat& mat, T scalar) {
+    BasicSymmetricMat result(mat);
+    for (T& value : result.packed) value *= scalar;
+    return result;
+}
+
+// Divide each stored element by a scalar.
+template <typename T>
+BasicSymmetricMat<T> BasicSymmetricMat<T>::divide(const BasicSymmetricMat& mat, T scalar) {
+    if (scalar == T(0)) {
+        throw st::invalid_argument("Division by zero");
+    }
+    BasicSymmetricMat result(mat);
+    for (T& value : result.packed) value /= scalar;
+    return result;
+}
+
+// Symmetric times dense: stored a(i, k), k >= i, adds a * row k of right to row i and,
+// off the diagonal, a * row i of right to row k, so each stored element is read once.
+template <typename T>
+BasicSquareMat<T> BasicSymmetricMat<T>::multiply(const BasicSymmetricMat& left, const BasicConstMatrixView<T>& right) {
+    requireSameSize(left.n, right.getRows(), "multiplication");
+    const int n = left.n;
+    BasicSquareMat<T> result(n, n);
+    for (int i = 0; i < n; ++i) {
+        const T* a = left.packed.data() + left.rowOffset(i);
+        const T* bi = right[i];
+        T* outI = result[i];
+        for (int k = i; k < n; ++k) {
+            const T aik = a[k - i];
+            const T* bk = right[k];
+            for (int j = 0; j < n; ++j) {
+                outI[j] += aik * bk[j];
+            }
+            if (k == i) continue;
+            T* outK = result[k];
+            for (int j = 0; j < n; ++j) {
+                outK[j] += aik * bi[j];
+            }
+        }
+    }
+    return result;
+}
+
+// Dense times symmetric: for each row of left, stored row k of right both streams into the
+// output (columns >= k) and contributes one dot product (column k, from the mirrored half).
+template <typename T>
+BasicSquareMat<T> BasicSymmetricMat<T>::multiply(const BasicConstMatrixView<T>& left, const BasicSymmetricMat& right) {
+    requireSameSize(left.getRows(), right.n, "multiplication");
+    const int n = right.n;
+    BasicSquareMat<T> result(n, n);
+    for (int i = 0; i < n; ++i) {
+        const T* b = left[i];
+        T* out = result[i];
+        for (int k = 0; k < n; ++k) {
+            const T* a = right.packed.data() + right.rowOffset(k) - k;   // a[j] = right(k, j) for j >= k
+            const T bik = b[k];
+            T dot = bik * a[k];
+            for (int j = k + 1; j < n; ++j) {
+                out[j] += bik * a[j];
+                dot += b[j] * a[j];
+            }
+            out[k] += dot;
+        }
+    }
+    return result;
+}
+
+// Explicit instantiations for the supported element types.
+template class BasicSymmetricMat<float>;
+template class BasicSymmetricMat<double>;
+template class BasicSymmetricMat<std::int64_t>;
+template class BasicSymmetricMat<std::complex<double>>;
+
+}
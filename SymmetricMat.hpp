@@ -0,0 +1,222 @@
+// adar101101@gmail.com
+
+#pragma once
+#include <complex>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+#include "SquareMat.hpp"
+
+/**
+ * @file SymmetricMat.hpp
+ * @brief Declaration of the BasicSymmetricMat class, a symmetric matrix in packed storage.
+ */
+
+namespace Matrix {
+
+/**
+ * @class BasicSymmetricMat
+ * @brief Symmetric square matrix of T that stores only its upper triangle.
+ *
+ * Elements are packed row by row: row i holds columns i..n-1, so the matrix takes n(n+1)/2
+ * elements instead of n², and element-wise passes (+, -, scalar * and /, countSum) read half
+ * the memory. Element (i, j) and (j, i) are the same stored element.
+ *
+ * The member definitions live in SymmetricMat.cpp and are explicitly instantiated for the same
+ * element types as BasicSquareMat.
+ * @tparam T Element type.
+ */
+template <typename T>
+class BasicSymmetricMat {
+    int n;                  ///< Number of rows and columns.
+    std::vector<T> packed;  ///< Upper triangle, row by row.
+
+    /**
+     * @brief Returns the position of stored row i (its diagonal element) in packed.
+     * @param i Row index.
+     * @return Offset of element (i, i).
+     */
+    size_t rowOffset(int i) const { return (size_t)i * n - (size_t)i * (i - 1) / 2; }
+
+    // Kernels behind the non-member operators.
+    static BasicSymmetricMat add(const BasicSymmetricMat& left, const BasicSymmetricMat& right);
+    static BasicSymmetricMat subtract(const BasicSymmetricMat& left, const BasicSymmetricMat& right);
+    static BasicSymmetricMat scale(const BasicSymmetricMat& mat, T scalar);
+    static BasicSymmetricMat divide(const BasicSymmetricMat& mat, T scalar);
+    static BasicSquareMat<T> multiply(const BasicSymmetricMat& left, const BasicConstMatrixView<T>& right);
+    static BasicSquareMat<T> multiply(const BasicConstMatrixView<T>& left, const BasicSymmetricMat& right);
+
+public:
+    //
+    // Constructors
+    //
+
+    /**
+     * @brief Constructs an all-zero symmetric matrix.
+     * @param size Number of rows and columns.
+     * @throws std::invalid_argument if size <= 0.
+     */
+    explicit BasicSymmetricMat(int size);
+
+    /**
+     * @brief Copies the upper triangle of a dense matrix (or view); the lower triangle is ignored.
+     * @param dense Matrix to convert.
+     */
+    explicit BasicSymmetricMat(const BasicConstMatrixView<T>& dense);
+
+    /**
+     * @brief Computes A * ~A, which is always symmetric, evaluating only its upper triangle.
+     * @param a Any square matrix or view.
+     * @return The symmetric product.
+     */
+    static BasicSymmetricMat gram(const BasicConstMatrixView<T>& a);
+
+    //
+    // Element Access
+    //
+
+    /**
+     * @brief Accesses/modifies the element at (row, col), which is also the element at (col, row).
+     * @param row Rows number.
+     * @param col Columns number.
+     * @return Reference to the stored element.
+     * @throws std::out_of_range if the index is outside the matrix.
+     */
+    T& operator()(int row, int col);
+
+    /**
+     * @brief Accesses the element at (row, col), for const contexts.
+     * @param row Rows number.
+     * @param col Columns number.
+     * @return Const reference to the stored element.
+     * @throws std::out_of_range if the index is outside the matrix.
+     */
+    const T& operator()(int row, int col) const;
+
+    //
+    // Utilities
+    //
+
+    /**
+     * @brief Returns the number of rows.
+     * @return Number of rows.
+     */
+    int getRows() const;
+
+    /**
+     * @brief Returns the number of columns.
+     * @return Number of columns.
+     */
+    int getCols() const;
+
+    /**
+     * @brief Sets all elements to the specified value.
+     * @param value Value to assign to all elements.
+     */
+    void fill(T value);
+
+    /**
+     * @brief Returns the sum of all n² elements, counting each off-diagonal element twice.
+     * @return Sum of elements.
+     */
+    T countSum() const;
+
+    /**
+     * @brief Converts to a dense matrix with both triangles filled in.
+     * @return Dense copy of this matrix.
+     */
+    BasicSquareMat<T> toDense() const;
+
+    /**
+     * @brief Checks if two symmetric matrices are equal (same size and same elements).
+     * @param other Matrix to compare.
+     * @return True if equal.
+     */
+    bool operator==(const BasicSymmetricMat& other) const;
+
+    /**
+     * @brief Checks if two symmetric matrices are not equal.
+     * @param other Matrix to compare.
+     * @return True if not equal.
+     */
+    bool operator!=(const BasicSymmetricMat& other) const;
+
+    //
+    // Friend Non-member Operators
+    //
+
+    /**
+     * @brief Adds two symmetric matrices over their packed triangles.
+     * @param left Left operand.
+     * @param right Right operand.
+     * @return New symmetric matrix containing the sum.
+     */
+    friend BasicSymmetricMat operator+(const BasicSymmetricMat& left, const BasicSymmetricMat& right) { return add(left, right); }
+
+    /**
+     * @brief Subtracts one symmetric matrix from another over their packed triangles.
+     * @param left Left operand.
+     * @param right Right operand.
+     * @return New symmetric matrix containing the difference.
+     */
+    friend BasicSymmetricMat operator-(const BasicSymmetricMat& left, const BasicSymmetricMat& right) { return subtract(left, right); }
+
+    /**
+     * @brief Multiplies each element by a scalar.
+     * @param mat Matrix operand.
+     * @param scalar Scalar operand.
+     * @return New symmetric matrix with elements scaled.
+     */
+    friend BasicSymmetricMat operator*(const BasicSymmetricMat& mat, T scalar) { return scale(mat, scalar); }
+
+    /**
+     * @brief Multiplies each element by a scalar (scalar on left).
+     * @param scalar Scalar operand.
+     * @param mat Matrix operand.
+     * @return New symmetric matrix with elements scaled.
+     */
+    friend BasicSymmetricMat operator*(T scalar, const BasicSymmetricMat& mat) { return scale(mat, scalar); }
+
+    /**
+     * @brief Divides each element by a scalar.
+     * @param mat Matrix operand.
+     * @param scalar Scalar divisor.
+     * @return New symmetric matrix with elements divided.
+     * @throws std::invalid_argument if scalar == 0.
+     */
+    friend BasicSymmetricMat operator/(const BasicSymmetricMat& mat, T scalar) { return divide(mat, scalar); }
+
+    /**
+     * @brief Multiplies a symmetric matrix by a dense matrix or view, reading each stored element once.
+     * @param left Symmetric operand.
+     * @param right Dense operand.
+     * @return New dense matrix containing the product.
+     */
+    friend BasicSquareMat<T> operator*(const BasicSymmetricMat& left, const BasicConstMatrixView<T>& right) { return multiply(left, right); }
+
+    /**
+     * @brief Multiplies a dense matrix or view by a symmetric matrix, reading each stored element once per row.
+     * @param left Dense operand.
+     * @param right Symmetric operand.
+     * @return New dense matrix containing the product.
+     */
+    friend BasicSquareMat<T> operator*(const BasicConstMatrixView<T>& left, const BasicSymmetricMat& right) { return multiply(left, right); }
+
+    /**
+     * @brief Multiplies two symmetric matrices; the product is in general not symmetric.
+     * @param left Left operand.
+     * @param right Right operand.
+     * @return New dense matrix containing the product.
+     */
+    friend BasicSquareMat<T> operator*(const BasicSymmetricMat& left, const BasicSymmetricMat& right) { return multiply(left, right.toDense()); }
+};
+
+/// Symmetric matrix of doubles.
+using SymmetricMat = BasicSymmetricMat<double>;
+
+extern template class BasicSymmetricMat<float>;
+extern template class BasicSymmetricMat<double>;
+extern template class BasicSymmetricMat<std::int64_t>;
+extern template class BasicSymmetricMat<std::complex<double>>;
+
+}
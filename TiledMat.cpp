@@ -0,0 +1,243 @@
+// adar101101@gmail.com
+
+#include <stdexcept>
+#include <algorithm>
+#include <string>
+#include <complex>
+#include <cstdint>
+#include "TiledMat.hpp"
+
+namespace st = std;
+
+namespace Matrix {
+
+namespace {
+
+// Throw if two operands differ in size; what names the operation for the message.
+void requireSameSize(int left, int right, const char* what) {
+    if (left != right) {
+        throw st::invalid_argument(st::string("Matrices must have the same dimensions for ") + what);
+    }
+}
+
+// Throw if two operands are cut into tiles of different sizes.
+void requireSameTile(int left, int right, const char* what) {
+    if (left != right) {
+        throw st::invalid_argument(st::string("Matrices must have the same tile size for ") + what);
+    }
+}
+
+}
+
+// Constructor: all-zero matrix of ceil(n / B)² tiles.
+template <typename T>
+BasicTiledMat<T>::BasicTiledMat(int size, int tileSize) {
+    if (size <= 0) {
+        throw st::invalid_argument("Matrix dimensions must be positive");
+    }
+    if (tileSize <= 0) {
+        throw st::invalid_argument("Tile size must be positive");
+    }
+    n = size;
+    tile = st::min(tileSize, size);
+    tilesPerSide = (size + tile - 1) / tile;
+    tiles.assign((size_t)tilesPerSide * tilesPerSide * tileElems(), T(0));
+}
+
+// Dense constructor: copy each row of each tile.
+template <typename T>
+BasicTiledMat<T>::BasicTiledMat(const BasicConstMatrixView<T>& dense, int tileSize) : BasicTiledMat(dense.getRows(), tileSize) {
+    for (int i = 0; i < n; ++i) {
+        const T* src = dense[i];
+        for (int bj = 0; bj < tilesPerSide; ++bj) {
+            const int col = bj * tile;
+            const int width = st::min(tile, n - col);
+            st::copy(src + col, src + col + width, tileData(i / tile, bj) + (size_t)(i % tile) * tile);
+        }
+    }
+}
+
+// Access element at (row, col) with bounds checking.
+template <typename T>
+T BasicTiledMat<T>::operator()(int r, int c) const {
+    if (r < 0 || r >= n || c < 0 || c >= n) {
+        throw st::out_of_range("Index out of range of matrix");
+    }
+    return tiles[offset(r, c)];
+}
+
+// Set element at (row, col) with bounds checking.
+template <typename T>
+void BasicTiledMat<T>::set(int r, int c, T value) {
+    if (r < 0 || r >= n || c < 0 || c >= n) {
+        throw st::out_of_range("Index out of range of matrix");
+    }
+    tiles[offset(r, c)] = value;
+}
+
+// View of one tile: B x B with stride B.
+template <typename T>
+BasicMatrixView<T> BasicTiledMat<T>::tileView(int tileRow, int tileCol) {
+    if (tileRow < 0 || tileRow >= tilesPerSide || tileCol < 0 || tileCol >= tilesPerSide) {
+        throw st::out_of_range("Tile index out of range of matrix");
+    }
+    return BasicMatrixView<T>(tileData(tileRow, tileCol), tile, tile);
+}
+
+// Read-only view of one tile.
+template <typename T>
+BasicConstMatrixView<T> BasicTiledMat<T>::tileView(int tileRow, int tileCol) const {
+    if (tileRow < 0 || tileRow >= tilesPerSide || tileCol < 0 || tileCol >= tilesPerSide) {
+        throw st::out_of_range("Tile index out of range of matrix");
+    }
+    return BasicConstMatrixView<T>(tileData(tileRow, tileCol), tile, tile);
+}
+
+// Get number of rows in the matrix.
+template <typename T>
+int BasicTiledMat<T>::getRows() const { return n; }
+
+// Get number of columns in the matrix.
+template <typename T>
+int BasicTiledMat<T>::getCols() const { return n; }
+
+// Get the tile edge.
+template <typename T>
+int BasicTiledMat<T>::getTileSize() const { return tile; }
+
+// Get number of tiles along each side.
+template <typename T>
+int BasicTiledMat<T>::getTilesPerSide() const { return tilesPerSide; }
+
+// Calculate sum of all elements; the zero padding does not contribute.
+template <typename T>
+T BasicTiledMat<T>::countSum() const {
+    T sum = T(0);
+    for (const T& value : tiles) sum += value;
+    return sum;
+}
+
+// Copy each row of each tile back into a row-major matrix.
+template <typename T>
+BasicSquareMat<T> BasicTiledMat<T>::toDense() const {
+    BasicSquareMat<T> result(n, uninitialized);
+    for (int i = 0; i < n; ++i) {
+        T* out = result[i];
+        for (int bj = 0; bj < tilesPerSide; ++bj) {
+            const int col = bj * tile;
+            const T* src = tileData(i / tile, bj) + (size_t)(i % tile) * tile;
+            st::copy(src, src + st::min(tile, n - col), out + col);
+        }
+    }
+    return result;
+}
+
+// Compare matrices for equality (size, tile size and all elements).
+template <typename T>
+bool BasicTiledMat<T>::operator==(const BasicTiledMat& other) const {
+    return n == other.n && tile == other.tile && tiles == other.tiles;
+}
+
+// Compare matrices for inequality.
+template <typename T>
+bool BasicTiledMat<T>::operator!=(const BasicTiledMat& other) const {
+    return !(*this == other);
+}
+
+// Add two tiled matrices over the whole tile buffer.
+template <typename T>
+BasicTiledMat<T> BasicTiledMat<T>::add(const BasicTiledMat& left, const BasicTiledMat& right) {
+    requireSameSize(left.n, right.n, "addition");
+    requireSameTile(left.tile, right.tile, "addition");
+    BasicTiledMat result(left);
+    for (size_t i = 0; i < result.tiles.size(); ++i) result.tiles[i] += right.tiles[i];
+    return result;
+}
+
+// Subtract one tiled matrix from another over the whole tile buffer.
+template <typename T>
+BasicTiledMat<T> BasicTiledMat<T>::subtract(const BasicTiledMat& left, const BasicTiledMat& right) {
+    requireSameSize(left.n, right.n, "subtraction");
+    requireSameTile(left.tile, right.tile, "subtraction");
+    BasicTiledMat result(left);
+    for (size_t i = 0; i < result.tiles.size(); ++i) result.tiles[i] -= right.tiles[i];
+    return result;
+}
+
+// Multiply two tiled matrices element by element over the whole tile buffer.
+template <typename T>
+BasicTiledMat<T> BasicTiledMat<T>::elementwise(const BasicTiledMat& left, const BasicTiledMat& right) {
+    requireSameSize(left.n, right.n, "element-wise multiplication");
+    requireSameTile(left.tile, right.tile, "element-wise multiplication");
+    BasicTiledMat result(left);
+    for (size_t i = 0; i < result.tiles.size(); ++i) result.tiles[i] *= right.tiles[i];
+    return result;
+}
+
+// Multiply each element by a scalar.
+template <typename T>
+BasicTiledMat<T> BasicTiledMat<T>::scale(const BasicTiledMat& mat, T scalar) {
+    BasicTiledMat result(mat);
+    for (T& value : result.tiles) value *= scalar;
+    return result;
+}
+
+// Tile product: C(bi, bj) += A(bi, bk) * B(bk, bj) for each bk, each a B x B kernel in
+// i-k-j order, so the three tiles in use stay cache-resident and every inner loop is unit-stride.
+template <typename T>
+BasicTiledMat<T> BasicTiledMat<T>::multiply(const BasicTiledMat& left, const BasicTiledMat& right) {
+    requireSameSize(left.n, right.n, "multiplication");
+    requireSameTile(left.tile, right.tile, "multiplication");
+    const int b = left.tile;
+    const int side = left.tilesPerSide;
+    BasicTiledMat result(left.n, b);
+    for (int bi = 0; bi < side; ++bi) {
+        for (int bj = 0; bj < side; ++bj) {
+            T* c = result.tileData(bi, bj);
+            for (int bk = 0; bk < side; ++bk) {
+                const T* a = left.tileData(bi, bk);
+                const T* bt = right.tileData(bk, bj);
+                for (int i = 0; i < b; ++i) {
+                    T* ci = c + (size_t)i * b;
+                    const T* ai = a + (size_t)i * b;
+                    for (int k = 0; k < b; ++k) {
+                        const T aik = ai[k];
+                        const T* bRow = bt + (size_t)k * b;
+                        for (int j = 0; j < b; ++j) {
+                            ci[j] += aik * bRow[j];
+                        }
+                    }
+                }
+            }
+        }
+    }
+    return result;
+}
+
+// Transpose: tile (bi, bj) is transposed into tile (bj, bi); source and target are both
+// B x B and cache-resident, so the strided side of the copy never leaves L1/L2.
+template <typename T>
+BasicTiledMat<T> BasicTiledMat<T>::transpose(const BasicTiledMat& mat) {
+    const int b = mat.tile;
+    BasicTiledMat result(mat.n, b);
+    for (int bi = 0; bi < mat.tilesPerSide; ++bi) {
+        for (int bj = 0; bj < mat.tilesPerSide; ++bj) {
+            const T* src = mat.tileData(bi, bj);
+            T* dst = result.tileData(bj, bi);
+            for (int i = 0; i < b; ++i) {
+                for (int j = 0; j < b; ++j) {
+                    dst[(size_t)j * b + i] = src[(size_t)i * b + j];
+                }
+            }
+        }
+    }
+    return result;
+}
+
+// Explicit instantiations for the supported element types.
+template class BasicTiledMat<float>;
+template class BasicTiledMat<double>;
+template class BasicTiledMat<std::int64_t>;
+template class BasicTiledMat<std::complex<double>>;
+
+}
@@ -0,0 +1,259 @@
+// adar101101@gmail.com
+
+#pragma once
+#include <complex>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+#include "SquareMat.hpp"
+
+/**
+ * @file TiledMat.hpp
+ * @brief Declaration of the BasicTiledMat class, a square matrix stored as contiguous square tiles.
+ */
+
+namespace Matrix {
+
+/**
+ * @class BasicTiledMat
+ * @brief Square matrix of T stored tile-major: B x B tiles, each contiguous, in row-major tile order.
+ *
+ * A tile of doubles with the default B = 64 is 32 KiB, so the kernels below work on blocks
+ * that stay in L1/L2: the product accumulates tile(i, k) * tile(k, j) into tile(i, j) with
+ * unit-stride inner loops, and the transpose swaps whole tiles and transposes each in cache
+ * instead of reading the source with stride n. The last row and column of tiles are padded
+ * with zeros, which every kernel keeps zero, so no kernel needs edge cases. tileView() exposes
+ * a single tile as a MatrixView, the unit for tile-parallel work or tile-at-a-time I/O.
+ *
+ * The member definitions live in TiledMat.cpp and are explicitly instantiated for the same
+ * element types as BasicSquareMat.
+ * @tparam T Element type.
+ */
+template <typename T>
+class BasicTiledMat {
+public:
+    /// Tile edge used when none is given: 64 x 64 doubles fill half of a typical L2 slice.
+    static constexpr int DEFAULT_TILE = 64;
+
+private:
+    int n;                  ///< Number of rows and columns.
+    int tile;               ///< Tile edge B.
+    int tilesPerSide;       ///< Number of tiles along each side, ceil(n / B).
+    std::vector<T> tiles;   ///< tilesPerSide² tiles of B² elements, each row-major.
+
+    /**
+     * @brief Returns the number of elements in a tile.
+     */
+    size_t tileElems() const { return (size_t)tile * tile; }
+
+    /**
+     * @brief Returns the first element of tile (bi, bj).
+     */
+    const T* tileData(int bi, int bj) const { return tiles.data() + ((size_t)bi * tilesPerSide + bj) * tileElems(); }
+
+    /**
+     * @brief Writable version of tileData().
+     */
+    T* tileData(int bi, int bj) { return tiles.data() + ((size_t)bi * tilesPerSide + bj) * tileElems(); }
+
+    /**
+     * @brief Returns the storage position of element (row, col).
+     */
+    size_t offset(int row, int col) const {
+        return ((size_t)(row / tile) * tilesPerSide + col / tile) * tileElems() + (size_t)(row % tile) * tile + col % tile;
+    }
+
+    // Kernels behind the non-member operators.
+    static BasicTiledMat add(const BasicTiledMat& left, const BasicTiledMat& right);
+    static BasicTiledMat subtract(const BasicTiledMat& left, const BasicTiledMat& right);
+    static BasicTiledMat elementwise(const BasicTiledMat& left, const BasicTiledMat& right);
+    static BasicTiledMat scale(const BasicTiledMat& mat, T scalar);
+    static BasicTiledMat multiply(const BasicTiledMat& left, const BasicTiledMat& right);
+    static BasicTiledMat transpose(const BasicTiledMat& mat);
+
+public:
+    //
+    // Constructors
+    //
+
+    /**
+     * @brief Constructs an all-zero tiled matrix.
+     * @param size Number of rows and columns.
+     * @param tileSize Tile edge B; clamped to size.
+     * @throws std::invalid_argument if size <= 0 or tileSize <= 0.
+     */
+    explicit BasicTiledMat(int size, int tileSize = DEFAULT_TILE);
+
+    /**
+     * @brief Copies a dense matrix (or view) into tiles.
+     * @param dense Matrix to convert.
+     * @param tileSize Tile edge B; clamped to the matrix size.
+     * @throws std::invalid_argument if tileSize <= 0.
+     */
+    explicit BasicTiledMat(const BasicConstMatrixView<T>& dense, int tileSize = DEFAULT_TILE);
+
+    //
+    // Element Access
+    //
+
+    /**
+     * @brief Returns the element at (row, col).
+     * @param row Rows number.
+     * @param col Columns number.
+     * @return Element value.
+     * @throws std::out_of_range if the index is outside the matrix.
+     */
+    T operator()(int row, int col) const;
+
+    /**
+     * @brief Sets the element at (row, col).
+     * @param row Rows number.
+     * @param col Columns number.
+     * @param value New value.
+     * @throws std::out_of_range if the index is outside the matrix.
+     */
+    void set(int row, int col, T value);
+
+    /**
+     * @brief Returns tile (tileRow, tileCol) as a B x B view, including any zero padding.
+     *
+     * Padding elements of the last row or column of tiles must be left zero.
+     * @param tileRow Tile row, 0 .. getTilesPerSide() - 1.
+     * @param tileCol Tile column, 0 .. getTilesPerSide() - 1.
+     * @return Writable view of the tile.
+     * @throws std::out_of_range if the tile is outside the matrix.
+     */
+    BasicMatrixView<T> tileView(int tileRow, int tileCol);
+
+    /**
+     * @brief Returns tile (tileRow, tileCol) as a read-only B x B view.
+     * @param tileRow Tile row.
+     * @param tileCol Tile column.
+     * @return Read-only view of the tile.
+     * @throws std::out_of_range if the tile is outside the matrix.
+     */
+    BasicConstMatrixView<T> tileView(int tileRow, int tileCol) const;
+
+    //
+    // Utilities
+    //
+
+    /**
+     * @brief Returns the number of rows.
+     * @return Number of rows.
+     */
+    int getRows() const;
+
+    /**
+     * @brief Returns the number of columns.
+     * @return Number of columns.
+     */
+    int getCols() const;
+
+    /**
+     * @brief Returns the tile edge B.
+     * @return Tile size.
+     */
+    int getTileSize() const;
+
+    /**
+     * @brief Returns the number of tiles along each side.
+     * @return ceil(size / B).
+     */
+    int getTilesPerSide() const;
+
+    /**
+     * @brief Returns the sum of all elements in the matrix.
+     * @return Sum of elements.
+     */
+    T countSum() const;
+
+    /**
+     * @brief Converts to a row-major dense matrix.
+     * @return Dense copy of this matrix.
+     */
+    BasicSquareMat<T> toDense() const;
+
+    /**
+     * @brief Checks if two tiled matrices are equal (same size, tile size and elements).
+     * @param other Matrix to compare.
+     * @return True if equal.
+     */
+    bool operator==(const BasicTiledMat& other) const;
+
+    /**
+     * @brief Checks if two tiled matrices are not equal.
+     * @param other Matrix to compare.
+     * @return True if not equal.
+     */
+    bool operator!=(const BasicTiledMat& other) const;
+
+    //
+    // Friend Non-member Operators
+    //
+
+    /**
+     * @brief Adds two tiled matrices with the same size and tile size.
+     * @param left Left operand.
+     * @param right Right operand.
+     * @return New tiled matrix containing the sum.
+     */
+    friend BasicTiledMat operator+(const BasicTiledMat& left, const BasicTiledMat& right) { return add(left, right); }
+
+    /**
+     * @brief Subtracts one tiled matrix from another with the same size and tile size.
+     * @param left Left operand.
+     * @param right Right operand.
+     * @return New tiled matrix containing the difference.
+     */
+    friend BasicTiledMat operator-(const BasicTiledMat& left, const BasicTiledMat& right) { return subtract(left, right); }
+
+    /**
+     * @brief Multiplies two tiled matrices element by element.
+     * @param left Left operand.
+     * @param right Right operand.
+     * @return New tiled matrix containing the element-wise product.
+     */
+    friend BasicTiledMat operator%(const BasicTiledMat& left, const BasicTiledMat& right) { return elementwise(left, right); }
+
+    /**
+     * @brief Multiplies each element by a scalar.
+     * @param mat Matrix operand.
+     * @param scalar Scalar operand.
+     * @return New tiled matrix with elements scaled.
+     */
+    friend BasicTiledMat operator*(const BasicTiledMat& mat, T scalar) { return scale(mat, scalar); }
+
+    /**
+     * @brief Multiplies each element by a scalar (scalar on left).
+     * @param scalar Scalar operand.
+     * @param mat Matrix operand.
+     * @return New tiled matrix with elements scaled.
+     */
+    friend BasicTiledMat operator*(T scalar, const BasicTiledMat& mat) { return scale(mat, scalar); }
+
+    /**
+     * @brief Multiplies two tiled matrices tile by tile.
+     * @param left Left operand.
+     * @param right Right operand.
+     * @return New tiled matrix containing the product.
+     */
+    friend BasicTiledMat operator*(const BasicTiledMat& left, const BasicTiledMat& right) { return multiply(left, right); }
+
+    /**
+     * @brief Returns the transpose, swapping tiles and transposing each one in cache.
+     * @param mat Matrix to transpose.
+     * @return Transposed tiled matrix.
+     */
+    friend BasicTiledMat operator~(const BasicTiledMat& mat) { return transpose(mat); }
+};
+
+/// Tiled matrix of doubles.
+using TiledMat = BasicTiledMat<double>;
+
+extern template class BasicTiledMat<float>;
+extern template class BasicTiledMat<double>;
+extern template class BasicTiledMat<std::int64_t>;
+extern template class BasicTiledMat<std::complex<double>>;
+
+}
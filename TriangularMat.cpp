@@ -0,0 +1,253 @@
+// adar101101@gmail.com
+
+#include <stdexcept>
+#include <algorithm>
+#include <string>
+#include <complex>
+#include <cstdint>
+#include "TriangularMat.hpp"
+
+namespace st = std;
+
+namespace Matrix {
+
+namespace {
+
+// Throw if two operands differ in size; what names the operation for the message.
+void requireSameSize(int left, int right, const char* what) {
+    if (left != right) {
+        throw st::invalid_argument(st::string("Matrices must have the same dimensions for ") + what);
+    }
+}
+
+}
+
+// Constructor: all-zero matrix of n(n+1)/2 stored elements.
+template <typename T, Triangle Part>
+BasicTriangularMat<T, Part>::BasicTriangularMat(int size) {
+    if (size <= 0) {
+        throw st::invalid_argument("Matrix dimensions must be positive");
+    }
+    n = size;
+    packed.assign((size_t)size * (size + 1) / 2, T(0));
+}
+
+// Dense constructor: pack the triangle, row by row.
+template <typename T, Triangle Part>
+BasicTriangularMat<T, Part>::BasicTriangularMat(const BasicConstMatrixView<T>& dense) : BasicTriangularMat(dense.getRows()) {
+    for (int i = 0; i < n; ++i) {
+        const T* src = dense[i];
+        st::copy(src + rowBegin(i), src + rowEnd(i), row(i) + rowBegin(i));
+    }
+}
+
+// Access element at (row, col) with bounds checking; the other triangle reads as zero.
+template <typename T, Triangle Part>
+T BasicTriangularMat<T, Part>::operator()(int r, int c) const {
+    if (r < 0 || r >= n || c < 0 || c >= n) {
+        throw st::out_of_range("Index out of range of matrix");
+    }
+    if (c < rowBegin(r) || c >= rowEnd(r)) return T(0);
+    return row(r)[c];
+}
+
+// Set element at (row, col), which must be inside the stored triangle.
+template <typename T, Triangle Part>
+void BasicTriangularMat<T, Part>::set(int r, int c, T value) {
+    if (r < 0 || r >= n || c < 0 || c >= n) {
+        throw st::out_of_range("Index out of range of matrix");
+    }
+    if (c < rowBegin(r) || c >= rowEnd(r)) {
+        throw st::out_of_range("Index outside the triangle of a triangular matrix");
+    }
+    row(r)[c] = value;
+}
+
+// Get number of rows in the matrix.
+template <typename T, Triangle Part>
+int BasicTriangularMat<T, Part>::getRows() const { return n; }
+
+// Get number of columns in the matrix.
+template <typename T, Triangle Part>
+int BasicTriangularMat<T, Part>::getCols() const { return n; }
+
+// Calculate sum of all elements: only the stored triangle contributes.
+template <typename T, Triangle Part>
+T BasicTriangularMat<T, Part>::countSum() const {
+    T sum = T(0);
+    for (const T& value : packed) sum += value;
+    return sum;
+}
+
+// Unpack into a zeroed dense matrix.
+template <typename T, Triangle Part>
+BasicSquareMat<T> BasicTriangularMat<T, Part>::toDense() const {
+    BasicSquareMat<T> result(n, n);
+    for (int i = 0; i < n; ++i) {
+        const T* src = row(i);
+        st::copy(src + rowBegin(i), src + rowEnd(i), result[i] + rowBegin(i));
+    }
+    return result;
+}
+
+// Solve this * X = rhs one row of X at a time, from the row with a single stored element
+// (the last row for upper, the first for lower) towards the other end.
+template <typename T, Triangle Part>
+BasicSquareMat<T> BasicTriangularMat<T, Part>::solve(const BasicConstMatrixView<T>& rhs) const {
+    requireSameSize(n, rhs.getRows(), "solve");
+    BasicSquareMat<T> x(rhs);
+    for (int step = 0; step < n; ++step) {
+        const int i = Part == Triangle::Upper ? n - 1 - step : step;
+        const T* a = row(i);
+        if (a[i] == T(0)) {
+            throw st::invalid_argument("Matrix is singular");
+        }
+        T* xi = x[i];
+        for (int k = rowBegin(i); k < rowEnd(i); ++k) {
+            if (k == i) continue;
+            const T aik = a[k];
+            const T* xk = x[k];
+            for (int j = 0; j < n; ++j) {
+                xi[j] -= aik * xk[j];
+            }
+        }
+        const T diagonal = a[i];
+        for (int j = 0; j < n; ++j) {
+            xi[j] /= diagonal;
+        }
+    }
+    return x;
+}
+
+// Determinant of a triangular matrix: the product of its diagonal.
+template <typename T, Triangle Part>
+T BasicTriangularMat<T, Part>::operator!() const {
+    T det = T(1);
+    for (int i = 0; i < n; ++i) det *= row(i)[i];
+    return det;
+}
+
+// Compare matrices for equality (all stored elements and size).
+template <typename T, Triangle Part>
+bool BasicTriangularMat<T, Part>::operator==(const BasicTriangularMat& other) const {
+    return n == other.n && packed == other.packed;
+}
+
+// Compare matrices for inequality.
+template <typename T, Triangle Part>
+bool BasicTriangularMat<T, Part>::operator!=(const BasicTriangularMat& other) const {
+    return !(*this == other);
+}
+
+// Add two triangular matrices over the packed triangles.
+template <typename T, Triangle Part>
+BasicTriangularMat<T, Part> BasicTriangularMat<T, Part>::add(const BasicTriangularMat& left, const BasicTriangularMat& right) {
+    requireSameSize(left.n, right.n, "addition");
+    BasicTriangularMat result(left.n);
+    st::transform(left.packed.begin(), left.packed.end(), right.packed.begin(), result.packed.begin(),
+                  [](T a, T b) { return a + b; });
+    return result;
+}
+
+// Subtract one triangular matrix from another over the packed triangles.
+template <typename T, Triangle Part>
+BasicTriangularMat<T, Part> BasicTriangularMat<T, Part>::subtract(const BasicTriangularMat& left, const BasicTriangularMat& right) {
+    requireSameSize(left.n, right.n, "subtraction");
+    BasicTriangularMat result(left.n);
+    st::transform(left.packed.begin(), left.packed.end(), right.packed.begin(), result.packed.begin(),
+                  [](T a, T b) { return a - b; });
+    return result;
+}
+
+// Multiply each stored element by a scalar.
+template <typename T, Triangle Part>
+BasicTriangularMat<T, Part> BasicTriangularMat<T, Part>::scale(const BasicTriangularMat& mat, T scalar) {
+    BasicTriangularMat result(mat);
+    for (T& value : result.packed) value *= scalar;
+    return result;
+}
+
+// Product of two triangular matrices of the same kind: stored a(i, k) only meets the stored
+// part of row k of right, which always lies inside row i of the result.
+template <typename T, Triangle Part>
+BasicTriangularMat<T, Part> BasicTriangularMat<T, Part>::multiply(const BasicTriangularMat& left, const BasicTriangularMat& right) {
+    requireSameSize(left.n, right.n, "multiplication");
+    BasicTriangularMat result(left.n);
+    for (int i = 0; i < left.n; ++i) {
+        const T* a = left.row(i);
+        T* out = result.row(i);
+        for (int k = left.rowBegin(i); k < left.rowEnd(i); ++k) {
+            const T aik = a[k];
+            const T* b = right.row(k);
+            for (int j = right.rowBegin(k); j < right.rowEnd(k); ++j) {
+                out[j] += aik * b[j];
+            }
+        }
+    }
+    return result;
+}
+
+// Triangular times dense: row i of the result only sums the rows of right in row i's triangle.
+template <typename T, Triangle Part>
+BasicSquareMat<T> BasicTriangularMat<T, Part>::multiply(const BasicTriangularMat& left, const BasicConstMatrixView<T>& right) {
+    requireSameSize(left.n, right.getRows(), "multiplication");
+    const int n = left.n;
+    BasicSquareMat<T> result(n, n);
+    for (int i = 0; i < n; ++i) {
+        const T* a = left.row(i);
+        T* out = result[i];
+        for (int k = left.rowBegin(i); k < left.rowEnd(i); ++k) {
+            const T aik = a[k];
+            const T* b = right[k];
+            for (int j = 0; j < n; ++j) {
+                out[j] += aik * b[j];
+            }
+        }
+    }
+    return result;
+}
+
+// Dense times triangular: left(i, k) scales only the stored part of row k of right.
+template <typename T, Triangle Part>
+BasicSquareMat<T> BasicTriangularMat<T, Part>::multiply(const BasicConstMatrixView<T>& left, const BasicTriangularMat& right) {
+    requireSameSize(left.getRows(), right.n, "multiplication");
+    const int n = right.n;
+    BasicSquareMat<T> result(n, n);
+    for (int i = 0; i < n; ++i) {
+        const T* a = left[i];
+        T* out = result[i];
+        for (int k = 0; k < n; ++k) {
+            const T aik = a[k];
+            const T* b = right.row(k);
+            for (int j = right.rowBegin(k); j < right.rowEnd(k); ++j) {
+                out[j] += aik * b[j];
+            }
+        }
+    }
+    return result;
+}
+
+// Transpose: stored (i, j) becomes (j, i) of a triangular matrix of the other kind.
+template <typename T, Triangle Part>
+typename BasicTriangularMat<T, Part>::Transposed BasicTriangularMat<T, Part>::transpose(const BasicTriangularMat& mat) {
+    Transposed result(mat.n);
+    for (int i = 0; i < mat.n; ++i) {
+        const T* src = mat.row(i);
+        for (int j = mat.rowBegin(i); j < mat.rowEnd(i); ++j) {
+            result.row(j)[i] = src[j];
+        }
+    }
+    return result;
+}
+
+// Explicit instantiations for the supported element types and both triangles.
+template class BasicTriangularMat<float, Triangle::Upper>;
+template class BasicTriangularMat<float, Triangle::Lower>;
+template class BasicTriangularMat<double, Triangle::Upper>;
+template class BasicTriangularMat<double, Triangle::Lower>;
+template class BasicTriangularMat<std::int64_t, Triangle::Upper>;
+template class BasicTriangularMat<std::int64_t, Triangle::Lower>;
+template class BasicTriangularMat<std::complex<double>, Triangle::Upper>;
+template class BasicTriangularMat<std::complex<double>, Triangle::Lower>;
+
+}
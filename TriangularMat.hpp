@@ -0,0 +1,264 @@
+// adar101101@gmail.com
+
+#pragma once
+#include <complex>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+#include "SquareMat.hpp"
+
+/**
+ * @file TriangularMat.hpp
+ * @brief Declaration of the BasicTriangularMat class, an upper or lower triangular matrix in packed storage.
+ */
+
+namespace Matrix {
+
+/// Which triangle of a triangular matrix holds its elements.
+enum class Triangle { Upper, Lower };
+
+/**
+ * @class BasicTriangularMat
+ * @brief Upper or lower triangular square matrix of T that stores only its triangle.
+ *
+ * Elements are packed row by row (n(n+1)/2 of them); the other triangle is known to be zero
+ * and is never stored, read or multiplied. The determinant is the product of the diagonal,
+ * products skip the zero half, and solve() does forward or back substitution.
+ *
+ * The member definitions live in TriangularMat.cpp and are explicitly instantiated for the same
+ * element types as BasicSquareMat, for both triangles.
+ * @tparam T Element type.
+ * @tparam Part Triangle::Upper (zero below the diagonal) or Triangle::Lower (zero above it).
+ */
+template <typename T, Triangle Part>
+class BasicTriangularMat {
+public:
+    /// Triangular type with the other triangle, i.e. the type of the transpose.
+    using Transposed = BasicTriangularMat<T, Part == Triangle::Upper ? Triangle::Lower : Triangle::Upper>;
+
+private:
+    template <typename, Triangle> friend class BasicTriangularMat;
+
+    int n;                  ///< Number of rows and columns.
+    std::vector<T> packed;  ///< The triangle, row by row.
+
+    /**
+     * @brief Returns the first column of row i inside the triangle.
+     */
+    int rowBegin(int i) const { return Part == Triangle::Upper ? i : 0; }
+
+    /**
+     * @brief Returns one past the last column of row i inside the triangle.
+     */
+    int rowEnd(int i) const { return Part == Triangle::Upper ? n : i + 1; }
+
+    /**
+     * @brief Returns a pointer p such that p[j] is element (i, j) for j in [rowBegin(i), rowEnd(i)).
+     */
+    const T* row(int i) const {
+        if (Part == Triangle::Upper) return packed.data() + ((size_t)i * n - (size_t)i * (i - 1) / 2) - i;
+        return packed.data() + (size_t)i * (i + 1) / 2;
+    }
+
+    /**
+     * @brief Writable version of row().
+     */
+    T* row(int i) { return const_cast<T*>(static_cast<const BasicTriangularMat&>(*this).row(i)); }
+
+    // Kernels behind the non-member operators.
+    static BasicTriangularMat add(const BasicTriangularMat& left, const BasicTriangularMat& right);
+    static BasicTriangularMat subtract(const BasicTriangularMat& left, const BasicTriangularMat& right);
+    static BasicTriangularMat scale(const BasicTriangularMat& mat, T scalar);
+    static BasicTriangularMat multiply(const BasicTriangularMat& left, const BasicTriangularMat& right);
+    static BasicSquareMat<T> multiply(const BasicTriangularMat& left, const BasicConstMatrixView<T>& right);
+    static BasicSquareMat<T> multiply(const BasicConstMatrixView<T>& left, const BasicTriangularMat& right);
+    static Transposed transpose(const BasicTriangularMat& mat);
+
+public:
+    //
+    // Constructors
+    //
+
+    /**
+     * @brief Constructs an all-zero triangular matrix.
+     * @param size Number of rows and columns.
+     * @throws std::invalid_argument if size <= 0.
+     */
+    explicit BasicTriangularMat(int size);
+
+    /**
+     * @brief Copies the triangle of a dense matrix (or view); the other triangle is ignored.
+     * @param dense Matrix to convert.
+     */
+    explicit BasicTriangularMat(const BasicConstMatrixView<T>& dense);
+
+    //
+    // Element Access
+    //
+
+    /**
+     * @brief Returns the element at (row, col); elements outside the triangle are zero.
+     * @param row Rows number.
+     * @param col Columns number.
+     * @return Element value.
+     * @throws std::out_of_range if the index is outside the matrix.
+     */
+    T operator()(int row, int col) const;
+
+    /**
+     * @brief Sets the element at (row, col), which must lie inside the triangle.
+     * @param row Rows number.
+     * @param col Columns number.
+     * @param value New value.
+     * @throws std::out_of_range if the index is outside the matrix or the triangle.
+     */
+    void set(int row, int col, T value);
+
+    //
+    // Utilities
+    //
+
+    /**
+     * @brief Returns the number of rows.
+     * @return Number of rows.
+     */
+    int getRows() const;
+
+    /**
+     * @brief Returns the number of columns.
+     * @return Number of columns.
+     */
+    int getCols() const;
+
+    /**
+     * @brief Returns the sum of all elements in the matrix.
+     * @return Sum of elements.
+     */
+    T countSum() const;
+
+    /**
+     * @brief Converts to a dense matrix, with zeros in the other triangle.
+     * @return Dense copy of this matrix.
+     */
+    BasicSquareMat<T> toDense() const;
+
+    /**
+     * @brief Solves this * X = rhs by back (upper) or forward (lower) substitution.
+     * @param rhs Right-hand side, a dense matrix or view.
+     * @return The solution X.
+     * @throws std::invalid_argument if the sizes differ or a diagonal element is zero.
+     */
+    BasicSquareMat<T> solve(const BasicConstMatrixView<T>& rhs) const;
+
+    /**
+     * @brief Computes the determinant as the product of the diagonal, in O(n).
+     * @return Determinant value.
+     */
+    T operator!() const;
+
+    /**
+     * @brief Checks if two triangular matrices are equal (same size and same elements).
+     * @param other Matrix to compare.
+     * @return True if equal.
+     */
+    bool operator==(const BasicTriangularMat& other) const;
+
+    /**
+     * @brief Checks if two triangular matrices are not equal.
+     * @param other Matrix to compare.
+     * @return True if not equal.
+     */
+    bool operator!=(const BasicTriangularMat& other) const;
+
+    //
+    // Friend Non-member Operators
+    //
+
+    /**
+     * @brief Adds two triangular matrices of the same kind.
+     * @param left Left operand.
+     * @param right Right operand.
+     * @return New triangular matrix containing the sum.
+     */
+    friend BasicTriangularMat operator+(const BasicTriangularMat& left, const BasicTriangularMat& right) { return add(left, right); }
+
+    /**
+     * @brief Subtracts one triangular matrix from another of the same kind.
+     * @param left Left operand.
+     * @param right Right operand.
+     * @return New triangular matrix containing the difference.
+     */
+    friend BasicTriangularMat operator-(const BasicTriangularMat& left, const BasicTriangularMat& right) { return subtract(left, right); }
+
+    /**
+     * @brief Multiplies each element by a scalar.
+     * @param mat Matrix operand.
+     * @param scalar Scalar operand.
+     * @return New triangular matrix with elements scaled.
+     */
+    friend BasicTriangularMat operator*(const BasicTriangularMat& mat, T scalar) { return scale(mat, scalar); }
+
+    /**
+     * @brief Multiplies each element by a scalar (scalar on left).
+     * @param scalar Scalar operand.
+     * @param mat Matrix operand.
+     * @return New triangular matrix with elements scaled.
+     */
+    friend BasicTriangularMat operator*(T scalar, const BasicTriangularMat& mat) { return scale(mat, scalar); }
+
+    /**
+     * @brief Multiplies two triangular matrices of the same kind (about n³/6 products).
+     * @param left Left operand.
+     * @param right Right operand.
+     * @return New triangular matrix containing the product.
+     */
+    friend BasicTriangularMat operator*(const BasicTriangularMat& left, const BasicTriangularMat& right) { return multiply(left, right); }
+
+    /**
+     * @brief Multiplies an upper by a lower triangular matrix or vice versa (dense result).
+     * @param left Left operand.
+     * @param right Right operand, of the other kind.
+     * @return New dense matrix containing the product.
+     */
+    friend BasicSquareMat<T> operator*(const BasicTriangularMat& left, const Transposed& right) { return multiply(left, right.toDense()); }
+
+    /**
+     * @brief Multiplies a triangular matrix by a dense matrix or view, skipping the zero triangle.
+     * @param left Triangular operand.
+     * @param right Dense operand.
+     * @return New dense matrix containing the product.
+     */
+    friend BasicSquareMat<T> operator*(const BasicTriangularMat& left, const BasicConstMatrixView<T>& right) { return multiply(left, right); }
+
+    /**
+     * @brief Multiplies a dense matrix or view by a triangular matrix, skipping the zero triangle.
+     * @param left Dense operand.
+     * @param right Triangular operand.
+     * @return New dense matrix containing the product.
+     */
+    friend BasicSquareMat<T> operator*(const BasicConstMatrixView<T>& left, const BasicTriangularMat& right) { return multiply(left, right); }
+
+    /**
+     * @brief Returns the transpose, a triangular matrix of the other kind.
+     * @param mat Matrix to transpose.
+     * @return Transposed matrix.
+     */
+    friend Transposed operator~(const BasicTriangularMat& mat) { return transpose(mat); }
+};
+
+/// Upper triangular matrix of doubles.
+using UpperTriangularMat = BasicTriangularMat<double, Triangle::Upper>;
+
+/// Lower triangular matrix of doubles.
+using LowerTriangularMat = BasicTriangularMat<double, Triangle::Lower>;
+
+extern template class BasicTriangularMat<float, Triangle::Upper>;
+extern template class BasicTriangularMat<float, Triangle::Lower>;
+extern template class BasicTriangularMat<double, Triangle::Upper>;
+extern template class BasicTriangularMat<double, Triangle::Lower>;
+extern template class BasicTriangularMat<std::int64_t, Triangle::Upper>;
+extern template class BasicTriangularMat<std::int64_t, Triangle::Lower>;
+extern template class BasicTriangularMat<std::complex<double>, Triangle::Upper>;
+extern template class BasicTriangularMat<std::complex<double>, Triangle::Lower>;
+
+}